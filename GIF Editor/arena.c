@@ -0,0 +1,102 @@
+/*********************************
+*		GIF EDITOR PROJECT       *
+*        Arena Allocator         *
+**********************************/
+
+#define _CRT_SECURE_NO_WARNINGS
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "arena.h"
+#include "linkedList.h"
+
+#define ALIGN_UP(value) (((value) + ARENA_ALIGNMENT - 1) & ~(ARENA_ALIGNMENT - 1))
+#define BLOCK_HEADER_SIZE ALIGN_UP(sizeof(ArenaBlock))
+
+/*
+	Function that initializes an empty arena. No memory is reserved until the first allocation.
+	Input: arena - the arena to initialize.
+	Output: None.
+*/
+void initArena(Arena* arena)
+{
+	arena->current = NULL;
+	arena->reservedBytes = 0;
+	arena->usedBytes = 0;
+	arena->allocationCount = 0;
+}
+
+/*
+	Function that frees every block of the arena in one go, invalidating all of its allocations.
+	Input: arena - the arena to free.
+	Output: None.
+*/
+void freeArena(Arena* arena)
+{
+	ArenaBlock* block = arena->current;
+	ArenaBlock* previous = NULL;
+
+	while (block)
+	{
+		previous = block->previous;
+		free(block);
+		block = previous;
+	}
+	initArena(arena);
+}
+
+/*
+	Function that allocates memory from the arena, aligned for any of the editor's structs.
+	Input: arena - the arena.
+		   size - the number of bytes needed.
+	Output: pointer to the allocated memory.
+*/
+void* arenaAllocate(Arena* arena, size_t size)
+{
+	ArenaBlock* block = arena->current;
+	size_t blockSize = ARENA_BLOCK_SIZE;
+	void* memory = NULL;
+
+	size = ALIGN_UP(size);
+	if (!block || block->used + size > block->size)
+	{
+		// allocations bigger than a block get a block of their own
+		if (size + BLOCK_HEADER_SIZE > blockSize)
+		{
+			blockSize = size + BLOCK_HEADER_SIZE;
+		}
+		block = (ArenaBlock*)malloc(blockSize);
+		if (!block)
+		{
+			printf("Memory allocation failed!\n");
+			exit(MEMORY_ALLOCATION_ERROR_CODE);
+		}
+		block->previous = arena->current;
+		block->size = blockSize;
+		block->used = BLOCK_HEADER_SIZE;
+		arena->current = block;
+		arena->reservedBytes += blockSize;
+	}
+
+	memory = (unsigned char*)block + block->used;
+	block->used += size;
+	arena->usedBytes += size;
+	arena->allocationCount++;
+	return memory;
+}
+
+/*
+	Function that copies a string into the arena.
+	Input: arena - the arena.
+		   string - the string to copy.
+	Output: the copy, owned by the arena.
+*/
+char* arenaCopyString(Arena* arena, const char* string)
+{
+	size_t length = strlen(string);
+	char* copy = (char*)arenaAllocate(arena, sizeof(char) * (length + INC));
+
+	memcpy(copy, string, length);
+	copy[length] = NULL_CHAR;
+	return copy;
+}
@@ -0,0 +1,39 @@
+/*********************************
+*		GIF EDITOR PROJECT       *
+*     Arena Allocator Declaration*
+**********************************/
+
+#ifndef ARENAH
+#define ARENAH
+
+#include <stddef.h>
+
+#define ARENA_BLOCK_SIZE (64 * 1024)
+#define ARENA_ALIGNMENT sizeof(void*)
+
+// One chunk of arena memory, blocks are chained from the newest to the oldest
+typedef struct ArenaBlock
+{
+	struct ArenaBlock*	previous;
+	size_t			size;
+	size_t			used;
+} ArenaBlock;
+
+// Bump allocator: many small allocations, all freed together
+typedef struct Arena
+{
+	ArenaBlock*	current;
+	size_t		reservedBytes;
+	size_t		usedBytes;
+	int		allocationCount;
+} Arena;
+
+void initArena(Arena* arena);
+
+void freeArena(Arena* arena);
+
+void* arenaAllocate(Arena* arena, size_t size);
+
+char* arenaCopyString(Arena* arena, const char* string);
+
+#endif
@@ -0,0 +1,285 @@
+/*********************************
+*		GIF EDITOR PROJECT       *
+*         Batch Renderer         *
+**********************************/
+
+#define _CRT_SECURE_NO_WARNINGS
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "batch.h"
+#include "project.h"
+
+#define READ_MODE "r"
+#define WRITE_MODE "w"
+#define READ_BINARY_MODE "rb"
+#define MIN_BATCH_JOBS 16
+
+static BatchJob* readManifest(const char* manifestPath, int* jobCount);
+static char* copyString(const char* string, size_t length);
+static void runBatchJob(void* argument);
+static BatchJobStatus validateProject(FrameList* list);
+static BatchJobStatus renderProject(FrameList* list, ImageCache* cache);
+static const char* batchJobStatusName(BatchJobStatus status);
+
+/*
+	Function that loads and processes many projects at once, on one work-stealing thread pool.
+	Every manifest line is a project file, optionally followed by a tab and the path of a GIF to export it to.
+	A project without an output path is only rendered: each of its frame images is decoded.
+	Empty lines and lines starting with '#' are skipped.
+	The jobs share the image cache, so an image used by several projects is decoded once while it stays cached.
+	Input: manifestPath - the path of the manifest file.
+		   reportPath - the path of the tab separated report to write, one line per job with its status and timings.
+		   cache - the decoded image cache shared by the jobs.
+		   options - how the exported GIFs are made.
+	Output: BATCH_SUCCESS, BATCH_JOBS_FAILED if any job failed, or the reason the batch could not run.
+*/
+BatchResult runBatch(const char* manifestPath, const char* reportPath, ImageCache* cache, const ExportOptions* options)
+{
+	BatchJob* jobs = NULL;
+	ThreadPool* pool = NULL;
+	FILE* report = NULL;
+	BatchResult result = BATCH_SUCCESS;
+	unsigned long long startTime = getMonotonicTimeMicroseconds();
+	int jobCount = 0, failedCount = 0, i = 0;
+
+	jobs = readManifest(manifestPath, &jobCount);
+	if (!jobs)
+	{
+		return BATCH_MANIFEST_ERROR;
+	}
+	report = fopen(reportPath, WRITE_MODE);
+	if (!report)
+	{
+		result = BATCH_REPORT_ERROR;
+	}
+	else
+	{
+		pool = createThreadPool(THREAD_POOL_ONE_PER_PROCESSOR);
+		for (i = 0; i < jobCount; i++)
+		{
+			jobs[i].cache = cache;
+			jobs[i].options = options;
+			jobs[i].pool = pool;
+			submitTask(pool, runBatchJob, &jobs[i]);
+		}
+		waitForAllTasks(pool);
+		freeThreadPool(&pool);
+
+		fprintf(report, "project\toutput\tstatus\tframes\tload ms\twork ms\n");
+		for (i = 0; i < jobCount; i++)
+		{
+			fprintf(report, "%s\t%s\t%s\t%d\t%.1f\t%.1f\n", jobs[i].projectPath, jobs[i].outputPath ? jobs[i].outputPath : "-",
+				batchJobStatusName(jobs[i].status), jobs[i].frameCount,
+				jobs[i].loadMicroseconds / (double)MICROSECONDS_IN_MILLISECOND, jobs[i].workMicroseconds / (double)MICROSECONDS_IN_MILLISECOND);
+			failedCount += BATCH_JOB_DONE != jobs[i].status ? INC : 0;
+		}
+		if (ferror(report) | fclose(report))
+		{
+			result = BATCH_REPORT_ERROR;
+		}
+		else if (failedCount)
+		{
+			result = BATCH_JOBS_FAILED;
+		}
+		printf("%d jobs, %d failed, in %.1f ms\n", jobCount, failedCount,
+			(getMonotonicTimeMicroseconds() - startTime) / (double)MICROSECONDS_IN_MILLISECOND);
+	}
+
+	for (i = 0; i < jobCount; i++)
+	{
+		free(jobs[i].projectPath);
+		free(jobs[i].outputPath);
+	}
+	free(jobs);
+	return result;
+}
+
+/*
+	Function that describes the result of a batch for the user.
+	Input: result - the batch result.
+	Output: a message describing the result.
+*/
+const char* batchResultMessage(BatchResult result)
+{
+	switch (result)
+	{
+	case BATCH_SUCCESS:
+		return "All the jobs were done successfully!";
+	case BATCH_JOBS_FAILED:
+		return "Some of the jobs failed, see the report!";
+	case BATCH_MANIFEST_ERROR:
+		return "Could not read the manifest file!";
+	default:
+		return "Could not write the report file!";
+	}
+}
+
+/*
+	Reads the manifest into an array of jobs, or returns NULL if it could not be opened.
+*/
+static BatchJob* readManifest(const char* manifestPath, int* jobCount)
+{
+	FILE* manifest = fopen(manifestPath, READ_MODE);
+	BatchJob* jobs = NULL;
+	BatchJob* grownJobs = NULL;
+	char line[BATCH_MAX_LINE_LENGTH];
+	char* separator = NULL;
+	size_t length = 0;
+	int capacity = MIN_BATCH_JOBS;
+
+	*jobCount = 0;
+	if (!manifest)
+	{
+		return NULL;
+	}
+	jobs = (BatchJob*)malloc(sizeof(BatchJob) * capacity);
+	if (!jobs)
+	{
+		printf("Memory allocation failed!\n");
+		exit(MEMORY_ALLOCATION_ERROR_CODE);
+	}
+
+	while (fgets(line, BATCH_MAX_LINE_LENGTH, manifest))
+	{
+		length = strcspn(line, "\r\n");
+		line[length] = 0;
+		if (!length || BATCH_MANIFEST_COMMENT == line[0])
+		{
+			continue;
+		}
+		if (*jobCount == capacity)
+		{
+			capacity *= 2;
+			grownJobs = (BatchJob*)realloc(jobs, sizeof(BatchJob) * capacity);
+			if (!grownJobs)
+			{
+				printf("Memory allocation failed!\n");
+				exit(MEMORY_ALLOCATION_ERROR_CODE);
+			}
+			jobs = grownJobs;
+		}
+		separator = strchr(line, BATCH_MANIFEST_SEPARATOR);
+		jobs[*jobCount].projectPath = copyString(line, separator ? (size_t)(separator - line) : length);
+		jobs[*jobCount].outputPath = separator && separator[INC] ? copyString(separator + INC, strlen(separator + INC)) : NULL;
+		jobs[*jobCount].status = BATCH_JOB_DONE;
+		jobs[*jobCount].frameCount = 0;
+		jobs[*jobCount].loadMicroseconds = 0;
+		jobs[*jobCount].workMicroseconds = 0;
+		(*jobCount)++;
+	}
+	fclose(manifest);
+	return jobs;
+}
+
+static char* copyString(const char* string, size_t length)
+{
+	char* copy = (char*)malloc(length + INC);
+
+	if (!copy)
+	{
+		printf("Memory allocation failed!\n");
+		exit(MEMORY_ALLOCATION_ERROR_CODE);
+	}
+	memcpy(copy, string, length);
+	copy[length] = 0;
+	return copy;
+}
+
+/*
+	Pool task: loads, validates and exports or renders one project, timing each step.
+	The export runs on the same pool, so its frames are encoded by this worker and by idle ones.
+*/
+static void runBatchJob(void* argument)
+{
+	BatchJob* job = (BatchJob*)argument;
+	FrameList* list = NULL;
+	unsigned long long startTime = getMonotonicTimeMicroseconds();
+
+	list = loadProject(job->projectPath);
+	job->loadMicroseconds = getMonotonicTimeMicroseconds() - startTime;
+	if (!list)
+	{
+		job->status = BATCH_JOB_LOAD_FAILED;
+		return;
+	}
+	job->frameCount = frameNodeListLength(list);
+
+	startTime = getMonotonicTimeMicroseconds();
+	job->status = validateProject(list);
+	if (BATCH_JOB_DONE == job->status && job->outputPath)
+	{
+		job->status = EXPORT_SUCCESS == exportGifOnPool(list, job->cache, job->outputPath, job->options, job->pool) ? BATCH_JOB_DONE : BATCH_JOB_EXPORT_FAILED;
+	}
+	else if (BATCH_JOB_DONE == job->status)
+	{
+		job->status = renderProject(list, job->cache);
+	}
+	job->workMicroseconds = getMonotonicTimeMicroseconds() - startTime;
+	freeFrameNodeList(&list);
+}
+
+/*
+	Checks that the project has frames and that each frame's image is embedded or can be opened.
+*/
+static BatchJobStatus validateProject(FrameList* list)
+{
+	FILE* imageFile = NULL;
+	Frame* frame = NULL;
+	int frameCount = frameNodeListLength(list);
+	int i = 0;
+
+	if (!frameCount)
+	{
+		return BATCH_JOB_INVALID;
+	}
+	for (i = 0; i < frameCount; i++)
+	{
+		frame = getFrameAtIndex(list, i);
+		if (!frame->imageData)
+		{
+			imageFile = fopen(frame->path, READ_BINARY_MODE);
+			if (!imageFile)
+			{
+				return BATCH_JOB_INVALID;
+			}
+			fclose(imageFile);
+		}
+	}
+	return BATCH_JOB_DONE;
+}
+
+static BatchJobStatus renderProject(FrameList* list, ImageCache* cache)
+{
+	ImageCacheEntry* entry = NULL;
+	int frameCount = frameNodeListLength(list);
+	int i = 0;
+
+	for (i = 0; i < frameCount; i++)
+	{
+		entry = acquireFrameImage(cache, getFrameAtIndex(list, i));
+		if (!entry)
+		{
+			return BATCH_JOB_RENDER_FAILED;
+		}
+		releaseCachedImage(cache, &entry);
+	}
+	return BATCH_JOB_DONE;
+}
+
+static const char* batchJobStatusName(BatchJobStatus status)
+{
+	switch (status)
+	{
+	case BATCH_JOB_DONE:
+		return "done";
+	case BATCH_JOB_LOAD_FAILED:
+		return "load failed";
+	case BATCH_JOB_INVALID:
+		return "invalid";
+	case BATCH_JOB_RENDER_FAILED:
+		return "render failed";
+	default:
+		return "export failed";
+	}
+}
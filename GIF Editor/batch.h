@@ -0,0 +1,53 @@
+/*********************************
+*		GIF EDITOR PROJECT       *
+*   Batch Renderer Declaration   *
+**********************************/
+
+#ifndef BATCHH
+#define BATCHH
+
+#include "linkedList.h"
+#include "imageCache.h"
+#include "threadPool.h"
+#include "gifExport.h"
+
+#define BATCH_MANIFEST_SEPARATOR '\t'
+#define BATCH_MANIFEST_COMMENT '#'
+#define BATCH_MAX_LINE_LENGTH 4096
+
+typedef enum BatchResult
+{
+	BATCH_SUCCESS = 0,
+	BATCH_JOBS_FAILED = 1,
+	BATCH_MANIFEST_ERROR = 2,
+	BATCH_REPORT_ERROR = 3
+} BatchResult;
+
+typedef enum BatchJobStatus
+{
+	BATCH_JOB_DONE = 0,
+	BATCH_JOB_LOAD_FAILED = 1,
+	BATCH_JOB_INVALID = 2,
+	BATCH_JOB_RENDER_FAILED = 3,
+	BATCH_JOB_EXPORT_FAILED = 4
+} BatchJobStatus;
+
+// One manifest line: a project and the GIF to export it to, or NULL to only render its frames
+typedef struct BatchJob
+{
+	char*			projectPath;
+	char*			outputPath;
+	ImageCache*		cache;
+	const ExportOptions*	options;
+	ThreadPool*		pool;
+	BatchJobStatus		status;
+	int			frameCount;
+	unsigned long long	loadMicroseconds;
+	unsigned long long	workMicroseconds;
+} BatchJob;
+
+BatchResult runBatch(const char* manifestPath, const char* reportPath, ImageCache* cache, const ExportOptions* options);
+
+const char* batchResultMessage(BatchResult result);
+
+#endif
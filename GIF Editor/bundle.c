@@ -0,0 +1,194 @@
+/*********************************
+*		GIF EDITOR PROJECT       *
+*        Project Bundles         *
+**********************************/
+
+#define _CRT_SECURE_NO_WARNINGS
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bundle.h"
+#include "hash.h"
+
+#define ONE_ELEMENT 1
+#define WRITE_BINARY_MODE "wb"
+#define READ_BINARY_MODE "rb"
+
+static const unsigned char pagePadding[BUNDLE_PAGE_SIZE] = { 0 };
+
+static BundleImage* findBundleImage(BundleImage* images, size_t capacity, const char* key);
+static int writeFrameImage(FILE* file, const Frame* frame, unsigned char* buffer, uint64_t* size);
+
+/*
+	Function that saves the project as a bundle: one file holding the frames and their encoded images,
+	so it can be moved or played without the original image files.
+	Each image is copied as is, from the bundle the frame came from or from the file at its path.
+	Input: list - FrameList of the frames data.
+		   directory - a folder directory in which it is possible to save the bundle.
+		   bundleFileName - the file name of the bundle.
+	Output: PROJECT_SAVED, or PROJECT_NOT_SAVED if an image could not be read or the file could not be written.
+*/
+int saveBundle(FrameList* list, char* directory, char* bundleFileName)
+{
+	ProjectHeader header;
+	BundleRecord* records = NULL;
+	BundleImage* images = NULL;
+	BundleImage* image = NULL;
+	unsigned char* buffer = NULL;
+	FILE* file = NULL;
+	Frame* frame = NULL;
+	char* fullPath = createFullPath(directory, bundleFileName, BUNDLE_EXTENSION);
+	size_t imageCapacity = BUNDLE_MIN_IMAGE_SLOTS;
+	uint64_t position = 0, stringOffset = 0, imageSize = 0, effectsSize = sizeof(ProjectEffects);
+	int frameCount = frameNodeListLength(list);
+	int saved = PROJECT_SAVED;
+	int i = 0;
+
+	releaseSourceIfSameFile(list, fullPath);
+	file = fopen(fullPath, WRITE_BINARY_MODE);
+	if (!file)
+	{
+		printf("Could not open file!\n");
+		free(fullPath);
+		return PROJECT_NOT_SAVED;
+	}
+
+	while (imageCapacity < (size_t)frameCount * 2)
+	{
+		imageCapacity *= 2;
+	}
+	records = (BundleRecord*)calloc(frameCount ? frameCount : INC, sizeof(BundleRecord));
+	images = (BundleImage*)calloc(imageCapacity, sizeof(BundleImage));
+	buffer = (unsigned char*)malloc(BUNDLE_COPY_BUFFER_SIZE);
+	if (!records || !images || !buffer)
+	{
+		printf("Memory allocation failed!\n");
+		exit(MEMORY_ALLOCATION_ERROR_CODE);
+	}
+
+	header.magic = BUNDLE_MAGIC;
+	header.version = BUNDLE_VERSION;
+	header.headerSize = sizeof(ProjectHeader);
+	header.recordSize = sizeof(BundleRecord);
+	header.frameCount = frameCount;
+	header.recordsOffset = sizeof(ProjectHeader);
+	header.stringsOffset = header.recordsOffset + header.frameCount * sizeof(BundleRecord);
+	for (i = 0; i < frameCount; i++)
+	{
+		frame = getFrameAtIndex(list, i);
+		records[i].frame.nameOffset = stringOffset;
+		stringOffset += strlen(frame->name) + INC;
+		records[i].frame.pathOffset = stringOffset;
+		stringOffset += strlen(frame->path) + INC;
+		records[i].frame.duration = frame->duration;
+		records[i].frame.effectsOffset = placeProjectEffects(frame, &effectsSize);
+	}
+	header.stringsSize = stringOffset;
+	header.effectsOffset = ALIGN_PROJECT_EFFECTS(header.stringsOffset + header.stringsSize);
+	header.effectsSize = effectsSize;
+	header.canvas = list->canvas;
+	header.reserved = 0;
+
+	// The records are written again at the end, once the image offsets are known
+	fwrite(&header, sizeof(ProjectHeader), ONE_ELEMENT, file);
+	fwrite(records, sizeof(BundleRecord), frameCount, file);
+	for (i = 0; i < frameCount; i++)
+	{
+		frame = getFrameAtIndex(list, i);
+		fwrite(frame->name, sizeof(char), strlen(frame->name) + INC, file);
+		fwrite(frame->path, sizeof(char), strlen(frame->path) + INC, file);
+	}
+	writeProjectEffects(file, list, header.stringsOffset + header.stringsSize);
+	position = header.effectsOffset + header.effectsSize;
+
+	for (i = 0; PROJECT_SAVED == saved && i < frameCount; i++)
+	{
+		frame = getFrameAtIndex(list, i);
+		image = findBundleImage(images, imageCapacity, frame->imageKey);
+		if (!image->key)
+		{
+			fwrite(pagePadding, sizeof(unsigned char), (size_t)((BUNDLE_PAGE_SIZE - position % BUNDLE_PAGE_SIZE) % BUNDLE_PAGE_SIZE), file);
+			position += (BUNDLE_PAGE_SIZE - position % BUNDLE_PAGE_SIZE) % BUNDLE_PAGE_SIZE;
+			if (PROJECT_NOT_SAVED == writeFrameImage(file, frame, buffer, &imageSize))
+			{
+				printf("Could not read the image of frame %s: %s\n", frame->name, frame->path);
+				saved = PROJECT_NOT_SAVED;
+				continue;
+			}
+			image->key = frame->imageKey;
+			image->offset = position;
+			image->size = imageSize;
+			position += imageSize;
+		}
+		records[i].imageOffset = image->offset;
+		records[i].imageSize = image->size;
+	}
+
+	if (PROJECT_SAVED == saved)
+	{
+		fseek(file, (long)header.recordsOffset, SEEK_SET);
+		fwrite(records, sizeof(BundleRecord), frameCount, file);
+	}
+	if (ferror(file))
+	{
+		saved = PROJECT_NOT_SAVED;
+	}
+	if (fclose(file))
+	{
+		saved = PROJECT_NOT_SAVED;
+	}
+	if (PROJECT_NOT_SAVED == saved)
+	{
+		remove(fullPath);
+	}
+
+	free(buffer);
+	free(images);
+	free(records);
+	free(fullPath);
+	return saved;
+}
+
+/*
+	Finds the slot of an image by its key, or the empty slot where it should be added.
+*/
+static BundleImage* findBundleImage(BundleImage* images, size_t capacity, const char* key)
+{
+	size_t slot = hashString(key) & (capacity - 1);
+
+	while (images[slot].key && strcmp(images[slot].key, key))
+	{
+		slot = (slot + INC) & (capacity - 1);
+	}
+	return &images[slot];
+}
+
+/*
+	Appends a frame's encoded image to the bundle and gives its size.
+*/
+static int writeFrameImage(FILE* file, const Frame* frame, unsigned char* buffer, uint64_t* size)
+{
+	FILE* imageFile = NULL;
+	size_t bytesRead = 0;
+
+	if (frame->imageData)
+	{
+		*size = frame->imageSize;
+		return frame->imageSize == fwrite(frame->imageData, sizeof(unsigned char), frame->imageSize, file)
+			? PROJECT_SAVED : PROJECT_NOT_SAVED;
+	}
+
+	imageFile = fopen(frame->path, READ_BINARY_MODE);
+	if (!imageFile)
+	{
+		return PROJECT_NOT_SAVED;
+	}
+	*size = 0;
+	while ((bytesRead = fread(buffer, sizeof(unsigned char), BUNDLE_COPY_BUFFER_SIZE, imageFile)) > 0)
+	{
+		fwrite(buffer, sizeof(unsigned char), bytesRead, file);
+		*size += bytesRead;
+	}
+	fclose(imageFile);
+	return *size && *size <= BUNDLE_MAX_IMAGE_SIZE ? PROJECT_SAVED : PROJECT_NOT_SAVED;
+}
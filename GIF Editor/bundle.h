@@ -0,0 +1,42 @@
+/*********************************
+*		GIF EDITOR PROJECT       *
+*  Project Bundles Declaration   *
+**********************************/
+
+#ifndef BUNDLEH
+#define BUNDLEH
+
+#include <stdint.h>
+#include "project.h"
+
+#define BUNDLE_EXTENSION ".gifb"
+#define BUNDLE_MAGIC 0x42504547u // "GEPB" as stored in the file
+#define BUNDLE_VERSION 3
+#define BUNDLE_PAGE_SIZE 4096
+#define BUNDLE_MAX_IMAGE_SIZE INT32_MAX
+#define BUNDLE_COPY_BUFFER_SIZE (64 * 1024)
+#define BUNDLE_MIN_IMAGE_SLOTS 16
+#define BUNDLE_IMAGE_KEY_FORMAT "%s#%llu %016llx"
+#define BUNDLE_IMAGE_KEY_DIGITS 40
+
+// One frame of a bundle: a project record followed by where the frame's encoded image lies in the file.
+// A bundle is a project file with BUNDLE_MAGIC and these records, followed after its effects section by the images,
+// each starting on a BUNDLE_PAGE_SIZE boundary. Frames that share a path share one image.
+typedef struct BundleRecord
+{
+	ProjectRecord	frame;
+	uint64_t	imageOffset;
+	uint64_t	imageSize;
+} BundleRecord;
+
+// An image already written to the bundle being saved, found by the key its frame's image is cached under
+typedef struct BundleImage
+{
+	const char*	key;
+	uint64_t	offset;
+	uint64_t	size;
+} BundleImage;
+
+int saveBundle(FrameList* list, char* directory, char* bundleFileName);
+
+#endif
@@ -0,0 +1,389 @@
+/*********************************
+*		GIF EDITOR PROJECT       *
+*            Canvas              *
+**********************************/
+
+#define _CRT_SECURE_NO_WARNINGS
+#define CV_IGNORE_DEBUG_BUILD_GUARD
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <opencv2/imgproc/imgproc_c.h>
+#include "canvas.h"
+#include "threadPool.h"
+
+#define BGR_CHANNELS 3
+#define IMAGE_ROW_ALIGNMENT 4
+#define HALF 2
+
+// A range of frames fitted to the canvas on a pool worker
+typedef struct CanvasJob
+{
+	ImageCache*	cache;
+	const Canvas*	canvas;
+	const Frame**	frames;
+	int		frameCount;
+	int		unreadable;
+} CanvasJob;
+
+// What fitting a frame's image to the canvas through the image cache needs
+typedef struct CanvasRequest
+{
+	ImageCache*	cache;
+	ProxyCache*	proxies;
+	const Frame*	frame;
+	CvSize		size;
+	CanvasFit	fit;
+} CanvasRequest;
+
+static const char* canvasFitNames[CANVAS_FIT_COUNT] = { "letterbox", "crop", "stretch" };
+
+static void fitFrames(void* argument);
+static IplImage* createCanvasImage(void* argument, MappedFile* mapping);
+static CvSize getPreviewCanvasSize(const ProxyCache* proxies, const Canvas* canvas);
+static void* allocateOrExit(size_t size);
+
+/*
+	Function that checks a canvas read from a project file or given by the user.
+	Input: canvas - the canvas.
+	Output: TRUE if its size is within MAX_CANVAS_SIZE and its fit is known, FALSE otherwise.
+*/
+int isCanvasValid(const Canvas* canvas)
+{
+	return canvas->width > 0 && canvas->width <= MAX_CANVAS_SIZE && canvas->height > 0 && canvas->height <= MAX_CANVAS_SIZE
+		&& canvas->fit < CANVAS_FIT_COUNT;
+}
+
+/*
+	Function that checks if a project fits its frames to a canvas.
+	Input: canvas - the project's canvas.
+	Output: TRUE if a canvas is set, FALSE if frames keep their own size.
+*/
+int isCanvasSet(const Canvas* canvas)
+{
+	return NO_CANVAS != canvas->width;
+}
+
+/*
+	Function that sets the size every frame of the project is fitted to.
+	Fitted images are cached by the canvas they were made for, so changing the canvas needs no invalidation.
+	Input: list - the project.
+		   width, height - the canvas size in pixels.
+		   fit - how frames of another shape are fitted.
+	Output: CANVAS_SET, or CANVAS_NOT_SET if the size or fit is invalid, the canvas is then unchanged.
+*/
+int setCanvas(FrameList* list, int width, int height, CanvasFit fit)
+{
+	Canvas canvas;
+
+	canvas.width = width;
+	canvas.height = height;
+	canvas.fit = (uint32_t)fit;
+	if (!isCanvasValid(&canvas))
+	{
+		return CANVAS_NOT_SET;
+	}
+	list->canvas = canvas;
+	return CANVAS_SET;
+}
+
+/*
+	Function that turns the canvas off, so every frame keeps its own size again.
+	Input: list - the project.
+	Output: None.
+*/
+void clearCanvas(FrameList* list)
+{
+	list->canvas.width = NO_CANVAS;
+	list->canvas.height = NO_CANVAS;
+	list->canvas.fit = NO_CANVAS;
+}
+
+/*
+	Function that returns the name of a fit, as the user types it.
+	Input: fit - the fit.
+	Output: the name, or "unknown" for an invalid fit.
+*/
+const char* getCanvasFitName(CanvasFit fit)
+{
+	return (unsigned)fit < CANVAS_FIT_COUNT ? canvasFitNames[fit] : "unknown";
+}
+
+/*
+	Function that finds a fit by its name.
+	Input: name - letterbox, crop or stretch.
+	Output: the fit, or UNKNOWN_CANVAS_FIT.
+*/
+int findCanvasFit(const char* name)
+{
+	int i = 0;
+
+	for (i = 0; i < CANVAS_FIT_COUNT; i++)
+	{
+		if (!strcmp(name, canvasFitNames[i]))
+		{
+			return i;
+		}
+	}
+	return UNKNOWN_CANVAS_FIT;
+}
+
+/*
+	Function that prints a project's canvas.
+	Input: canvas - the canvas.
+	Output: None.
+*/
+void printCanvas(const Canvas* canvas)
+{
+	if (isCanvasSet(canvas))
+	{
+		printf("Canvas: %dx%d, %s\n", (int)canvas->width, (int)canvas->height, getCanvasFitName((CanvasFit)canvas->fit));
+	}
+	else
+	{
+		printf("Canvas: off, every frame keeps its own size\n");
+	}
+}
+
+/*
+	Function that fits an image to a canvas sized image. The image itself is never changed, so a cached image can be fitted.
+	Input: image - the BGR image.
+		   fit - how the image is fitted when its shape differs from the canvas.
+		   canvasImage - the BGR image of the canvas size the result is written to.
+	Output: None.
+*/
+void fitImageToCanvas(const IplImage* image, CanvasFit fit, IplImage* canvasImage)
+{
+	IplImage region;
+	long long imageWidth = image->width, imageHeight = image->height;
+	long long canvasWidth = canvasImage->width, canvasHeight = canvasImage->height;
+	int width = 0, height = 0;
+	int wider = imageWidth * canvasHeight >= imageHeight * canvasWidth;
+
+	if (CANVAS_FIT_LETTERBOX == fit)
+	{
+		width = wider ? (int)canvasWidth : (int)(imageWidth * canvasHeight / imageHeight);
+		height = wider ? (int)(imageHeight * canvasWidth / imageWidth) : (int)canvasHeight;
+		width = width ? width : INC;
+		height = height ? height : INC;
+		if (width != canvasImage->width || height != canvasImage->height)
+		{
+			cvZero(canvasImage);
+		}
+		cvInitImageHeader(&region, cvSize(width, height), IPL_DEPTH_8U, canvasImage->nChannels, IPL_ORIGIN_TL, IMAGE_ROW_ALIGNMENT);
+		cvSetData(&region, canvasImage->imageData + (size_t)((canvasImage->height - height) / HALF) * canvasImage->widthStep
+			+ (size_t)((canvasImage->width - width) / HALF) * canvasImage->nChannels, canvasImage->widthStep);
+		cvResize(image, &region, CV_INTER_AREA);
+	}
+	else if (CANVAS_FIT_CROP == fit)
+	{
+		width = wider ? (int)(canvasWidth * imageHeight / canvasHeight) : image->width;
+		height = wider ? image->height : (int)(canvasHeight * imageWidth / canvasWidth);
+		width = width ? width : INC;
+		height = height ? height : INC;
+		cvInitImageHeader(&region, cvSize(width, height), IPL_DEPTH_8U, image->nChannels, IPL_ORIGIN_TL, IMAGE_ROW_ALIGNMENT);
+		cvSetData(&region, image->imageData + (size_t)((image->height - height) / HALF) * image->widthStep
+			+ (size_t)((image->width - width) / HALF) * image->nChannels, image->widthStep);
+		cvResize(&region, canvasImage, CV_INTER_AREA);
+	}
+	else
+	{
+		cvResize(image, canvasImage, CV_INTER_AREA);
+	}
+}
+
+/*
+	Function that returns a frame's image fitted to the canvas through the image cache, with the frame's effects applied.
+	Each image is fitted once and then shared by playback and export, which get buffers of one size for every frame.
+	Input: cache - the decoded image cache.
+		   proxies - the previews folder when playing previews, the preview is fitted to the canvas shrunk to
+					 the preview size. NULL for full resolution.
+		   frame - the frame whose image is needed.
+		   canvas - the project's canvas. Without one the frame's own image, or its preview, is returned.
+	Output: pinned cache entry holding the image, or NULL if the frame's image could not be read.
+*/
+ImageCacheEntry* acquireCanvasImage(ImageCache* cache, ProxyCache* proxies, const Frame* frame, const Canvas* canvas)
+{
+	CanvasRequest request;
+	ImageCacheEntry* entry = NULL;
+	char* canvasKey = NULL;
+	char* key = NULL;
+
+	if (!isCanvasSet(canvas))
+	{
+		return proxies ? acquireProxyImage(proxies, cache, frame) : acquireFrameImage(cache, frame);
+	}
+
+	request.cache = cache;
+	request.proxies = proxies;
+	request.frame = frame;
+	request.size = proxies ? getPreviewCanvasSize(proxies, canvas) : cvSize((int)canvas->width, (int)canvas->height);
+	request.fit = (CanvasFit)canvas->fit;
+	canvasKey = (char*)allocateOrExit(sizeof(char) * (strlen(CANVAS_KEY_FORMAT) + CANVAS_KEY_NUMBER_DIGITS * 2
+		+ strlen(getCanvasFitName(request.fit)) + strlen(PROXY_KEY_PREFIX) + strlen(frame->imageKey) + INC));
+	sprintf(canvasKey, CANVAS_KEY_FORMAT, request.size.width, request.size.height, getCanvasFitName(request.fit),
+		proxies ? PROXY_KEY_PREFIX : "", frame->imageKey);
+	key = createEffectsKey(canvasKey, frame);
+	entry = acquireCachedImage(cache, key, createCanvasImage, &request);
+	free(key);
+	free(canvasKey);
+	return entry;
+}
+
+/*
+	Function that fits the images of new frames to the canvas in parallel, so playback and export find them cached.
+	Each image is decoded, has its effects applied and is resized once, on the pool's workers.
+	Input: list - the project, nothing is done without a canvas.
+		   cache - the image cache the fitted images are kept in.
+		   firstIndex - the index of the first frame to fit, the frames before it are assumed fitted already.
+		   report - where what was done is stored.
+	Output: None.
+*/
+void prepareCanvasImages(FrameList* list, ImageCache* cache, int firstIndex, CanvasReport* report)
+{
+	ThreadPool* pool = NULL;
+	CanvasJob* jobs = NULL;
+	const Frame** frames = NULL;
+	unsigned long long startTime = getMonotonicTimeMicroseconds();
+	int frameCount = frameNodeListLength(list) - firstIndex;
+	int jobCount = 0, firstFrame = 0, i = 0;
+
+	report->frameCount = 0;
+	report->unreadableImages = 0;
+	if (!isCanvasSet(&list->canvas) || frameCount <= 0)
+	{
+		report->microseconds = getMonotonicTimeMicroseconds() - startTime;
+		return;
+	}
+
+	frames = (const Frame**)allocateOrExit(sizeof(Frame*) * frameCount);
+	for (i = 0; i < frameCount; i++)
+	{
+		frames[i] = getFrameAtIndex(list, firstIndex + i);
+	}
+	report->frameCount = frameCount;
+
+	pool = createThreadPool(THREAD_POOL_ONE_PER_PROCESSOR);
+	jobCount = pool->workerCount * CANVAS_JOBS_PER_WORKER;
+	jobCount = jobCount > frameCount ? frameCount : jobCount;
+	jobs = (CanvasJob*)allocateOrExit(sizeof(CanvasJob) * jobCount);
+	for (i = 0; i < jobCount; i++)
+	{
+		jobs[i].cache = cache;
+		jobs[i].canvas = &list->canvas;
+		jobs[i].frames = frames + firstFrame;
+		jobs[i].frameCount = (int)((long long)frameCount * (i + INC) / jobCount) - firstFrame;
+		jobs[i].unreadable = 0;
+		firstFrame += jobs[i].frameCount;
+		submitTask(pool, fitFrames, &jobs[i]);
+	}
+	waitForAllTasks(pool);
+	freeThreadPool(&pool);
+	for (i = 0; i < jobCount; i++)
+	{
+		report->unreadableImages += jobs[i].unreadable;
+	}
+	free(jobs);
+	free(frames);
+	report->microseconds = getMonotonicTimeMicroseconds() - startTime;
+}
+
+/*
+	Function that prints what fitting frames to the canvas did.
+	Input: canvas - the canvas the frames were fitted to.
+		   report - the report of prepareCanvasImages.
+	Output: None.
+*/
+void printCanvasReport(const Canvas* canvas, const CanvasReport* report)
+{
+	if (!report->frameCount)
+	{
+		return;
+	}
+	printf("Fitted %d frames to the %dx%d canvas in %.1f ms\n", report->frameCount, (int)canvas->width, (int)canvas->height,
+		(double)report->microseconds / MICROSECONDS_IN_MILLISECOND);
+	if (report->unreadableImages)
+	{
+		printf("%d images could not be read.\n", report->unreadableImages);
+	}
+}
+
+/*
+	Pool task: fits a range of frames to the canvas and leaves the results in the cache.
+*/
+static void fitFrames(void* argument)
+{
+	CanvasJob* job = (CanvasJob*)argument;
+	ImageCacheEntry* entry = NULL;
+	int i = 0;
+
+	for (i = 0; i < job->frameCount; i++)
+	{
+		entry = acquireCanvasImage(job->cache, NULL, job->frames[i], job->canvas);
+		if (entry)
+		{
+			releaseCachedImage(job->cache, &entry);
+		}
+		else
+		{
+			job->unreadable++;
+		}
+	}
+}
+
+/*
+	Image cache callback: fits the frame's image, or its preview, with its effects applied to the canvas.
+	The source is found through the cache like any frame image, so it is decoded once when frames share it.
+*/
+static IplImage* createCanvasImage(void* argument, MappedFile* mapping)
+{
+	CanvasRequest* request = (CanvasRequest*)argument;
+	ImageCacheEntry* source = NULL;
+	IplImage* image = NULL;
+
+	mapping->data = NULL;
+	source = request->proxies ? acquireProxyImage(request->proxies, request->cache, request->frame)
+		: acquireFrameImage(request->cache, request->frame);
+	if (!source)
+	{
+		return NULL;
+	}
+	image = cvCreateImage(request->size, IPL_DEPTH_8U, BGR_CHANNELS);
+	fitImageToCanvas(source->image, request->fit, image);
+	releaseCachedImage(request->cache, &source);
+	return image;
+}
+
+/*
+	The canvas shrunk to fit the preview size, previews are fitted to it so playback keeps the canvas's shape.
+*/
+static CvSize getPreviewCanvasSize(const ProxyCache* proxies, const Canvas* canvas)
+{
+	long long width = canvas->width, height = canvas->height;
+
+	if (width > proxies->maxWidth || height > proxies->maxHeight)
+	{
+		if (width * proxies->maxHeight >= height * proxies->maxWidth)
+		{
+			height = height * proxies->maxWidth / width;
+			width = proxies->maxWidth;
+		}
+		else
+		{
+			width = width * proxies->maxHeight / height;
+			height = proxies->maxHeight;
+		}
+	}
+	return cvSize(width ? (int)width : INC, height ? (int)height : INC);
+}
+
+static void* allocateOrExit(size_t size)
+{
+	void* memory = malloc(size);
+	if (!memory)
+	{
+		printf("Memory allocation failed!\n");
+		exit(MEMORY_ALLOCATION_ERROR_CODE);
+	}
+	return memory;
+}
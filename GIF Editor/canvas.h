@@ -0,0 +1,66 @@
+/*********************************
+*		GIF EDITOR PROJECT       *
+*       Canvas Declaration       *
+**********************************/
+
+#ifndef CANVASH
+#define CANVASH
+#define CV_IGNORE_DEBUG_BUILD_GUARD
+
+#include <opencv2/core/core_c.h>
+#include "linkedList.h"
+#include "imageCache.h"
+#include "proxyCache.h"
+
+#define MAX_CANVAS_SIZE 16384
+#define CANVAS_KEY_FORMAT "canvas %dx%d %s|%s%s"
+#define CANVAS_KEY_NUMBER_DIGITS 10
+#define CANVAS_JOBS_PER_WORKER 4
+#define UNKNOWN_CANVAS_FIT -1
+
+#define CANVAS_SET 1
+#define CANVAS_NOT_SET 0
+
+// How a frame of another shape is fitted to the canvas:
+// letterbox - the whole frame is shrunk or enlarged to fit inside the canvas and the rest is left black.
+// crop - the frame covers the whole canvas and what sticks out of it on two sides is cut off evenly.
+// stretch - the frame is resized to the canvas size, its proportions change.
+typedef enum CanvasFit
+{
+	CANVAS_FIT_LETTERBOX = 0,
+	CANVAS_FIT_CROP = 1,
+	CANVAS_FIT_STRETCH = 2,
+	CANVAS_FIT_COUNT = 3
+} CanvasFit;
+
+// What fitting a range of frames to the canvas did
+typedef struct CanvasReport
+{
+	int			frameCount;
+	int			unreadableImages;
+	unsigned long long	microseconds;
+} CanvasReport;
+
+int isCanvasValid(const Canvas* canvas);
+
+int isCanvasSet(const Canvas* canvas);
+
+int setCanvas(FrameList* list, int width, int height, CanvasFit fit);
+
+void clearCanvas(FrameList* list);
+
+const char* getCanvasFitName(CanvasFit fit);
+
+int findCanvasFit(const char* name);
+
+void printCanvas(const Canvas* canvas);
+
+void fitImageToCanvas(const IplImage* image, CanvasFit fit, IplImage* canvasImage);
+
+ImageCacheEntry* acquireCanvasImage(ImageCache* cache, ProxyCache* proxies, const Frame* frame, const Canvas* canvas);
+
+void prepareCanvasImages(FrameList* list, ImageCache* cache, int firstIndex, CanvasReport* report);
+
+void printCanvasReport(const Canvas* canvas, const CanvasReport* report);
+
+#endif
@@ -0,0 +1,691 @@
+/*********************************
+*		GIF EDITOR PROJECT       *
+*          Command Line          *
+**********************************/
+
+#define _CRT_SECURE_NO_WARNINGS
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include "cli.h"
+#include "project.h"
+#include "bundle.h"
+#include "gifImport.h"
+#include "batch.h"
+#include "optimize.h"
+#include "proxyCache.h"
+#include "canvas.h"
+
+#define DECIMAL_BASE 10
+#define READ_BINARY_MODE "rb"
+#define MAX_DURATION INT_MAX
+#define MAX_TIME LONG_MAX
+#define PALETTE_MODE_COUNT 3
+#define DITHER_MODE_COUNT 3
+#define FRAME_DIFF_MODE_COUNT 3
+#define FLIP_MODE_COUNT 3
+#define EXACT_DUPLICATES_NAME "exact"
+#define MAX_STORE_MEGABYTES (LONG_MAX / (1024L * 1024L))
+#define BYTES_IN_MEGABYTE_COUNT (1024ull * 1024ull)
+
+static CliResult newCommand(CliContext* context, char** arguments);
+static CliResult loadCommand(CliContext* context, char** arguments);
+static CliResult addCommand(CliContext* context, char** arguments);
+static CliResult removeCommand(CliContext* context, char** arguments);
+static CliResult moveCommand(CliContext* context, char** arguments);
+static CliResult durationCommand(CliContext* context, char** arguments);
+static CliResult durationAllCommand(CliContext* context, char** arguments);
+static CliResult atCommand(CliContext* context, char** arguments);
+static CliResult importCommand(CliContext* context, char** arguments);
+static CliResult dedupeCommand(CliContext* context, char** arguments);
+static CliResult paletteCommand(CliContext* context, char** arguments);
+static CliResult ditherCommand(CliContext* context, char** arguments);
+static CliResult diffCommand(CliContext* context, char** arguments);
+static CliResult fromCommand(CliContext* context, char** arguments);
+static CliResult exportCommand(CliContext* context, char** arguments);
+static CliResult saveCommand(CliContext* context, char** arguments);
+static CliResult bundleCommand(CliContext* context, char** arguments);
+static CliResult listCommand(CliContext* context, char** arguments);
+static CliResult statsCommand(CliContext* context, char** arguments);
+static CliResult previewsCommand(CliContext* context, char** arguments);
+static CliResult storeCommand(CliContext* context, char** arguments);
+static CliResult batchCommand(CliContext* context, char** arguments);
+static CliResult grayscaleCommand(CliContext* context, char** arguments);
+static CliResult brightnessCommand(CliContext* context, char** arguments);
+static CliResult cropCommand(CliContext* context, char** arguments);
+static CliResult resizeCommand(CliContext* context, char** arguments);
+static CliResult flipCommand(CliContext* context, char** arguments);
+static CliResult clearEffectsCommand(CliContext* context, char** arguments);
+static CliResult canvasCommand(CliContext* context, char** arguments);
+static CliResult clearCanvasCommand(CliContext* context, char** arguments);
+static CliResult addEffect(CliContext* context, char* name, const Effect* effect);
+static int parseEffectValues(char** arguments, int count, const long* minValues, const long* maxValues, Effect* effect);
+static const CliCommand* findCommand(const char* name);
+static int parseNumber(const char* text, long minValue, long maxValue, long* value);
+static int frameExists(CliContext* context, char* name);
+static void printUsage(void);
+
+static const char* paletteModeNames[PALETTE_MODE_COUNT] = { "fixed", "global", "frame" };
+static const char* ditherModeNames[DITHER_MODE_COUNT] = { "none", "diffusion", "ordered" };
+static const char* frameDiffModeNames[FRAME_DIFF_MODE_COUNT] = { "off", "rect", "transparent" };
+static const char* flipModeNames[FLIP_MODE_COUNT] = { "horizontal", "vertical", "both" };
+
+static const CliCommand commands[] =
+{
+	{ "new", 0, newCommand, "new                          start an empty project" },
+	{ "load", 1, loadCommand, "load <project>               load a project file or bundle" },
+	{ "add", 3, addCommand, "add <image> <ms> <name>      append a frame" },
+	{ "remove", 1, removeCommand, "remove <name>                remove a frame" },
+	{ "move", 2, moveCommand, "move <name> <position>       move a frame, positions start from 1" },
+	{ "duration", 2, durationCommand, "duration <name> <ms>         set the duration of a frame" },
+	{ "duration-all", 1, durationAllCommand, "duration-all <ms>            set the duration of all frames" },
+	{ "at", 1, atCommand, "at <ms>                      print the frame on screen at a time" },
+	{ "grayscale", 1, grayscaleCommand, "grayscale <name>             add a grayscale effect to a frame" },
+	{ "brightness", 3, brightnessCommand, "brightness <name> <-255-255> <contrast %>  add a brightness and contrast effect to a frame" },
+	{ "crop", 5, cropCommand, "crop <name> <left> <top> <width> <height>  add a crop effect to a frame" },
+	{ "resize", 3, resizeCommand, "resize <name> <width> <height>  add a resize effect to a frame" },
+	{ "flip", 2, flipCommand, "flip <name> <horizontal|vertical|both>  add a flip effect to a frame" },
+	{ "clear-effects", 1, clearEffectsCommand, "clear-effects <name>         remove the effects of a frame" },
+	{ "canvas", 3, canvasCommand, "canvas <width> <height> <letterbox|crop|stretch>  fit every frame to one size" },
+	{ "clear-canvas", 0, clearCanvasCommand, "clear-canvas                 let every frame keep its own size" },
+	{ "import", 2, importCommand, "import <gif> <folder>        append the frames of a GIF" },
+	{ "dedupe", 1, dedupeCommand, "dedupe <exact|0-255>         merge runs of identical frames, or of lookalike frames within a gray level difference" },
+	{ "palette", 1, paletteCommand, "palette <fixed|global|frame> choose the palettes of the next exports" },
+	{ "dither", 1, ditherCommand, "dither <none|diffusion|ordered> choose the dithering of the next exports" },
+	{ "diff", 1, diffCommand, "diff <off|rect|transparent>  choose whether exported frames store only what changed" },
+	{ "from", 1, fromCommand, "from <ms>                    start the next exports at a time of the movie" },
+	{ "export", 1, exportCommand, "export <gif>                 write the timeline as a GIF" },
+	{ "save", 2, saveCommand, "save <folder> <name>         save the project file" },
+	{ "bundle", 2, bundleCommand, "bundle <folder> <name>       save the project with its images embedded" },
+	{ "list", 0, listCommand, "list                         print the frames" },
+	{ "stats", 0, statsCommand, "stats                        print frame, image cache and frame store statistics" },
+	{ "store", 2, storeCommand, "store <folder> <megabytes>   keep decoded frames in a folder for the next runs, up to a size" },
+	{ "previews", 1, previewsCommand, "previews <folder>            make the missing playback previews of the frames in a folder" },
+	{ "batch", 2, batchCommand, "batch <manifest> <report>    process the projects of a manifest in parallel" }
+};
+
+/*
+	Function that runs the editor without the menu: the arguments are a sequence of commands
+	applied in order to one project, like "load a.bin duration-all 50 export a.gif".
+	Nothing is asked from the user and no window is opened, the first failing command stops the run.
+	Input: argc - the number of arguments, without the program name.
+		   argv - the arguments, without the program name.
+	Output: CLI_SUCCESS, or the CliResult of the command that failed, to be used as the exit code.
+*/
+int runCli(int argc, char** argv)
+{
+	CliContext context;
+	const CliCommand* command = NULL;
+	CliResult result = CLI_SUCCESS;
+	int i = 0;
+
+	if (!argc || !strcmp(argv[0], "help") || !strcmp(argv[0], "--help"))
+	{
+		printUsage();
+		return argc ? CLI_SUCCESS : CLI_USAGE_ERROR;
+	}
+
+	context.list = createFrameList();
+	context.cache = createImageCache(IMAGE_CACHE_BUDGET_BYTES);
+	context.store = NULL;
+	initExportOptions(&context.exportOptions);
+	while (CLI_SUCCESS == result && i < argc)
+	{
+		command = findCommand(argv[i]);
+		if (!command)
+		{
+			fprintf(stderr, "Unknown command: %s\n", argv[i]);
+			result = CLI_USAGE_ERROR;
+		}
+		else if (i + command->argumentCount >= argc)
+		{
+			fprintf(stderr, "Missing arguments, usage: %s\n", command->usage);
+			result = CLI_USAGE_ERROR;
+		}
+		else
+		{
+			result = command->run(&context, argv + i + INC);
+			if (CLI_SUCCESS != result)
+			{
+				fprintf(stderr, "Command failed: %s\n", command->name);
+			}
+			i += command->argumentCount + INC;
+		}
+	}
+
+	freeFrameNodeList(&context.list);
+	freeImageCache(&context.cache);
+	closeFrameStore(&context.store);
+	return result;
+}
+
+static CliResult newCommand(CliContext* context, char** arguments)
+{
+	(void)arguments;
+	freeFrameNodeList(&context->list);
+	context->list = createFrameList();
+	return CLI_SUCCESS;
+}
+
+static CliResult loadCommand(CliContext* context, char** arguments)
+{
+	FrameList* list = NULL;
+	FILE* file = fopen(arguments[0], READ_BINARY_MODE);
+
+	if (!file)
+	{
+		fprintf(stderr, "Cannot open file %s\n", arguments[0]);
+		return CLI_LOAD_ERROR;
+	}
+	fclose(file);
+	list = loadProject(arguments[0]);
+	if (!list)
+	{
+		return CLI_LOAD_ERROR;
+	}
+	freeFrameNodeList(&context->list);
+	context->list = list;
+	return CLI_SUCCESS;
+}
+
+static CliResult addCommand(CliContext* context, char** arguments)
+{
+	FILE* file = NULL;
+	long duration = 0;
+
+	if (!parseNumber(arguments[1], 0, MAX_DURATION, &duration))
+	{
+		return CLI_USAGE_ERROR;
+	}
+	file = fopen(arguments[0], READ_BINARY_MODE);
+	if (!file)
+	{
+		fprintf(stderr, "Cannot find image %s\n", arguments[0]);
+		return CLI_FRAME_ERROR;
+	}
+	fclose(file);
+	if (findFrameNodeByFrameNameInList(context->list, arguments[2]))
+	{
+		fprintf(stderr, "The name %s is already taken\n", arguments[2]);
+		return CLI_FRAME_ERROR;
+	}
+	insertFrameToList(context->list, createFrame(context->list, arguments[2], (unsigned int)duration, arguments[0]));
+	return CLI_SUCCESS;
+}
+
+static CliResult removeCommand(CliContext* context, char** arguments)
+{
+	if (!frameExists(context, arguments[0]))
+	{
+		return CLI_FRAME_ERROR;
+	}
+	removeFrameNodeFromList(context->list, arguments[0]);
+	return CLI_SUCCESS;
+}
+
+static CliResult moveCommand(CliContext* context, char** arguments)
+{
+	long position = 0;
+
+	if (!frameExists(context, arguments[0]))
+	{
+		return CLI_FRAME_ERROR;
+	}
+	if (!parseNumber(arguments[1], FIRST_NODE_INDEX, frameNodeListLength(context->list), &position))
+	{
+		return CLI_USAGE_ERROR;
+	}
+	changeFrameNodePosition(context->list, arguments[0], (int)position);
+	return CLI_SUCCESS;
+}
+
+static CliResult durationCommand(CliContext* context, char** arguments)
+{
+	long duration = 0;
+
+	if (!frameExists(context, arguments[0]))
+	{
+		return CLI_FRAME_ERROR;
+	}
+	if (!parseNumber(arguments[1], 0, MAX_DURATION, &duration))
+	{
+		return CLI_USAGE_ERROR;
+	}
+	changeFrameNodeDurationInList(context->list, arguments[0], (unsigned int)duration);
+	return CLI_SUCCESS;
+}
+
+static CliResult durationAllCommand(CliContext* context, char** arguments)
+{
+	long duration = 0;
+
+	if (!parseNumber(arguments[0], 0, MAX_DURATION, &duration))
+	{
+		return CLI_USAGE_ERROR;
+	}
+	changeAllFrameNodesDurationsInList(context->list, (unsigned int)duration);
+	return CLI_SUCCESS;
+}
+
+static CliResult atCommand(CliContext* context, char** arguments)
+{
+	Frame* frame = NULL;
+	long time = 0;
+	int index = 0;
+
+	if (!parseNumber(arguments[0], 0, MAX_TIME, &time))
+	{
+		return CLI_USAGE_ERROR;
+	}
+	index = findFrameAtTime(context->list, (uint64_t)time);
+	if (TIMELINE_END == index)
+	{
+		fprintf(stderr, "The movie is only %llu ms long\n", (unsigned long long)getTimelineDuration(context->list));
+		return CLI_FRAME_ERROR;
+	}
+	frame = getFrameAtIndex(context->list, index);
+	printf("%s (frame %d) is on screen from %llu ms for %u ms\n", frame->name, index + FIRST_NODE_INDEX,
+		(unsigned long long)getFrameStartTime(context->list, index), frame->duration);
+	return CLI_SUCCESS;
+}
+
+static CliResult importCommand(CliContext* context, char** arguments)
+{
+	ImportResult result = IMPORT_SUCCESS;
+	CanvasReport report;
+	int firstIndex = frameNodeListLength(context->list);
+	int importedCount = 0;
+
+	result = importGif(context->list, arguments[0], arguments[1], &importedCount);
+	if (IMPORT_SUCCESS != result)
+	{
+		fprintf(stderr, "%s, %d frames were added\n", importResultMessage(result), importedCount);
+		return CLI_IMPORT_ERROR;
+	}
+	printf("%d frames were added.\n", importedCount);
+	prepareCanvasImages(context->list, context->cache, firstIndex, &report);
+	printCanvasReport(&context->list->canvas, &report);
+	return CLI_SUCCESS;
+}
+
+static CliResult dedupeCommand(CliContext* context, char** arguments)
+{
+	DuplicateReport report;
+	long maxDifference = EXACT_DUPLICATES_ONLY;
+
+	if (strcmp(arguments[0], EXACT_DUPLICATES_NAME) && !parseNumber(arguments[0], 0, MAX_LOOKALIKE_DIFFERENCE, &maxDifference))
+	{
+		return CLI_USAGE_ERROR;
+	}
+	mergeDuplicateFrames(context->list, context->cache, (int)maxDifference, &report);
+	printDuplicateReport(&report);
+	return CLI_SUCCESS;
+}
+
+static CliResult paletteCommand(CliContext* context, char** arguments)
+{
+	int mode = 0;
+
+	for (mode = 0; mode < PALETTE_MODE_COUNT; mode++)
+	{
+		if (!strcmp(paletteModeNames[mode], arguments[0]))
+		{
+			context->exportOptions.paletteMode = (PaletteMode)mode;
+			return CLI_SUCCESS;
+		}
+	}
+	fprintf(stderr, "Unknown palette %s, expected fixed, global or frame\n", arguments[0]);
+	return CLI_USAGE_ERROR;
+}
+
+static CliResult ditherCommand(CliContext* context, char** arguments)
+{
+	int mode = 0;
+
+	for (mode = 0; mode < DITHER_MODE_COUNT; mode++)
+	{
+		if (!strcmp(ditherModeNames[mode], arguments[0]))
+		{
+			context->exportOptions.ditherMode = (DitherMode)mode;
+			return CLI_SUCCESS;
+		}
+	}
+	fprintf(stderr, "Unknown dithering %s, expected none, diffusion or ordered\n", arguments[0]);
+	return CLI_USAGE_ERROR;
+}
+
+static CliResult diffCommand(CliContext* context, char** arguments)
+{
+	int mode = 0;
+
+	for (mode = 0; mode < FRAME_DIFF_MODE_COUNT; mode++)
+	{
+		if (!strcmp(frameDiffModeNames[mode], arguments[0]))
+		{
+			context->exportOptions.frameDiffMode = (FrameDiffMode)mode;
+			return CLI_SUCCESS;
+		}
+	}
+	fprintf(stderr, "Unknown frame diff %s, expected off, rect or transparent\n", arguments[0]);
+	return CLI_USAGE_ERROR;
+}
+
+static CliResult fromCommand(CliContext* context, char** arguments)
+{
+	long time = 0;
+
+	if (!parseNumber(arguments[0], 0, MAX_TIME, &time))
+	{
+		return CLI_USAGE_ERROR;
+	}
+	context->exportOptions.startTime = (uint64_t)time;
+	return CLI_SUCCESS;
+}
+
+static CliResult exportCommand(CliContext* context, char** arguments)
+{
+	ExportResult result = exportGif(context->list, context->cache, arguments[0], &context->exportOptions);
+
+	if (EXPORT_SUCCESS != result)
+	{
+		fprintf(stderr, "%s\n", exportResultMessage(result));
+		return CLI_EXPORT_ERROR;
+	}
+	return CLI_SUCCESS;
+}
+
+static CliResult saveCommand(CliContext* context, char** arguments)
+{
+	return PROJECT_SAVED == saveProject(context->list, arguments[0], arguments[1]) ? CLI_SUCCESS : CLI_SAVE_ERROR;
+}
+
+static CliResult bundleCommand(CliContext* context, char** arguments)
+{
+	return PROJECT_SAVED == saveBundle(context->list, arguments[0], arguments[1]) ? CLI_SUCCESS : CLI_SAVE_ERROR;
+}
+
+static CliResult listCommand(CliContext* context, char** arguments)
+{
+	(void)arguments;
+	printFrameNodeList(context->list);
+	return CLI_SUCCESS;
+}
+
+static CliResult statsCommand(CliContext* context, char** arguments)
+{
+	int embeddedImages = 0;
+	int i = 0;
+
+	(void)arguments;
+	for (i = 0; i < frameNodeListLength(context->list); i++)
+	{
+		embeddedImages += getFrameAtIndex(context->list, i)->imageData ? INC : 0;
+	}
+	printf("Frames: %d\n", frameNodeListLength(context->list));
+	printf("Total duration: %llu ms\n", (unsigned long long)getTimelineDuration(context->list));
+	printf("Frames with embedded images: %d\n", embeddedImages);
+	printCanvas(&context->list->canvas);
+	printImageCacheStats(context->cache);
+	if (context->store)
+	{
+		printFrameStoreStats(context->store);
+	}
+	return CLI_SUCCESS;
+}
+
+static CliResult previewsCommand(CliContext* context, char** arguments)
+{
+	ProxyCache* proxies = openProxyCache(arguments[0]);
+	ProxyReport report;
+	int ready = PROXY_NOT_READY;
+
+	if (!proxies)
+	{
+		return CLI_PREVIEW_ERROR;
+	}
+	ready = prepareProxies(proxies, context->list, &report);
+	printProxyReport(&report);
+	closeProxyCache(&proxies);
+	return PROXY_READY == ready ? CLI_SUCCESS : CLI_PREVIEW_ERROR;
+}
+
+static CliResult storeCommand(CliContext* context, char** arguments)
+{
+	FrameStore* store = NULL;
+	long megabytes = 0;
+
+	if (!parseNumber(arguments[1], INC, MAX_STORE_MEGABYTES, &megabytes))
+	{
+		return CLI_USAGE_ERROR;
+	}
+	store = openFrameStore(arguments[0], (unsigned long long)megabytes * BYTES_IN_MEGABYTE_COUNT);
+	if (!store)
+	{
+		return CLI_STORE_ERROR;
+	}
+	// images mapped from the previous store keep their own mappings
+	attachFrameStore(context->cache, store);
+	closeFrameStore(&context->store);
+	context->store = store;
+	return CLI_SUCCESS;
+}
+
+static CliResult batchCommand(CliContext* context, char** arguments)
+{
+	BatchResult result = runBatch(arguments[0], arguments[1], context->cache, &context->exportOptions);
+
+	if (BATCH_SUCCESS != result)
+	{
+		fprintf(stderr, "%s\n", batchResultMessage(result));
+		return CLI_BATCH_ERROR;
+	}
+	return CLI_SUCCESS;
+}
+
+static CliResult grayscaleCommand(CliContext* context, char** arguments)
+{
+	Effect effect = { EFFECT_GRAYSCALE, { 0 } };
+
+	return addEffect(context, arguments[0], &effect);
+}
+
+static CliResult brightnessCommand(CliContext* context, char** arguments)
+{
+	static const long minValues[] = { MIN_BRIGHTNESS, MIN_CONTRAST_PERCENT };
+	static const long maxValues[] = { MAX_BRIGHTNESS, MAX_CONTRAST_PERCENT };
+	Effect effect = { EFFECT_BRIGHTNESS_CONTRAST, { 0 } };
+
+	if (!parseEffectValues(arguments + INC, sizeof(minValues) / sizeof(minValues[0]), minValues, maxValues, &effect))
+	{
+		return CLI_USAGE_ERROR;
+	}
+	return addEffect(context, arguments[0], &effect);
+}
+
+static CliResult cropCommand(CliContext* context, char** arguments)
+{
+	static const long minValues[] = { 0, 0, INC, INC };
+	static const long maxValues[] = { MAX_EFFECT_SIZE - INC, MAX_EFFECT_SIZE - INC, MAX_EFFECT_SIZE, MAX_EFFECT_SIZE };
+	Effect effect = { EFFECT_CROP, { 0 } };
+
+	if (!parseEffectValues(arguments + INC, sizeof(minValues) / sizeof(minValues[0]), minValues, maxValues, &effect))
+	{
+		return CLI_USAGE_ERROR;
+	}
+	return addEffect(context, arguments[0], &effect);
+}
+
+static CliResult resizeCommand(CliContext* context, char** arguments)
+{
+	static const long minValues[] = { INC, INC };
+	static const long maxValues[] = { MAX_EFFECT_SIZE, MAX_EFFECT_SIZE };
+	Effect effect = { EFFECT_RESIZE, { 0 } };
+
+	if (!parseEffectValues(arguments + INC, sizeof(minValues) / sizeof(minValues[0]), minValues, maxValues, &effect))
+	{
+		return CLI_USAGE_ERROR;
+	}
+	return addEffect(context, arguments[0], &effect);
+}
+
+static CliResult flipCommand(CliContext* context, char** arguments)
+{
+	Effect effect = { EFFECT_FLIP, { 0 } };
+	int mode = 0;
+
+	for (mode = 0; mode < FLIP_MODE_COUNT; mode++)
+	{
+		if (!strcmp(flipModeNames[mode], arguments[1]))
+		{
+			// the names are in the order of FLIP_HORIZONTAL, FLIP_VERTICAL and FLIP_BOTH
+			effect.values[0] = mode + INC;
+			return addEffect(context, arguments[0], &effect);
+		}
+	}
+	fprintf(stderr, "Unknown flip %s, expected horizontal, vertical or both\n", arguments[1]);
+	return CLI_USAGE_ERROR;
+}
+
+static CliResult clearEffectsCommand(CliContext* context, char** arguments)
+{
+	Frame* frame = NULL;
+
+	if (!frameExists(context, arguments[0]))
+	{
+		return CLI_FRAME_ERROR;
+	}
+	frame = findFrameNodeByFrameNameInList(context->list, arguments[0]);
+	setFrameEffects(context->list, frame, NULL, 0);
+	printFrameEffects(frame);
+	return CLI_SUCCESS;
+}
+
+static CliResult canvasCommand(CliContext* context, char** arguments)
+{
+	long width = 0, height = 0;
+	int fit = findCanvasFit(arguments[2]);
+
+	if (!parseNumber(arguments[0], INC, MAX_CANVAS_SIZE, &width) || !parseNumber(arguments[1], INC, MAX_CANVAS_SIZE, &height))
+	{
+		return CLI_USAGE_ERROR;
+	}
+	if (UNKNOWN_CANVAS_FIT == fit)
+	{
+		fprintf(stderr, "Unknown fit %s, expected letterbox, crop or stretch\n", arguments[2]);
+		return CLI_USAGE_ERROR;
+	}
+	setCanvas(context->list, (int)width, (int)height, (CanvasFit)fit);
+	printCanvas(&context->list->canvas);
+	return CLI_SUCCESS;
+}
+
+static CliResult clearCanvasCommand(CliContext* context, char** arguments)
+{
+	(void)arguments;
+	clearCanvas(context->list);
+	printCanvas(&context->list->canvas);
+	return CLI_SUCCESS;
+}
+
+/*
+	Adds an effect to the end of a frame's effects and prints them.
+*/
+static CliResult addEffect(CliContext* context, char* name, const Effect* effect)
+{
+	Frame* frame = NULL;
+
+	if (!frameExists(context, name))
+	{
+		return CLI_FRAME_ERROR;
+	}
+	frame = findFrameNodeByFrameNameInList(context->list, name);
+	if (EFFECT_NOT_ADDED == addFrameEffect(context->list, frame, effect))
+	{
+		fprintf(stderr, "The frame %s already has %d effects\n", name, MAX_EFFECTS_PER_FRAME);
+		return CLI_EFFECT_ERROR;
+	}
+	printFrameEffects(frame);
+	return CLI_SUCCESS;
+}
+
+/*
+	Parses the values of an effect, each in its own range.
+*/
+static int parseEffectValues(char** arguments, int count, const long* minValues, const long* maxValues, Effect* effect)
+{
+	long value = 0;
+	int i = 0;
+
+	for (i = 0; i < count; i++)
+	{
+		if (!parseNumber(arguments[i], minValues[i], maxValues[i], &value))
+		{
+			return FALSE;
+		}
+		effect->values[i] = (int32_t)value;
+	}
+	return TRUE;
+}
+
+/*
+	Finds a command by its name, or returns NULL.
+*/
+static const CliCommand* findCommand(const char* name)
+{
+	size_t i = 0;
+
+	for (i = 0; i < sizeof(commands) / sizeof(commands[0]); i++)
+	{
+		if (!strcmp(commands[i].name, name))
+		{
+			return &commands[i];
+		}
+	}
+	return NULL;
+}
+
+/*
+	Parses a whole decimal argument in the given range, printing an error if it is not one.
+*/
+static int parseNumber(const char* text, long minValue, long maxValue, long* value)
+{
+	char* end = NULL;
+	long long number = strtoll(text, &end, DECIMAL_BASE);
+
+	if (end == text || *end || number < minValue || number > maxValue)
+	{
+		fprintf(stderr, "Expected a number from %ld to %ld, got %s\n", minValue, maxValue, text);
+		return FALSE;
+	}
+	*value = (long)number;
+	return TRUE;
+}
+
+/*
+	Checks that a frame with the name exists, printing an error if it does not.
+*/
+static int frameExists(CliContext* context, char* name)
+{
+	if (!findFrameNodeByFrameNameInList(context->list, name))
+	{
+		fprintf(stderr, "The frame %s does not exist\n", name);
+		return FALSE;
+	}
+	return TRUE;
+}
+
+static void printUsage(void)
+{
+	size_t i = 0;
+
+	printf("Usage: GIF Editor <command> [arguments] [<command> [arguments]]...\n");
+	printf("Commands run in order on one project, which starts empty:\n");
+	for (i = 0; i < sizeof(commands) / sizeof(commands[0]); i++)
+	{
+		printf("  %s\n", commands[i].usage);
+	}
+	printf("Exit codes: 0 success, 1 out of memory, 2 usage error, 3 frame error, 4 load error,\n");
+	printf("            5 save error, 6 export error, 7 import error, 8 batch error, 9 preview error,\n");
+	printf("            10 store error, 11 effect error\n");
+}
@@ -0,0 +1,51 @@
+/*********************************
+*		GIF EDITOR PROJECT       *
+*    Command Line Declaration    *
+**********************************/
+
+#ifndef CLIH
+#define CLIH
+
+#include "linkedList.h"
+#include "imageCache.h"
+#include "gifExport.h"
+
+// Exit codes of the command line mode, 1 is left for memory allocation failures
+typedef enum CliResult
+{
+	CLI_SUCCESS = 0,
+	CLI_USAGE_ERROR = 2,
+	CLI_FRAME_ERROR = 3,
+	CLI_LOAD_ERROR = 4,
+	CLI_SAVE_ERROR = 5,
+	CLI_EXPORT_ERROR = 6,
+	CLI_IMPORT_ERROR = 7,
+	CLI_BATCH_ERROR = 8,
+	CLI_PREVIEW_ERROR = 9,
+	CLI_STORE_ERROR = 10,
+	CLI_EFFECT_ERROR = 11
+} CliResult;
+
+// What the commands of one run work on, the project starts empty
+typedef struct CliContext
+{
+	FrameList*	list;
+	ImageCache*	cache;
+	FrameStore*	store;
+	ExportOptions	exportOptions;
+} CliContext;
+
+typedef CliResult (*CliCommandFunction)(CliContext* context, char** arguments);
+
+// A command name, the number of arguments that follow it and what it does
+typedef struct CliCommand
+{
+	const char*		name;
+	int			argumentCount;
+	CliCommandFunction	run;
+	const char*		usage;
+} CliCommand;
+
+int runCli(int argc, char** argv);
+
+#endif
@@ -0,0 +1,358 @@
+/*********************************
+*		GIF EDITOR PROJECT       *
+*           Dithering            *
+**********************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "dither.h"
+#include "linkedList.h"
+#include "tileExecutor.h"
+#include "pixelKernels.h"
+#ifdef PLATFORM_X86
+#include <emmintrin.h>
+#endif
+
+#define COLOR_CHANNELS 3
+#define BGR_BLUE 0
+#define BGR_GREEN 1
+#define BGR_RED 2
+#define MAX_CHANNEL_VALUE 255
+#define RIGHT_WEIGHT 7
+#define BELOW_LEFT_WEIGHT 3
+#define BELOW_WEIGHT 5
+#define BELOW_RIGHT_WEIGHT 1
+#define ERROR_ROUNDING (1 << (DITHER_ERROR_SHIFT - 1))
+#define SSE2_VECTOR_BYTES 16
+#define ORDERED_BYTES_PER_PIXEL (2 * BGRA_PIXEL_CHANNELS + 1)
+
+// One error diffusion of an image, shared by the threads working on its rows
+typedef struct DiffusionContext
+{
+	const ColorMap*		map;
+	const IplImage*		image;
+	unsigned char*		indices;
+	int*			errors;
+	int			errorRowCount;
+	int*			rowProgress;
+	int			nextRow;
+	int			unfinishedWorkers;
+	Mutex			lock;
+	Condition		progressMade;
+} DiffusionContext;
+
+typedef void (*OffsetRowFunction)(const unsigned char* pixels, const unsigned char* raise, const unsigned char* lower,
+	unsigned char* adjusted, int count);
+
+// One ordered dither of an image, shared by its tiles.
+// raise and lower hold BAYER_SIZE rows of the pattern as wide as the image.
+typedef struct OrderedDither
+{
+	const ColorMap*		map;
+	const IplImage*		image;
+	unsigned char*		indices;
+	const unsigned char*	raise;
+	const unsigned char*	lower;
+	size_t			rowBytes;
+	OffsetRowFunction	offsetRow;
+	PixelKernels		kernels;
+} OrderedDither;
+
+static const unsigned char bayerMatrix[BAYER_SIZE][BAYER_SIZE] =
+{
+	{ 0, 32, 8, 40, 2, 34, 10, 42 },
+	{ 48, 16, 56, 24, 50, 18, 58, 26 },
+	{ 12, 44, 4, 36, 14, 46, 6, 38 },
+	{ 60, 28, 52, 20, 62, 30, 54, 22 },
+	{ 3, 35, 11, 43, 1, 33, 9, 41 },
+	{ 51, 19, 59, 27, 49, 17, 57, 25 },
+	{ 15, 47, 7, 39, 13, 45, 5, 37 },
+	{ 63, 31, 55, 23, 61, 29, 53, 21 }
+};
+
+static void diffuseRows(void* argument);
+static void diffuseRow(DiffusionContext* context, int y);
+static void ditherOrderedTile(void* context, const ImageTile* tile);
+static int clampChannel(int value);
+static void offsetRowScalar(const unsigned char* pixels, const unsigned char* raise, const unsigned char* lower,
+	unsigned char* adjusted, int count);
+#ifdef PLATFORM_X86
+static void offsetRowSse2(const unsigned char* pixels, const unsigned char* raise, const unsigned char* lower,
+	unsigned char* adjusted, int count);
+#endif
+
+/*
+	Function that maps an image to a palette with Floyd-Steinberg error diffusion, its rows spread over a thread pool.
+	Each pixel's error goes to pixels of the next row, so a row may only reach a column once the row above is past it.
+	The rows advance as a diagonal wavefront: every thread claims the next row and follows the row above
+	DITHER_BLOCK_WIDTH columns at a time. The calling thread works on rows too and the result does not depend on the thread count.
+	Input: map - a built color map of the palette.
+		   image - 8 bit, 3 channel BGR image.
+		   indices - where the width * height indices are stored, row after row.
+		   pool - the pool to share the rows with, the calling thread helps it while waiting.
+	Output: None.
+*/
+void ditherFloydSteinberg(const ColorMap* map, const IplImage* image, unsigned char* indices, ThreadPool* pool)
+{
+	DiffusionContext context;
+	int workerCount = pool->workerCount + INC;
+	int i = 0;
+
+	if (workerCount > image->height)
+	{
+		workerCount = image->height;
+	}
+	context.map = map;
+	context.image = image;
+	context.indices = indices;
+	// Rows finish in order, so at most workerCount rows are unfinished and each needs the error row below it
+	context.errorRowCount = workerCount + INC;
+	context.errors = (int*)calloc((size_t)context.errorRowCount * (image->width + 2) * COLOR_CHANNELS, sizeof(int));
+	context.rowProgress = (int*)calloc(image->height, sizeof(int));
+	if (!context.errors || !context.rowProgress)
+	{
+		printf("Memory allocation failed!\n");
+		exit(MEMORY_ALLOCATION_ERROR_CODE);
+	}
+	context.nextRow = 0;
+	context.unfinishedWorkers = workerCount;
+	initMutex(&context.lock);
+	initCondition(&context.progressMade);
+
+	for (i = INC; i < workerCount; i++)
+	{
+		submitTask(pool, diffuseRows, &context);
+	}
+	diffuseRows(&context);
+
+	lockMutex(&context.lock);
+	while (context.unfinishedWorkers)
+	{
+		unlockMutex(&context.lock);
+		if (runPendingTask(pool))
+		{
+			lockMutex(&context.lock);
+			continue;
+		}
+		lockMutex(&context.lock);
+		if (context.unfinishedWorkers)
+		{
+			waitCondition(&context.progressMade, &context.lock);
+		}
+	}
+	unlockMutex(&context.lock);
+
+	destroyCondition(&context.progressMade);
+	destroyMutex(&context.lock);
+	free(context.rowProgress);
+	free(context.errors);
+}
+
+/*
+	Function that maps an image to a palette with an 8x8 Bayer ordered dither.
+	The threshold pattern is added to the rows with saturating vector adds, then every pixel is looked up in the color map.
+	Each pixel only depends on its own position, so large images are dithered in tiles in parallel when called from a pool task.
+	Input: map - a built color map of the palette.
+		   image - 8 bit BGR or BGRA image.
+		   indices - where the width * height indices are stored, row after row.
+	Output: None.
+*/
+void ditherOrdered(const ColorMap* map, const IplImage* image, unsigned char* indices)
+{
+	OrderedDither dither;
+	size_t rowBytes = 0;
+	unsigned char* raise = NULL;
+	unsigned char* lower = NULL;
+	int offset = 0, x = 0, y = 0, channel = 0;
+
+	choosePixelKernels(getPixelFormat(image), &dither.kernels);
+	rowBytes = (size_t)image->width * dither.kernels.channels;
+	raise = (unsigned char*)malloc(rowBytes * BAYER_SIZE);
+	lower = (unsigned char*)malloc(rowBytes * BAYER_SIZE);
+	if (!raise || !lower)
+	{
+		printf("Memory allocation failed!\n");
+		exit(MEMORY_ALLOCATION_ERROR_CODE);
+	}
+	dither.offsetRow = offsetRowScalar;
+#ifdef PLATFORM_X86
+	if (getCpuFeatures() & CPU_FEATURE_SSE2)
+	{
+		dither.offsetRow = offsetRowSse2;
+	}
+#endif
+
+	// The pattern is centered on zero and split into what is added and what is subtracted, as bytes can not be negative
+	for (y = 0; y < BAYER_SIZE; y++)
+	{
+		for (x = 0; x < image->width; x++)
+		{
+			offset = ((2 * bayerMatrix[y][x % BAYER_SIZE] + INC) * BAYER_SPREAD) / (2 * BAYER_SIZE * BAYER_SIZE) - BAYER_SPREAD / 2;
+			for (channel = 0; channel < dither.kernels.channels; channel++)
+			{
+				raise[y * rowBytes + (size_t)x * dither.kernels.channels + channel] = (unsigned char)(offset > 0 ? offset : 0);
+				lower[y * rowBytes + (size_t)x * dither.kernels.channels + channel] = (unsigned char)(offset < 0 ? -offset : 0);
+			}
+		}
+	}
+
+	dither.map = map;
+	dither.image = image;
+	dither.indices = indices;
+	dither.raise = raise;
+	dither.lower = lower;
+	dither.rowBytes = rowBytes;
+	runTiled(image->width, image->height, ORDERED_BYTES_PER_PIXEL, ditherOrderedTile, &dither);
+
+	free(lower);
+	free(raise);
+}
+
+/*
+	Tile kernel: adds the pattern to each row of one tile and looks its pixels up in the color map.
+*/
+static void ditherOrderedTile(void* context, const ImageTile* tile)
+{
+	const OrderedDither* dither = (const OrderedDither*)context;
+	const IplImage* image = dither->image;
+	int channels = dither->kernels.channels;
+	size_t tileOffset = (size_t)tile->left * channels;
+	unsigned char* adjusted = (unsigned char*)malloc((size_t)tile->width * channels);
+	int y = 0;
+
+	if (!adjusted)
+	{
+		printf("Memory allocation failed!\n");
+		exit(MEMORY_ALLOCATION_ERROR_CODE);
+	}
+	for (y = tile->top; y < tile->top + tile->height; y++)
+	{
+		dither->offsetRow((const unsigned char*)image->imageData + (size_t)y * image->widthStep + tileOffset,
+			dither->raise + (y % BAYER_SIZE) * dither->rowBytes + tileOffset, dither->lower + (y % BAYER_SIZE) * dither->rowBytes + tileOffset,
+			adjusted, tile->width * channels);
+		dither->kernels.lookupRow(dither->map->nearest, adjusted, dither->indices + (size_t)y * image->width + tile->left, tile->width);
+	}
+	free(adjusted);
+}
+
+/*
+	Pool task: claims rows one after another and diffuses them, until no rows are left.
+*/
+static void diffuseRows(void* argument)
+{
+	DiffusionContext* context = (DiffusionContext*)argument;
+	int y = 0;
+
+	while (TRUE)
+	{
+		lockMutex(&context->lock);
+		y = context->nextRow++;
+		if (y >= context->image->height)
+		{
+			context->unfinishedWorkers--;
+			broadcastCondition(&context->progressMade);
+			unlockMutex(&context->lock);
+			return;
+		}
+		unlockMutex(&context->lock);
+		diffuseRow(context, y);
+	}
+}
+
+/*
+	Diffuses one row block by block, waiting before each block until the row above has passed it.
+	The row's errors were left by the row above, the errors for the row below are written to the next error row of the ring.
+*/
+static void diffuseRow(DiffusionContext* context, int y)
+{
+	const IplImage* image = context->image;
+	const unsigned char* pixel = (const unsigned char*)image->imageData + (size_t)y * image->widthStep;
+	const unsigned char* color = NULL;
+	size_t errorRowSize = (size_t)(image->width + 2) * COLOR_CHANNELS;
+	int* current = context->errors + (y % context->errorRowCount) * errorRowSize + COLOR_CHANNELS;
+	int* below = context->errors + ((y + INC) % context->errorRowCount) * errorRowSize + COLOR_CHANNELS;
+	unsigned char* indices = context->indices + (size_t)y * image->width;
+	int carry[COLOR_CHANNELS] = { 0 };
+	int value[COLOR_CHANNELS] = { 0 };
+	int error = 0, index = 0, blockEnd = 0, needed = 0;
+	int x = 0, channel = 0;
+
+	memset(below - COLOR_CHANNELS, 0, errorRowSize * sizeof(int));
+	for (x = 0; x < image->width; x = blockEnd)
+	{
+		blockEnd = x + DITHER_BLOCK_WIDTH < image->width ? x + DITHER_BLOCK_WIDTH : image->width;
+		if (y)
+		{
+			needed = blockEnd + INC < image->width ? blockEnd + INC : image->width;
+			lockMutex(&context->lock);
+			while (context->rowProgress[y - INC] < needed)
+			{
+				waitCondition(&context->progressMade, &context->lock);
+			}
+			unlockMutex(&context->lock);
+		}
+
+		for (; x < blockEnd; x++, pixel += COLOR_CHANNELS)
+		{
+			for (channel = 0; channel < COLOR_CHANNELS; channel++)
+			{
+				value[channel] = clampChannel(pixel[channel]
+					+ ((current[x * COLOR_CHANNELS + channel] + carry[channel] + ERROR_ROUNDING) >> DITHER_ERROR_SHIFT));
+			}
+			index = context->map->nearest[QUANTIZE_KEY(value[BGR_BLUE], value[BGR_GREEN], value[BGR_RED])];
+			indices[x] = (unsigned char)index;
+			color = context->map->palette.colors[index];
+			for (channel = 0; channel < COLOR_CHANNELS; channel++)
+			{
+				// The palette is stored red, green, blue and the pixels blue, green, red
+				error = value[channel] - color[BGR_RED - channel];
+				carry[channel] = error * RIGHT_WEIGHT;
+				below[(x - INC) * COLOR_CHANNELS + channel] += error * BELOW_LEFT_WEIGHT;
+				below[x * COLOR_CHANNELS + channel] += error * BELOW_WEIGHT;
+				below[(x + INC) * COLOR_CHANNELS + channel] += error * BELOW_RIGHT_WEIGHT;
+			}
+		}
+
+		lockMutex(&context->lock);
+		context->rowProgress[y] = blockEnd;
+		broadcastCondition(&context->progressMade);
+		unlockMutex(&context->lock);
+	}
+}
+
+static int clampChannel(int value)
+{
+	return value < 0 ? 0 : value > MAX_CHANNEL_VALUE ? MAX_CHANNEL_VALUE : value;
+}
+
+static void offsetRowScalar(const unsigned char* pixels, const unsigned char* raise, const unsigned char* lower,
+	unsigned char* adjusted, int count)
+{
+	int i = 0;
+
+	for (i = 0; i < count; i++)
+	{
+		adjusted[i] = (unsigned char)clampChannel(pixels[i] + raise[i] - lower[i]);
+	}
+}
+
+#ifdef PLATFORM_X86
+/*
+	offsetRowScalar 16 bytes at a time with saturating adds and subtracts, the remainder is done one byte at a time.
+*/
+TARGET_SSE2 static void offsetRowSse2(const unsigned char* pixels, const unsigned char* raise, const unsigned char* lower,
+	unsigned char* adjusted, int count)
+{
+	__m128i values;
+	int i = 0;
+
+	for (i = 0; i + SSE2_VECTOR_BYTES <= count; i += SSE2_VECTOR_BYTES)
+	{
+		values = _mm_adds_epu8(_mm_loadu_si128((const __m128i*)(pixels + i)), _mm_loadu_si128((const __m128i*)(raise + i)));
+		values = _mm_subs_epu8(values, _mm_loadu_si128((const __m128i*)(lower + i)));
+		_mm_storeu_si128((__m128i*)(adjusted + i), values);
+	}
+	offsetRowScalar(pixels + i, raise + i, lower + i, adjusted + i, count - i);
+}
+#endif
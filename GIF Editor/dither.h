@@ -0,0 +1,28 @@
+/*********************************
+*		GIF EDITOR PROJECT       *
+*      Dithering Declaration     *
+**********************************/
+
+#ifndef DITHERH
+#define DITHERH
+
+#include "quantize.h"
+#include "threadPool.h"
+
+#define DITHER_BLOCK_WIDTH 64
+#define DITHER_ERROR_SHIFT 4 // errors are kept in sixteenths, the Floyd-Steinberg weights
+#define BAYER_SIZE 8
+#define BAYER_SPREAD 32
+
+typedef enum DitherMode
+{
+	DITHER_NONE = 0,
+	DITHER_FLOYD_STEINBERG = 1,
+	DITHER_ORDERED = 2
+} DitherMode;
+
+void ditherFloydSteinberg(const ColorMap* map, const IplImage* image, unsigned char* indices, ThreadPool* pool);
+
+void ditherOrdered(const ColorMap* map, const IplImage* image, unsigned char* indices);
+
+#endif
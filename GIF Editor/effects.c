@@ -0,0 +1,511 @@
+/*********************************
+*		GIF EDITOR PROJECT       *
+*            Effects             *
+**********************************/
+
+#define _CRT_SECURE_NO_WARNINGS
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "effects.h"
+#include "hash.h"
+#include "tileExecutor.h"
+#include "pixelKernels.h"
+
+#define BGR_CHANNELS 3
+#define BLUE_CHANNEL 0
+#define GREEN_CHANNEL 1
+#define RED_CHANNEL 2
+#define COLOR_LEVELS 256
+#define MAX_COLOR 255
+#define MIDDLE_COLOR 128
+#define BLUE_WEIGHT 29 // luma weights in 256ths, they add up to 256 so a gray pixel keeps its level
+#define GREEN_WEIGHT 150
+#define RED_WEIGHT 77
+#define LUMA_SHIFT 8
+#define HALF_PIXEL 0.5
+#define EFFECT_BYTES_PER_PIXEL (BGR_CHANNELS + BGRA_PIXEL_CHANNELS)
+
+// The pixels of the source averaged into one column or row of the result
+typedef struct SourceSpan
+{
+	int	first;
+	int	count;
+} SourceSpan;
+
+// An effect chain reduced to one mapping of the pixels and one color transform.
+// A result pixel u lies at start + step * u in the source, step is negative along a flipped axis.
+// Colors go through channelTables, then are mixed to gray and go through grayTable when grayscale is set.
+typedef struct FusedEffects
+{
+	int		width;
+	int		height;
+	double		startX;
+	double		startY;
+	double		stepX;
+	double		stepY;
+	unsigned char	channelTables[BGR_CHANNELS][COLOR_LEVELS];
+	int		grayscale;
+	unsigned char	grayTable[COLOR_LEVELS];
+} FusedEffects;
+
+// One application of fused effects, shared by the tiles of the result
+typedef struct EffectsPass
+{
+	const FusedEffects*	fused;
+	const IplImage*		image;
+	IplImage*		result;
+	const SourceSpan*	columns;
+	const SourceSpan*	rows;
+} EffectsPass;
+
+static const char* effectNames[EFFECT_TYPE_COUNT] = { "grayscale", "brightness", "crop", "resize", "flip" };
+
+static void fuseEffects(const Effect* effects, int effectCount, int sourceWidth, int sourceHeight, FusedEffects* fused);
+static void fuseLevels(FusedEffects* fused, int brightness, int contrastPercent);
+static void cropAxis(double* start, double step, int* size, int offset, int length);
+static SourceSpan* mapAxis(double start, double step, int resultSize, int sourceSize);
+static int isAveraged(const SourceSpan* spans, int count);
+static void* allocateOrExit(size_t size);
+
+/*
+	Tile kernels that make the pixels of one tile of the result, one copy for each source layout, sampling and color mode.
+	Enlarging, cropping and flipping read one source pixel per result pixel, so those kernels never loop over a span,
+	and only the grayscale copies mix the channels.
+*/
+#define DEFINE_EFFECTS_KERNEL(NAME, CHANNELS, AVERAGING, GRAYSCALE) \
+static void NAME(void* context, const ImageTile* tile) \
+{ \
+	const EffectsPass* pass = (const EffectsPass*)context; \
+	const FusedEffects* fused = pass->fused; \
+	const IplImage* image = pass->image; \
+	const SourceSpan* columns = pass->columns; \
+	const SourceSpan* rows = pass->rows; \
+	const unsigned char* pixel = NULL; \
+	unsigned char* target = NULL; \
+	int x = 0, y = 0, spanX = 0, spanY = 0, area = 0, level = 0; \
+	unsigned int sums[BGR_CHANNELS]; \
+	unsigned char color[BGR_CHANNELS]; \
+ \
+	for (y = tile->top; y < tile->top + tile->height; y++) \
+	{ \
+		target = (unsigned char*)pass->result->imageData + (size_t)y * pass->result->widthStep + (size_t)tile->left * BGR_CHANNELS; \
+		for (x = tile->left; x < tile->left + tile->width; x++, target += BGR_CHANNELS) \
+		{ \
+			if (!(AVERAGING)) \
+			{ \
+				pixel = (const unsigned char*)image->imageData + (size_t)rows[y].first * image->widthStep \
+					+ (size_t)columns[x].first * (CHANNELS); \
+				color[BLUE_CHANNEL] = pixel[BLUE_CHANNEL]; \
+				color[GREEN_CHANNEL] = pixel[GREEN_CHANNEL]; \
+				color[RED_CHANNEL] = pixel[RED_CHANNEL]; \
+			} \
+			else \
+			{ \
+				sums[BLUE_CHANNEL] = sums[GREEN_CHANNEL] = sums[RED_CHANNEL] = 0; \
+				for (spanY = 0; spanY < rows[y].count; spanY++) \
+				{ \
+					pixel = (const unsigned char*)image->imageData + (size_t)(rows[y].first + spanY) * image->widthStep \
+						+ (size_t)columns[x].first * (CHANNELS); \
+					for (spanX = 0; spanX < columns[x].count; spanX++, pixel += (CHANNELS)) \
+					{ \
+						sums[BLUE_CHANNEL] += pixel[BLUE_CHANNEL]; \
+						sums[GREEN_CHANNEL] += pixel[GREEN_CHANNEL]; \
+						sums[RED_CHANNEL] += pixel[RED_CHANNEL]; \
+					} \
+				} \
+				area = rows[y].count * columns[x].count; \
+				color[BLUE_CHANNEL] = (unsigned char)((sums[BLUE_CHANNEL] + area / 2) / area); \
+				color[GREEN_CHANNEL] = (unsigned char)((sums[GREEN_CHANNEL] + area / 2) / area); \
+				color[RED_CHANNEL] = (unsigned char)((sums[RED_CHANNEL] + area / 2) / area); \
+			} \
+ \
+			color[BLUE_CHANNEL] = fused->channelTables[BLUE_CHANNEL][color[BLUE_CHANNEL]]; \
+			color[GREEN_CHANNEL] = fused->channelTables[GREEN_CHANNEL][color[GREEN_CHANNEL]]; \
+			color[RED_CHANNEL] = fused->channelTables[RED_CHANNEL][color[RED_CHANNEL]]; \
+			if (GRAYSCALE) \
+			{ \
+				level = fused->grayTable[(color[BLUE_CHANNEL] * BLUE_WEIGHT + color[GREEN_CHANNEL] * GREEN_WEIGHT \
+					+ color[RED_CHANNEL] * RED_WEIGHT) >> LUMA_SHIFT]; \
+				color[BLUE_CHANNEL] = color[GREEN_CHANNEL] = color[RED_CHANNEL] = (unsigned char)level; \
+			} \
+			target[BLUE_CHANNEL] = color[BLUE_CHANNEL]; \
+			target[GREEN_CHANNEL] = color[GREEN_CHANNEL]; \
+			target[RED_CHANNEL] = color[RED_CHANNEL]; \
+		} \
+	} \
+}
+
+DEFINE_EFFECTS_KERNEL(applyEffectsBgr, BGR_PIXEL_CHANNELS, FALSE, FALSE)
+DEFINE_EFFECTS_KERNEL(applyEffectsBgrGray, BGR_PIXEL_CHANNELS, FALSE, TRUE)
+DEFINE_EFFECTS_KERNEL(applyEffectsBgrAveraged, BGR_PIXEL_CHANNELS, TRUE, FALSE)
+DEFINE_EFFECTS_KERNEL(applyEffectsBgrAveragedGray, BGR_PIXEL_CHANNELS, TRUE, TRUE)
+DEFINE_EFFECTS_KERNEL(applyEffectsBgra, BGRA_PIXEL_CHANNELS, FALSE, FALSE)
+DEFINE_EFFECTS_KERNEL(applyEffectsBgraGray, BGRA_PIXEL_CHANNELS, FALSE, TRUE)
+DEFINE_EFFECTS_KERNEL(applyEffectsBgraAveraged, BGRA_PIXEL_CHANNELS, TRUE, FALSE)
+DEFINE_EFFECTS_KERNEL(applyEffectsBgraAveragedGray, BGRA_PIXEL_CHANNELS, TRUE, TRUE)
+
+// The kernels by source layout, then by whether any span is averaged, then by grayscale
+static const TileKernel effectsKernels[PIXEL_FORMAT_COUNT][2][2] =
+{
+	{ { applyEffectsBgr, applyEffectsBgrGray }, { applyEffectsBgrAveraged, applyEffectsBgrAveragedGray } },
+	{ { applyEffectsBgra, applyEffectsBgraGray }, { applyEffectsBgraAveraged, applyEffectsBgraAveragedGray } }
+};
+
+/*
+	Function that adds an effect to the end of a frame's effects.
+	Input: list - the FrameList the frame belongs to.
+		   frame - the frame.
+		   effect - the effect to add.
+	Output: EFFECT_ADDED, or EFFECT_NOT_ADDED if the effect is not valid or the frame has MAX_EFFECTS_PER_FRAME already.
+*/
+int addFrameEffect(FrameList* list, Frame* frame, const Effect* effect)
+{
+	Effect effects[MAX_EFFECTS_PER_FRAME];
+
+	if (!isEffectValid(effect) || frame->effectCount >= MAX_EFFECTS_PER_FRAME)
+	{
+		return EFFECT_NOT_ADDED;
+	}
+	if (frame->effectCount)
+	{
+		memcpy(effects, frame->effects, sizeof(Effect) * frame->effectCount);
+	}
+	effects[frame->effectCount] = *effect;
+	setFrameEffects(list, frame, effects, frame->effectCount + INC);
+	return EFFECT_ADDED;
+}
+
+/*
+	Function that checks that an effect's type is known and its values are in range.
+	Input: effect - the effect.
+	Output: TRUE if the effect can be applied, else FALSE.
+*/
+int isEffectValid(const Effect* effect)
+{
+	const int32_t* values = effect->values;
+
+	switch (effect->type)
+	{
+	case EFFECT_GRAYSCALE:
+		return TRUE;
+	case EFFECT_BRIGHTNESS_CONTRAST:
+		return values[0] >= MIN_BRIGHTNESS && values[0] <= MAX_BRIGHTNESS
+			&& values[1] >= MIN_CONTRAST_PERCENT && values[1] <= MAX_CONTRAST_PERCENT;
+	case EFFECT_CROP:
+		return values[0] >= 0 && values[0] < MAX_EFFECT_SIZE && values[1] >= 0 && values[1] < MAX_EFFECT_SIZE
+			&& values[2] > 0 && values[2] <= MAX_EFFECT_SIZE && values[3] > 0 && values[3] <= MAX_EFFECT_SIZE;
+	case EFFECT_RESIZE:
+		return values[0] > 0 && values[0] <= MAX_EFFECT_SIZE && values[1] > 0 && values[1] <= MAX_EFFECT_SIZE;
+	case EFFECT_FLIP:
+		return values[0] >= FLIP_HORIZONTAL && values[0] <= FLIP_BOTH;
+	default:
+		return FALSE;
+	}
+}
+
+/*
+	Function that gives the name of an effect's type.
+	Input: effect - the effect.
+	Output: the name, or "unknown".
+*/
+const char* getEffectName(const Effect* effect)
+{
+	return effect->type < EFFECT_TYPE_COUNT ? effectNames[effect->type] : "unknown";
+}
+
+/*
+	Function that prints a frame's effects in the order they are applied.
+	Input: frame - the frame.
+	Output: None.
+*/
+void printFrameEffects(const Frame* frame)
+{
+	const Effect* effect = NULL;
+	int i = 0;
+
+	printf("Effects of %s:%s\n", frame->name, frame->effectCount ? "" : " none");
+	for (i = 0; i < frame->effectCount; i++)
+	{
+		effect = &frame->effects[i];
+		printf("	[%d] %s", i + FIRST_NODE_INDEX, getEffectName(effect));
+		if (EFFECT_BRIGHTNESS_CONTRAST == effect->type)
+		{
+			printf(" %+d, contrast %d%%", effect->values[0], effect->values[1]);
+		}
+		else if (EFFECT_CROP == effect->type)
+		{
+			printf(" %dx%d from %d,%d", effect->values[2], effect->values[3], effect->values[0], effect->values[1]);
+		}
+		else if (EFFECT_RESIZE == effect->type)
+		{
+			printf(" to %dx%d", effect->values[0], effect->values[1]);
+		}
+		else if (EFFECT_FLIP == effect->type)
+		{
+			printf("%s%s", effect->values[0] & FLIP_HORIZONTAL ? " horizontally" : "", effect->values[0] & FLIP_VERTICAL ? " vertically" : "");
+		}
+		printf("\n");
+	}
+}
+
+/*
+	Function that hashes an effect chain, so images made with different effects are told apart.
+	Input: effects - the effects.
+		   effectCount - the number of effects.
+	Output: the 64-bit hash.
+*/
+uint64_t hashEffects(const Effect* effects, int effectCount)
+{
+	return hashBytes(effects, sizeof(Effect) * effectCount, FNV_OFFSET_BASIS_64);
+}
+
+/*
+	Function that checks if two frames apply the same effects.
+	Input: first, second - the frames.
+	Output: TRUE if their effects are the same, else FALSE.
+*/
+int haveSameEffects(const Frame* first, const Frame* second)
+{
+	return first->effectCount == second->effectCount
+		&& (!first->effectCount || !memcmp(first->effects, second->effects, sizeof(Effect) * first->effectCount));
+}
+
+/*
+	Function that makes the cache key of a frame's image with its effects applied, from the key of the image without them.
+	Input: key - the key of the image without effects.
+		   frame - the frame whose effects are applied.
+	Output: the new key, which the caller frees. A copy of key when the frame has no effects.
+*/
+char* createEffectsKey(const char* key, const Frame* frame)
+{
+	char* effectsKey = (char*)allocateOrExit(sizeof(char) * (strlen(key) + strlen(EFFECTS_KEY_FORMAT) + EFFECTS_KEY_HASH_DIGITS + INC));
+
+	if (frame->effectCount)
+	{
+		sprintf(effectsKey, EFFECTS_KEY_FORMAT, key, (unsigned long long)hashEffects(frame->effects, frame->effectCount));
+	}
+	else
+	{
+		strcpy(effectsKey, key);
+	}
+	return effectsKey;
+}
+
+/*
+	Function that applies an effect chain to an image in a single pass, without an image for each effect in between.
+	The geometric effects are reduced to one mapping from the result's pixels to the image's pixels and the color effects
+	to lookup tables, so each pixel of the result is read, transformed and written once.
+	Shrinking averages the pixels each result pixel covers and enlarging takes the nearest pixel.
+	The averaging is done before the color tables, so the colors match the chain's order exactly only without shrinking.
+	Large results are split into tiles run in parallel when called from a pool task, by a kernel picked once for the image.
+	The image may be a smaller copy of the source, like a preview: the effects still use the source's pixels
+	and the result is scaled down by the same ratio.
+	Input: effects - the effects in the order they are applied, invalid effects are skipped.
+		   effectCount - the number of effects.
+		   image - the 8-bit BGR or BGRA image to apply the effects to, the result is BGR.
+		   sourceWidth, sourceHeight - the size of the source image the effects' pixels refer to.
+	Output: the new image, which the caller releases.
+*/
+IplImage* applyEffects(const Effect* effects, int effectCount, const IplImage* image, int sourceWidth, int sourceHeight)
+{
+	FusedEffects fused;
+	EffectsPass pass;
+	IplImage* result = NULL;
+	SourceSpan* columns = NULL;
+	SourceSpan* rows = NULL;
+	double scaleX = (double)image->width / sourceWidth, scaleY = (double)image->height / sourceHeight;
+	int width = 0, height = 0;
+
+	fuseEffects(effects, effectCount, sourceWidth, sourceHeight, &fused);
+	width = (int)(fused.width * scaleX + HALF_PIXEL);
+	height = (int)(fused.height * scaleY + HALF_PIXEL);
+	width = width > 0 ? width : INC;
+	height = height > 0 ? height : INC;
+	columns = mapAxis(fused.startX * scaleX, fused.stepX * scaleX * fused.width / width, width, image->width);
+	rows = mapAxis(fused.startY * scaleY, fused.stepY * scaleY * fused.height / height, height, image->height);
+	result = cvCreateImage(cvSize(width, height), IPL_DEPTH_8U, BGR_CHANNELS);
+
+	pass.fused = &fused;
+	pass.image = image;
+	pass.result = result;
+	pass.columns = columns;
+	pass.rows = rows;
+	runTiled(width, height, EFFECT_BYTES_PER_PIXEL,
+		effectsKernels[getPixelFormat(image)][isAveraged(columns, width) || isAveraged(rows, height)][fused.grayscale ? TRUE : FALSE], &pass);
+
+	free(rows);
+	free(columns);
+	return result;
+}
+
+
+/*
+	Reduces an effect chain to the mapping and color tables of FusedEffects, working in the source's pixels.
+*/
+static void fuseEffects(const Effect* effects, int effectCount, int sourceWidth, int sourceHeight, FusedEffects* fused)
+{
+	const Effect* effect = NULL;
+	int channel = 0, level = 0, i = 0;
+
+	fused->width = sourceWidth;
+	fused->height = sourceHeight;
+	fused->startX = 0;
+	fused->startY = 0;
+	fused->stepX = 1;
+	fused->stepY = 1;
+	fused->grayscale = FALSE;
+	for (level = 0; level < COLOR_LEVELS; level++)
+	{
+		for (channel = 0; channel < BGR_CHANNELS; channel++)
+		{
+			fused->channelTables[channel][level] = (unsigned char)level;
+		}
+		fused->grayTable[level] = (unsigned char)level;
+	}
+
+	for (i = 0; i < effectCount; i++)
+	{
+		effect = &effects[i];
+		if (!isEffectValid(effect))
+		{
+			continue;
+		}
+		switch (effect->type)
+		{
+		case EFFECT_GRAYSCALE:
+			fused->grayscale = TRUE; // graying a gray image changes nothing, the weights add up to one
+			break;
+		case EFFECT_BRIGHTNESS_CONTRAST:
+			fuseLevels(fused, effect->values[0], effect->values[1]);
+			break;
+		case EFFECT_CROP:
+			cropAxis(&fused->startX, fused->stepX, &fused->width, effect->values[0], effect->values[2]);
+			cropAxis(&fused->startY, fused->stepY, &fused->height, effect->values[1], effect->values[3]);
+			break;
+		case EFFECT_RESIZE:
+			fused->stepX *= (double)fused->width / effect->values[0];
+			fused->stepY *= (double)fused->height / effect->values[1];
+			fused->width = effect->values[0];
+			fused->height = effect->values[1];
+			break;
+		case EFFECT_FLIP:
+			if (effect->values[0] & FLIP_HORIZONTAL)
+			{
+				fused->startX += fused->stepX * fused->width;
+				fused->stepX = -fused->stepX;
+			}
+			if (effect->values[0] & FLIP_VERTICAL)
+			{
+				fused->startY += fused->stepY * fused->height;
+				fused->stepY = -fused->stepY;
+			}
+			break;
+		}
+	}
+}
+
+/*
+	Composes a brightness and contrast change after the color tables built so far.
+	Before the chain turns gray each channel's table changes, after it only the gray table does.
+*/
+static void fuseLevels(FusedEffects* fused, int brightness, int contrastPercent)
+{
+	unsigned char levels[COLOR_LEVELS];
+	int level = 0, value = 0, channel = 0;
+
+	for (level = 0; level < COLOR_LEVELS; level++)
+	{
+		value = (level - MIDDLE_COLOR) * contrastPercent / NORMAL_CONTRAST_PERCENT + MIDDLE_COLOR + brightness;
+		levels[level] = (unsigned char)(value < 0 ? 0 : value > MAX_COLOR ? MAX_COLOR : value);
+	}
+	for (level = 0; level < COLOR_LEVELS; level++)
+	{
+		if (fused->grayscale)
+		{
+			fused->grayTable[level] = levels[fused->grayTable[level]];
+		}
+		else
+		{
+			for (channel = 0; channel < BGR_CHANNELS; channel++)
+			{
+				fused->channelTables[channel][level] = levels[fused->channelTables[channel][level]];
+			}
+		}
+	}
+}
+
+/*
+	Keeps a part of one axis, a crop reaching past the edge is cut at it.
+*/
+static void cropAxis(double* start, double step, int* size, int offset, int length)
+{
+	offset = offset < *size ? offset : *size - INC;
+	length = length < *size - offset ? length : *size - offset;
+	*start += step * offset;
+	*size = length;
+}
+
+/*
+	Finds the run of image pixels each result pixel of one axis covers.
+*/
+static SourceSpan* mapAxis(double start, double step, int resultSize, int sourceSize)
+{
+	SourceSpan* spans = (SourceSpan*)allocateOrExit(sizeof(SourceSpan) * resultSize);
+	double low = 0, high = 0;
+	int last = 0, i = 0;
+
+	for (i = 0; i < resultSize; i++)
+	{
+		low = start + step * i;
+		high = low + step;
+		if (high < low)
+		{
+			low = high;
+			high = start + step * i;
+		}
+		if (high - low <= 1)
+		{
+			spans[i].first = (int)floor((low + high) / 2);
+			spans[i].count = INC;
+		}
+		else
+		{
+			spans[i].first = (int)floor(low + HALF_PIXEL);
+			last = (int)floor(high + HALF_PIXEL);
+			spans[i].count = last > spans[i].first ? last - spans[i].first : INC;
+		}
+		spans[i].first = spans[i].first < 0 ? 0 : spans[i].first >= sourceSize ? sourceSize - INC : spans[i].first;
+		spans[i].count = spans[i].count < sourceSize - spans[i].first ? spans[i].count : sourceSize - spans[i].first;
+	}
+	return spans;
+}
+
+/*
+	Tells if any result pixel along an axis covers more than one source pixel.
+*/
+static int isAveraged(const SourceSpan* spans, int count)
+{
+	int i = 0;
+
+	for (i = 0; i < count; i++)
+	{
+		if (spans[i].count > INC)
+		{
+			return TRUE;
+		}
+	}
+	return FALSE;
+}
+
+static void* allocateOrExit(size_t size)
+{
+	void* memory = malloc(size);
+	if (!memory)
+	{
+		printf("Memory allocation failed!\n");
+		exit(MEMORY_ALLOCATION_ERROR_CODE);
+	}
+	return memory;
+}
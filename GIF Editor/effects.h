@@ -0,0 +1,64 @@
+/*********************************
+*		GIF EDITOR PROJECT       *
+*      Effects Declaration       *
+**********************************/
+
+#ifndef EFFECTSH
+#define EFFECTSH
+#define CV_IGNORE_DEBUG_BUILD_GUARD
+
+#include <stdint.h>
+#include <opencv2/core/core_c.h>
+#include "linkedList.h"
+
+#define MAX_EFFECTS_PER_FRAME 16
+#define MIN_BRIGHTNESS -255
+#define MAX_BRIGHTNESS 255
+#define MIN_CONTRAST_PERCENT 0
+#define MAX_CONTRAST_PERCENT 400
+#define NORMAL_CONTRAST_PERCENT 100
+#define MAX_EFFECT_SIZE 16384
+
+#define FLIP_HORIZONTAL 1
+#define FLIP_VERTICAL 2
+#define FLIP_BOTH (FLIP_HORIZONTAL | FLIP_VERTICAL)
+
+#define EFFECTS_KEY_FORMAT "%s|effects %016llx"
+#define EFFECTS_KEY_HASH_DIGITS 16
+
+#define EFFECT_ADDED 1
+#define EFFECT_NOT_ADDED 0
+
+// The effects and their values:
+// grayscale - none.
+// brightness and contrast - values[0] is added to every channel, values[1] stretches the channels around the middle, in percent.
+// crop - values are the left, top, width and height of the part that is kept, in the pixels the effect gets.
+// resize - values are the new width and height.
+// flip - values[0] is FLIP_HORIZONTAL, FLIP_VERTICAL or both.
+typedef enum EffectType
+{
+	EFFECT_GRAYSCALE = 0,
+	EFFECT_BRIGHTNESS_CONTRAST = 1,
+	EFFECT_CROP = 2,
+	EFFECT_RESIZE = 3,
+	EFFECT_FLIP = 4,
+	EFFECT_TYPE_COUNT = 5
+} EffectType;
+
+int addFrameEffect(FrameList* list, Frame* frame, const Effect* effect);
+
+int isEffectValid(const Effect* effect);
+
+const char* getEffectName(const Effect* effect);
+
+void printFrameEffects(const Frame* frame);
+
+uint64_t hashEffects(const Effect* effects, int effectCount);
+
+int haveSameEffects(const Frame* first, const Frame* second);
+
+char* createEffectsKey(const char* key, const Frame* frame);
+
+IplImage* applyEffects(const Effect* effects, int effectCount, const IplImage* image, int sourceWidth, int sourceHeight);
+
+#endif
@@ -0,0 +1,274 @@
+/*********************************
+*		GIF EDITOR PROJECT       *
+*           Frame Diff           *
+**********************************/
+
+#include "frameDiff.h"
+#include "platform.h"
+#include "pixelKernels.h"
+#ifdef PLATFORM_X86
+#include <emmintrin.h>
+#include <immintrin.h>
+#endif
+
+#define NO_DIFFERENCE -1
+#define SSE2_VECTOR_BYTES 16
+#define AVX2_VECTOR_BYTES 32
+#define SAME_BYTES_MASK 0xFFFF
+#define SAME_BYTES_MASK_AVX2 0xFFFFFFFFu
+
+typedef int (*FindDifferenceFunction)(const unsigned char* first, const unsigned char* second, int count);
+
+// The byte comparisons for the processor, chosen once per call
+typedef struct DiffKernels
+{
+	FindDifferenceFunction	findFirst;
+	FindDifferenceFunction	findLast;
+} DiffKernels;
+
+static void chooseDiffKernels(DiffKernels* kernels);
+static const unsigned char* rowOf(const IplImage* image, int y);
+static int findFirstDifferenceScalar(const unsigned char* first, const unsigned char* second, int count);
+static int findLastDifferenceScalar(const unsigned char* first, const unsigned char* second, int count);
+#ifdef PLATFORM_X86
+static int findFirstDifferenceSse2(const unsigned char* first, const unsigned char* second, int count);
+static int findLastDifferenceSse2(const unsigned char* first, const unsigned char* second, int count);
+static int findFirstDifferenceAvx2(const unsigned char* first, const unsigned char* second, int count);
+static int findLastDifferenceAvx2(const unsigned char* first, const unsigned char* second, int count);
+static int lowestBit(unsigned int bits);
+static int highestBit(unsigned int bits);
+#endif
+
+/*
+	Function that finds the smallest rectangle holding every pixel that differs between two frames.
+	Rows are compared from the top and from the bottom until a difference is found, then each row in between
+	is only searched from its ends up to the columns already known to have changed.
+	Input: previous - the frame shown before, 8 bit BGR or BGRA.
+		   current - the frame shown next, the same size and layout as previous.
+		   rect - where the rectangle is stored, left untouched if nothing changed.
+	Output: FRAME_CHANGED, or FRAME_UNCHANGED if the frames are identical.
+*/
+int findChangedRect(const IplImage* previous, const IplImage* current, ImageRect* rect)
+{
+	DiffKernels kernels;
+	int channels = current->nChannels;
+	int rowBytes = current->width * channels;
+	int top = 0, bottom = 0, leftByte = 0, rightByte = 0, found = 0;
+	int y = 0;
+
+	chooseDiffKernels(&kernels);
+	for (top = 0; top < current->height; top++)
+	{
+		found = kernels.findFirst(rowOf(previous, top), rowOf(current, top), rowBytes);
+		if (NO_DIFFERENCE != found)
+		{
+			break;
+		}
+	}
+	if (top == current->height)
+	{
+		return FRAME_UNCHANGED;
+	}
+	leftByte = found;
+	rightByte = kernels.findLast(rowOf(previous, top), rowOf(current, top), rowBytes);
+
+	for (bottom = current->height - 1; bottom > top; bottom--)
+	{
+		found = kernels.findFirst(rowOf(previous, bottom), rowOf(current, bottom), rowBytes);
+		if (NO_DIFFERENCE != found)
+		{
+			leftByte = found < leftByte ? found : leftByte;
+			found = kernels.findLast(rowOf(previous, bottom), rowOf(current, bottom), rowBytes);
+			rightByte = found > rightByte ? found : rightByte;
+			break;
+		}
+	}
+
+	for (y = top + 1; y < bottom; y++)
+	{
+		found = kernels.findFirst(rowOf(previous, y), rowOf(current, y), leftByte);
+		leftByte = NO_DIFFERENCE != found ? found : leftByte;
+		found = kernels.findLast(rowOf(previous, y) + rightByte + 1, rowOf(current, y) + rightByte + 1, rowBytes - rightByte - 1);
+		rightByte = NO_DIFFERENCE != found ? rightByte + 1 + found : rightByte;
+	}
+
+	rect->left = leftByte / channels;
+	rect->top = top;
+	rect->width = rightByte / channels - rect->left + 1;
+	rect->height = bottom - top + 1;
+	return FRAME_CHANGED;
+}
+
+/*
+	Function that marks which pixels of a rectangle are the same in both frames, so they can be left transparent.
+	Input: previous - the frame shown before, 8 bit BGR or BGRA.
+		   current - the frame shown next, the same size and layout as previous.
+		   rect - the rectangle to compare.
+		   mask - where rect width * height values are stored, row after row: PIXEL_UNCHANGED or PIXEL_CHANGED.
+	Output: None.
+*/
+void findUnchangedPixels(const IplImage* previous, const IplImage* current, const ImageRect* rect, unsigned char* mask)
+{
+	PixelKernels kernels;
+	int y = 0;
+
+	choosePixelKernels(getPixelFormat(current), &kernels);
+	for (y = 0; y < rect->height; y++)
+	{
+		kernels.compareRow(rowOf(previous, rect->top + y) + rect->left * kernels.channels, rowOf(current, rect->top + y) + rect->left * kernels.channels,
+			mask + (size_t)y * rect->width, rect->width);
+	}
+}
+
+static void chooseDiffKernels(DiffKernels* kernels)
+{
+#ifdef PLATFORM_X86
+	int features = getCpuFeatures();
+#endif
+
+	kernels->findFirst = findFirstDifferenceScalar;
+	kernels->findLast = findLastDifferenceScalar;
+#ifdef PLATFORM_X86
+	if (features & CPU_FEATURE_AVX2)
+	{
+		kernels->findFirst = findFirstDifferenceAvx2;
+		kernels->findLast = findLastDifferenceAvx2;
+	}
+	else if (features & CPU_FEATURE_SSE2)
+	{
+		kernels->findFirst = findFirstDifferenceSse2;
+		kernels->findLast = findLastDifferenceSse2;
+	}
+#endif
+}
+
+static const unsigned char* rowOf(const IplImage* image, int y)
+{
+	return (const unsigned char*)image->imageData + (size_t)y * image->widthStep;
+}
+
+/*
+	Gives the offset of the first byte that differs, or NO_DIFFERENCE.
+*/
+static int findFirstDifferenceScalar(const unsigned char* first, const unsigned char* second, int count)
+{
+	int i = 0;
+
+	for (i = 0; i < count; i++)
+	{
+		if (first[i] != second[i])
+		{
+			return i;
+		}
+	}
+	return NO_DIFFERENCE;
+}
+
+/*
+	Gives the offset of the last byte that differs, or NO_DIFFERENCE.
+*/
+static int findLastDifferenceScalar(const unsigned char* first, const unsigned char* second, int count)
+{
+	int i = 0;
+
+	for (i = count - 1; i >= 0; i--)
+	{
+		if (first[i] != second[i])
+		{
+			return i;
+		}
+	}
+	return NO_DIFFERENCE;
+}
+
+#ifdef PLATFORM_X86
+TARGET_SSE2 static int findFirstDifferenceSse2(const unsigned char* first, const unsigned char* second, int count)
+{
+	int same = 0, i = 0;
+
+	for (i = 0; i + SSE2_VECTOR_BYTES <= count; i += SSE2_VECTOR_BYTES)
+	{
+		same = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(first + i)), _mm_loadu_si128((const __m128i*)(second + i))));
+		if (SAME_BYTES_MASK != same)
+		{
+			return i + lowestBit(~same & SAME_BYTES_MASK);
+		}
+	}
+	same = findFirstDifferenceScalar(first + i, second + i, count - i);
+	return NO_DIFFERENCE == same ? NO_DIFFERENCE : i + same;
+}
+
+TARGET_SSE2 static int findLastDifferenceSse2(const unsigned char* first, const unsigned char* second, int count)
+{
+	int same = 0, i = count;
+
+	for (; i >= SSE2_VECTOR_BYTES; i -= SSE2_VECTOR_BYTES)
+	{
+		same = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(first + i - SSE2_VECTOR_BYTES)),
+			_mm_loadu_si128((const __m128i*)(second + i - SSE2_VECTOR_BYTES))));
+		if (SAME_BYTES_MASK != same)
+		{
+			return i - SSE2_VECTOR_BYTES + highestBit(~same & SAME_BYTES_MASK);
+		}
+	}
+	return findLastDifferenceScalar(first, second, i);
+}
+
+TARGET_AVX2 static int findFirstDifferenceAvx2(const unsigned char* first, const unsigned char* second, int count)
+{
+	unsigned int same = 0;
+	int i = 0, found = 0;
+
+	for (i = 0; i + AVX2_VECTOR_BYTES <= count; i += AVX2_VECTOR_BYTES)
+	{
+		same = (unsigned int)_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)(first + i)),
+			_mm256_loadu_si256((const __m256i*)(second + i))));
+		if (SAME_BYTES_MASK_AVX2 != same)
+		{
+			return i + lowestBit(~same);
+		}
+	}
+	found = findFirstDifferenceSse2(first + i, second + i, count - i);
+	return NO_DIFFERENCE == found ? NO_DIFFERENCE : i + found;
+}
+
+TARGET_AVX2 static int findLastDifferenceAvx2(const unsigned char* first, const unsigned char* second, int count)
+{
+	unsigned int same = 0;
+	int i = count;
+
+	for (; i >= AVX2_VECTOR_BYTES; i -= AVX2_VECTOR_BYTES)
+	{
+		same = (unsigned int)_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)(first + i - AVX2_VECTOR_BYTES)),
+			_mm256_loadu_si256((const __m256i*)(second + i - AVX2_VECTOR_BYTES))));
+		if (SAME_BYTES_MASK_AVX2 != same)
+		{
+			return i - AVX2_VECTOR_BYTES + highestBit(~same);
+		}
+	}
+	return findLastDifferenceSse2(first, second, i);
+}
+
+static int lowestBit(unsigned int bits)
+{
+	int position = 0;
+
+	while (!(bits & 1u))
+	{
+		bits >>= 1;
+		position++;
+	}
+	return position;
+}
+
+static int highestBit(unsigned int bits)
+{
+	int position = 0;
+
+	while (bits >>= 1)
+	{
+		position++;
+	}
+	return position;
+}
+#endif
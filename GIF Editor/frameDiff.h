@@ -0,0 +1,38 @@
+/*********************************
+*		GIF EDITOR PROJECT       *
+*     Frame Diff Declaration     *
+**********************************/
+
+#ifndef FRAMEDIFFH
+#define FRAMEDIFFH
+#define CV_IGNORE_DEBUG_BUILD_GUARD
+
+#include <opencv2/core/core_c.h>
+
+#define FRAME_CHANGED 1
+#define FRAME_UNCHANGED 0
+
+#define PIXEL_CHANGED 0
+#define PIXEL_UNCHANGED 1
+
+typedef enum FrameDiffMode
+{
+	FRAME_DIFF_OFF = 0,
+	FRAME_DIFF_RECTANGLE = 1,
+	FRAME_DIFF_TRANSPARENT = 2
+} FrameDiffMode;
+
+// Rectangle of an image, in pixels
+typedef struct ImageRect
+{
+	int	left;
+	int	top;
+	int	width;
+	int	height;
+} ImageRect;
+
+int findChangedRect(const IplImage* previous, const IplImage* current, ImageRect* rect);
+
+void findUnchangedPixels(const IplImage* previous, const IplImage* current, const ImageRect* rect, unsigned char* mask);
+
+#endif
@@ -0,0 +1,162 @@
+/*********************************
+*		GIF EDITOR PROJECT       *
+*        Frame Name Index        *
+**********************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "frameIndex.h"
+#include "linkedList.h"
+#include "hash.h"
+
+static FrameIndexSlot* allocateSlots(int capacity);
+static int findSlot(const FrameIndex* index, const char* name, unsigned int hash);
+static void growFrameIndex(FrameIndex* index);
+
+/*
+	Function that initializes an empty frame name index.
+	Input: index - the index to initialize.
+	Output: None.
+*/
+void initFrameIndex(FrameIndex* index)
+{
+	index->capacity = FRAME_INDEX_INITIAL_CAPACITY;
+	index->slots = allocateSlots(index->capacity);
+	index->count = 0;
+}
+
+/*
+	Function that frees the memory of a frame name index. The indexed frames are not freed.
+	Input: index - the index to free.
+	Output: None.
+*/
+void freeFrameIndex(FrameIndex* index)
+{
+	free(index->slots);
+	index->slots = NULL;
+	index->capacity = 0;
+	index->count = 0;
+}
+
+/*
+	Function that adds a frame to the index under its name.
+	If the name is already indexed the earlier frame keeps it, like a scan from the start would find.
+	Input: index - the frame name index.
+		   frame - the frame to add.
+	Output: None.
+*/
+void addToFrameIndex(FrameIndex* index, Frame* frame)
+{
+	unsigned int hash = 0;
+	int slot = 0;
+
+	if ((index->count + INC) * FRAME_INDEX_LOAD_DENOMINATOR > index->capacity * FRAME_INDEX_LOAD_NUMERATOR)
+	{
+		growFrameIndex(index);
+	}
+	hash = hashString(frame->name);
+	slot = findSlot(index, frame->name, hash);
+	if (!index->slots[slot].frame)
+	{
+		index->slots[slot].hash = hash;
+		index->slots[slot].frame = frame;
+		index->count++;
+	}
+}
+
+/*
+	Function that removes a frame from the index, if it is the frame indexed under its name.
+	Input: index - the frame name index.
+		   frame - the frame to remove.
+	Output: None.
+*/
+void removeFromFrameIndex(FrameIndex* index, Frame* frame)
+{
+	int mask = index->capacity - 1;
+	int hole = findSlot(index, frame->name, hashString(frame->name));
+	int next = hole;
+	int home = 0;
+
+	if (index->slots[hole].frame != frame)
+	{
+		return;
+	}
+
+	// backward shift deletion: pull later entries of the probe chain into the hole
+	next = (hole + INC) & mask;
+	while (index->slots[next].frame)
+	{
+		home = index->slots[next].hash & mask;
+		if (((next - home) & mask) >= ((next - hole) & mask))
+		{
+			index->slots[hole] = index->slots[next];
+			hole = next;
+		}
+		next = (next + INC) & mask;
+	}
+	index->slots[hole].frame = NULL;
+	index->count--;
+}
+
+/*
+	Function that finds a frame by its name.
+	Input: index - the frame name index.
+		   name - the name of the frame.
+	Output: the frame, or NULL if there is no frame with that name.
+*/
+Frame* findInFrameIndex(const FrameIndex* index, const char* name)
+{
+	return index->slots[findSlot(index, name, hashString(name))].frame;
+}
+
+static FrameIndexSlot* allocateSlots(int capacity)
+{
+	FrameIndexSlot* slots = (FrameIndexSlot*)calloc(capacity, sizeof(FrameIndexSlot));
+	if (!slots)
+	{
+		printf("Memory allocation failed!\n");
+		exit(MEMORY_ALLOCATION_ERROR_CODE);
+	}
+	return slots;
+}
+
+/*
+	Linear probing: returns the slot holding the name, or the empty slot where it would go.
+*/
+static int findSlot(const FrameIndex* index, const char* name, unsigned int hash)
+{
+	int mask = index->capacity - 1;
+	int slot = hash & mask;
+
+	while (index->slots[slot].frame &&
+		(index->slots[slot].hash != hash || EQUAL_STRINGS_VALUE != strcmp(index->slots[slot].frame->name, name)))
+	{
+		slot = (slot + INC) & mask;
+	}
+	return slot;
+}
+
+static void growFrameIndex(FrameIndex* index)
+{
+	FrameIndexSlot* oldSlots = index->slots;
+	int oldCapacity = index->capacity;
+	int mask = 0, slot = 0, i = 0;
+
+	index->capacity *= 2;
+	index->slots = allocateSlots(index->capacity);
+	mask = index->capacity - 1;
+	for (i = 0; i < oldCapacity; i++)
+	{
+		if (oldSlots[i].frame)
+		{
+			slot = oldSlots[i].hash & mask;
+			while (index->slots[slot].frame)
+			{
+				slot = (slot + INC) & mask;
+			}
+			index->slots[slot] = oldSlots[i];
+		}
+	}
+	free(oldSlots);
+}
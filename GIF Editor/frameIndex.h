@@ -0,0 +1,40 @@
+/*********************************
+*		GIF EDITOR PROJECT       *
+*  Frame Name Index Declaration  *
+**********************************/
+
+#ifndef FRAMEINDEXH
+#define FRAMEINDEXH
+
+#define FRAME_INDEX_INITIAL_CAPACITY 16
+#define FRAME_INDEX_LOAD_NUMERATOR 3
+#define FRAME_INDEX_LOAD_DENOMINATOR 4
+
+struct Frame;
+
+// Open addressing slot, an empty slot has a NULL frame
+typedef struct FrameIndexSlot
+{
+	unsigned int	hash;
+	struct Frame*	frame;
+} FrameIndexSlot;
+
+// Hash index from frame name to the frame
+typedef struct FrameIndex
+{
+	FrameIndexSlot*	slots;
+	int		capacity;
+	int		count;
+} FrameIndex;
+
+void initFrameIndex(FrameIndex* index);
+
+void freeFrameIndex(FrameIndex* index);
+
+void addToFrameIndex(FrameIndex* index, struct Frame* frame);
+
+void removeFromFrameIndex(FrameIndex* index, struct Frame* frame);
+
+struct Frame* findInFrameIndex(const FrameIndex* index, const char* name);
+
+#endif
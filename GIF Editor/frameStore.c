@@ -0,0 +1,392 @@
+/*********************************
+*		GIF EDITOR PROJECT       *
+*          Frame Store           *
+**********************************/
+
+#define _CRT_SECURE_NO_WARNINGS
+#define CV_IGNORE_DEBUG_BUILD_GUARD
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <opencv2/imgcodecs/imgcodecs_c.h>
+#include "frameStore.h"
+#include "hash.h"
+
+#define ONE_ELEMENT 1
+#define WRITE_BINARY_MODE "wb"
+#define PATH_SEPARATOR "/"
+#define STORE_NAME_FORMAT "%016llx"
+#define STORE_NAME_DIGITS 16
+#define TEMPORARY_NUMBER_FORMAT ".%lu.%lu"
+#define MAX_NUMBER_DIGITS 21
+#define MIN_LISTED_ENTRIES 64
+#define BYTES_IN_MEGABYTE (1024.0 * 1024.0)
+
+static const unsigned char headerPadding[FRAME_STORE_DATA_OFFSET] = { 0 };
+
+// A stored frame found while listing the store
+typedef struct StoredEntry
+{
+	char*			name;
+	unsigned long long	size;
+	unsigned long long	modifiedTime;
+} StoredEntry;
+
+// The stored frames found in the store's folder
+typedef struct StoreListing
+{
+	StoredEntry*		entries;
+	int			count;
+	int			capacity;
+	unsigned long long	totalBytes;
+} StoreListing;
+
+static IplImage* mapStoredFrame(const char* path, uint64_t sourceSize, uint64_t sourceHash, uint64_t sourceCheck, MappedFile* mapping);
+static void storeFrame(FrameStore* store, const char* path, uint64_t sourceSize, uint64_t sourceHash, uint64_t sourceCheck,
+	const IplImage* image);
+static void evictToBudget(FrameStore* store);
+static void listStore(const FrameStore* store, StoreListing* listing);
+static void addListedEntry(void* context, const char* name, const FileStatus* status);
+static void freeListing(StoreListing* listing);
+static int compareByUseTime(const void* first, const void* second);
+static char* createStorePath(const FrameStore* store, const char* name);
+static void* allocateOrExit(size_t size);
+
+/*
+	Function that opens the folder of stored frames, creating it if needed, and measures what it holds.
+	Input: directory - the folder the frames are kept in.
+		   budgetBytes - the most disk space the stored frames may take, the least recently used are removed past it.
+	Output: pointer to the new FrameStore, or NULL if the folder could not be created.
+*/
+FrameStore* openFrameStore(const char* directory, unsigned long long budgetBytes)
+{
+	FrameStore* store = NULL;
+	StoreListing listing;
+
+	if (DIRECTORY_NOT_READY == createDirectory(directory))
+	{
+		printf("Could not create the frame store folder %s\n", directory);
+		return NULL;
+	}
+	store = (FrameStore*)allocateOrExit(sizeof(FrameStore));
+	store->directory = (char*)allocateOrExit(sizeof(char) * (strlen(directory) + INC));
+	strcpy(store->directory, directory);
+	store->budgetBytes = budgetBytes;
+	listStore(store, &listing);
+	store->usedBytes = listing.totalBytes;
+	store->entryCount = listing.count;
+	freeListing(&listing);
+	store->temporaryCount = 0;
+	store->hits = 0;
+	store->misses = 0;
+	store->stored = 0;
+	store->evictions = 0;
+	initMutex(&store->lock);
+	return store;
+}
+
+/*
+	Function that frees a FrameStore, the stored frames stay on the disk.
+	Images mapped from the store must be released first.
+	Input: store - pointer to the FrameStore, set to NULL.
+	Output: None.
+*/
+void closeFrameStore(FrameStore** store)
+{
+	if (!*store)
+	{
+		return;
+	}
+	destroyMutex(&(*store)->lock);
+	free((*store)->directory);
+	free(*store);
+	*store = NULL;
+}
+
+/*
+	Function that returns the decoded image of a frame, mapped from the store when its source was decoded before.
+	The source bytes are hashed to find the stored frame, so a renamed or copied image is still found
+	and an edited one is not. A second, unrelated hash of them must also match before a stored frame is used. Images that are not stored yet are decoded and added to the store.
+	Input: store - the frame store.
+		   frame - the frame whose image is needed.
+		   mapping - set to the mapped stored frame when the image points into it, else its data is NULL.
+				 The image is then released with cvReleaseImageHeader and the mapping with unmapFile.
+	Output: the image, or NULL if the frame's image could not be read.
+*/
+IplImage* loadFrameThroughStore(FrameStore* store, const Frame* frame, MappedFile* mapping)
+{
+	MappedFile source;
+	CvMat encoded;
+	IplImage* image = NULL;
+	const unsigned char* bytes = frame->imageData;
+	size_t size = frame->imageSize;
+	uint64_t hash = 0, check = 0;
+	char* path = NULL;
+	char name[STORE_NAME_DIGITS + sizeof(FRAME_STORE_EXTENSION)];
+
+	mapping->data = NULL;
+	source.data = NULL;
+	if (!bytes)
+	{
+		if (FILE_NOT_MAPPED == mapFile(frame->path, &source))
+		{
+			return NULL;
+		}
+		bytes = source.data;
+		size = source.size;
+	}
+
+	hash = hashBytes(bytes, size, FNV_OFFSET_BASIS_64);
+	check = hashBytesAlternate(bytes, size);
+	sprintf(name, STORE_NAME_FORMAT FRAME_STORE_EXTENSION, (unsigned long long)hash);
+	path = createStorePath(store, name);
+	image = mapStoredFrame(path, size, hash, check, mapping);
+	if (image)
+	{
+		touchFile(path);
+		lockMutex(&store->lock);
+		store->hits++;
+		unlockMutex(&store->lock);
+	}
+	else
+	{
+		encoded = cvMat(1, (int)size, CV_8UC1, (void*)bytes);
+		image = cvDecodeImage(&encoded, CV_LOAD_IMAGE_COLOR);
+		if (image)
+		{
+			storeFrame(store, path, size, hash, check, image);
+		}
+	}
+
+	unmapFile(&source);
+	free(path);
+	return image;
+}
+
+/*
+	Function that prints how many images the store saved from decoding and how full it is.
+	Input: store - the frame store.
+	Output: None.
+*/
+void printFrameStoreStats(FrameStore* store)
+{
+	unsigned long lookups = 0;
+
+	lockMutex(&store->lock);
+	lookups = store->hits + store->misses;
+	printf("Frame store: %lu mapped, %lu decoded (%.1f%% hit rate), %lu stored, %lu evictions\n",
+		store->hits, store->misses, lookups ? 100.0 * store->hits / lookups : 0.0, store->stored, store->evictions);
+	printf("             %d frames, %.1f MB used of %.1f MB budget in %s\n", store->entryCount,
+		store->usedBytes / BYTES_IN_MEGABYTE, store->budgetBytes / BYTES_IN_MEGABYTE, store->directory);
+	unlockMutex(&store->lock);
+}
+
+/*
+	Maps a stored frame and wraps its pixels in an image header, or returns NULL if it is missing or does not match.
+*/
+static IplImage* mapStoredFrame(const char* path, uint64_t sourceSize, uint64_t sourceHash, uint64_t sourceCheck, MappedFile* mapping)
+{
+	const FrameStoreHeader* header = NULL;
+	IplImage* image = NULL;
+
+	if (FILE_NOT_MAPPED == mapFile(path, mapping))
+	{
+		return NULL;
+	}
+	header = (const FrameStoreHeader*)mapping->data;
+	if (mapping->size < sizeof(FrameStoreHeader) || FRAME_STORE_MAGIC != header->magic || FRAME_STORE_VERSION != header->version
+		|| sourceSize != header->sourceSize || sourceHash != header->sourceHash || sourceCheck != header->sourceCheck
+		|| !header->width || !header->height || !header->channels
+		|| header->widthStep < (unsigned long long)header->width * header->channels
+		|| header->dataOffset < sizeof(FrameStoreHeader) || header->dataOffset % FRAME_STORE_DATA_OFFSET
+		|| mapping->size != header->dataOffset + (unsigned long long)header->widthStep * header->height)
+	{
+		unmapFile(mapping);
+		return NULL;
+	}
+	image = cvCreateImageHeader(cvSize((int)header->width, (int)header->height), IPL_DEPTH_8U, (int)header->channels);
+	cvSetData(image, (void*)(mapping->data + header->dataOffset), (int)header->widthStep);
+	return image;
+}
+
+/*
+	Writes a decoded image to the store through a temporary file of its own, so a frame that is being written is never mapped.
+	The temporary name holds the process id and a count, so neither another thread nor another run sharing the folder uses it.
+	A frame that can not be stored is only decoded again next time.
+*/
+static void storeFrame(FrameStore* store, const char* path, uint64_t sourceSize, uint64_t sourceHash, uint64_t sourceCheck,
+	const IplImage* image)
+{
+	FrameStoreHeader header;
+	FILE* file = NULL;
+	char* temporaryPath = (char*)allocateOrExit(sizeof(char)
+		* (strlen(path) + MAX_NUMBER_DIGITS * 2 + strlen(FRAME_STORE_TEMPORARY_EXTENSION) + INC));
+	unsigned long temporaryNumber = 0;
+	int written = TRUE;
+
+	lockMutex(&store->lock);
+	store->misses++;
+	temporaryNumber = store->temporaryCount++;
+	unlockMutex(&store->lock);
+
+	sprintf(temporaryPath, "%s" TEMPORARY_NUMBER_FORMAT FRAME_STORE_TEMPORARY_EXTENSION, path, getProcessId(), temporaryNumber);
+	file = fopen(temporaryPath, WRITE_BINARY_MODE);
+	if (!file)
+	{
+		free(temporaryPath);
+		return;
+	}
+
+	header.magic = FRAME_STORE_MAGIC;
+	header.version = FRAME_STORE_VERSION;
+	header.width = (uint32_t)image->width;
+	header.height = (uint32_t)image->height;
+	header.channels = (uint32_t)image->nChannels;
+	header.widthStep = (uint32_t)image->widthStep;
+	header.sourceSize = sourceSize;
+	header.sourceHash = sourceHash;
+	header.sourceCheck = sourceCheck;
+	header.dataOffset = FRAME_STORE_DATA_OFFSET;
+	fwrite(&header, sizeof(FrameStoreHeader), ONE_ELEMENT, file);
+	fwrite(headerPadding, sizeof(unsigned char), FRAME_STORE_DATA_OFFSET - sizeof(FrameStoreHeader), file);
+	fwrite(image->imageData, sizeof(char), (size_t)image->widthStep * image->height, file);
+	if (ferror(file))
+	{
+		written = FALSE;
+	}
+	if (fclose(file))
+	{
+		written = FALSE;
+	}
+	if (!written || FILE_NOT_REPLACED == replaceFile(temporaryPath, path))
+	{
+		remove(temporaryPath);
+		free(temporaryPath);
+		return;
+	}
+	free(temporaryPath);
+
+	lockMutex(&store->lock);
+	store->usedBytes += FRAME_STORE_DATA_OFFSET + (unsigned long long)image->widthStep * image->height;
+	store->entryCount++;
+	store->stored++;
+	evictToBudget(store);
+	unlockMutex(&store->lock);
+}
+
+/*
+	Removes the least recently used frames until the store fits its budget, the store's lock is held.
+	The folder is listed again first, since other sessions may share it.
+*/
+static void evictToBudget(FrameStore* store)
+{
+	StoreListing listing;
+	char* path = NULL;
+	int i = 0;
+
+	if (store->usedBytes <= store->budgetBytes)
+	{
+		return;
+	}
+	listStore(store, &listing);
+	store->usedBytes = listing.totalBytes;
+	store->entryCount = listing.count;
+	qsort(listing.entries, listing.count, sizeof(StoredEntry), compareByUseTime);
+	for (i = 0; i < listing.count && store->usedBytes > store->budgetBytes; i++)
+	{
+		path = createStorePath(store, listing.entries[i].name);
+		if (!remove(path)) // a frame that is mapped can not be removed on some systems, it stays until next time
+		{
+			store->usedBytes -= listing.entries[i].size;
+			store->entryCount--;
+			store->evictions++;
+		}
+		free(path);
+	}
+	freeListing(&listing);
+}
+
+static void listStore(const FrameStore* store, StoreListing* listing)
+{
+	listing->entries = NULL;
+	listing->count = 0;
+	listing->capacity = 0;
+	listing->totalBytes = 0;
+	listDirectory(store->directory, addListedEntry, listing);
+}
+
+/*
+	Directory listing callback: keeps the files that are stored frames.
+*/
+static void addListedEntry(void* context, const char* name, const FileStatus* status)
+{
+	StoreListing* listing = (StoreListing*)context;
+	size_t nameLength = strlen(name), extensionLength = strlen(FRAME_STORE_EXTENSION);
+	StoredEntry* entry = NULL;
+
+	if (nameLength <= extensionLength || strcmp(name + nameLength - extensionLength, FRAME_STORE_EXTENSION))
+	{
+		return;
+	}
+	if (listing->count == listing->capacity)
+	{
+		listing->capacity = listing->capacity ? listing->capacity * 2 : MIN_LISTED_ENTRIES;
+		listing->entries = (StoredEntry*)realloc(listing->entries, sizeof(StoredEntry) * listing->capacity);
+		if (!listing->entries)
+		{
+			printf("Memory allocation failed!\n");
+			exit(MEMORY_ALLOCATION_ERROR_CODE);
+		}
+	}
+	entry = &listing->entries[listing->count++];
+	entry->name = (char*)allocateOrExit(sizeof(char) * (nameLength + INC));
+	strcpy(entry->name, name);
+	entry->size = status->size;
+	entry->modifiedTime = status->modifiedTime;
+	listing->totalBytes += status->size;
+}
+
+static void freeListing(StoreListing* listing)
+{
+	int i = 0;
+
+	for (i = 0; i < listing->count; i++)
+	{
+		free(listing->entries[i].name);
+	}
+	free(listing->entries);
+	listing->entries = NULL;
+	listing->count = 0;
+}
+
+/*
+	Orders stored frames from the least recently used, a frame's modification time is set on every use.
+*/
+static int compareByUseTime(const void* first, const void* second)
+{
+	const StoredEntry* firstEntry = (const StoredEntry*)first;
+	const StoredEntry* secondEntry = (const StoredEntry*)second;
+
+	return firstEntry->modifiedTime < secondEntry->modifiedTime ? -1 : firstEntry->modifiedTime > secondEntry->modifiedTime;
+}
+
+static char* createStorePath(const FrameStore* store, const char* name)
+{
+	char* path = (char*)allocateOrExit(sizeof(char) * (strlen(store->directory) + strlen(PATH_SEPARATOR) + strlen(name) + INC));
+
+	strcpy(path, store->directory);
+	strcat(path, PATH_SEPARATOR);
+	strcat(path, name);
+	return path;
+}
+
+static void* allocateOrExit(size_t size)
+{
+	void* memory = malloc(size);
+	if (!memory)
+	{
+		printf("Memory allocation failed!\n");
+		exit(MEMORY_ALLOCATION_ERROR_CODE);
+	}
+	return memory;
+}
@@ -0,0 +1,64 @@
+/*********************************
+*		GIF EDITOR PROJECT       *
+*    Frame Store Declaration     *
+**********************************/
+
+#ifndef FRAMESTOREH
+#define FRAMESTOREH
+#define CV_IGNORE_DEBUG_BUILD_GUARD
+
+#include <stdint.h>
+#include <opencv2/core/core_c.h>
+#include "linkedList.h"
+#include "platform.h"
+
+#define FRAME_STORE_DIRECTORY "GIF Editor Frames"
+#define FRAME_STORE_BUDGET_BYTES (2048ull * 1024ull * 1024ull)
+#define FRAME_STORE_EXTENSION ".frame"
+#define FRAME_STORE_TEMPORARY_EXTENSION ".tmp"
+#define FRAME_STORE_MAGIC 0x4D524647u // "GFRM" as stored in the file
+#define FRAME_STORE_VERSION 2
+#define FRAME_STORE_DATA_OFFSET 64 // the pixels start on a cache line of the mapping
+
+// Start of a stored frame, followed by the rows of the decoded image exactly as they are in memory.
+// The file is named after a hash of the encoded source bytes, which are also checked by their size
+// and by sourceCheck, a second hash of them unrelated to the first, so one hash collision can not return another image.
+typedef struct FrameStoreHeader
+{
+	uint32_t	magic;
+	uint32_t	version;
+	uint32_t	width;
+	uint32_t	height;
+	uint32_t	channels;
+	uint32_t	widthStep;
+	uint64_t	sourceSize;
+	uint64_t	sourceHash;
+	uint64_t	sourceCheck;
+	uint64_t	dataOffset;
+} FrameStoreHeader;
+
+// Folder of decoded frames kept between sessions, addressed by the content of their source images.
+// Images read from it are mapped into memory instead of decoded, the least recently used are removed over budget.
+typedef struct FrameStore
+{
+	char*			directory;
+	unsigned long long	budgetBytes;
+	unsigned long long	usedBytes;
+	int			entryCount;
+	unsigned long		temporaryCount;
+	unsigned long		hits;
+	unsigned long		misses;
+	unsigned long		stored;
+	unsigned long		evictions;
+	Mutex			lock;
+} FrameStore;
+
+FrameStore* openFrameStore(const char* directory, unsigned long long budgetBytes);
+
+void closeFrameStore(FrameStore** store);
+
+IplImage* loadFrameThroughStore(FrameStore* store, const Frame* frame, MappedFile* mapping);
+
+void printFrameStoreStats(FrameStore* store);
+
+#endif
@@ -0,0 +1,745 @@
+/*********************************
+*		GIF EDITOR PROJECT       *
+*           GIF Export           *
+**********************************/
+
+#define _CRT_SECURE_NO_WARNINGS
+#define CV_IGNORE_DEBUG_BUILD_GUARD
+#include <stdio.h>
+#include <stdlib.h>
+#include <opencv2/imgproc/imgproc_c.h>
+#include "gifExport.h"
+#include "tileExecutor.h"
+#include "canvas.h"
+
+#define BGR_CHANNELS 3
+#define BLUE_CHANNEL 0
+#define GREEN_CHANNEL 1
+#define RED_CHANNEL 2
+#define IMAGE_ROW_ALIGNMENT 4
+#define UNIFORM_BYTES_PER_PIXEL (BGR_CHANNELS + 1)
+
+// State shared by all the encoding jobs of one export
+typedef struct ExportContext
+{
+	ImageCache*		cache;
+	ThreadPool*		pool;
+	PaletteMode		paletteMode;
+	DitherMode		ditherMode;
+	FrameDiffMode		frameDiffMode;
+	const GifPalette*	palette;
+	const ColorMap*		colorMap;
+	const Canvas*		canvas;
+	int			width;
+	int			height;
+	int			transparentIndex;
+	int			firstFrame;
+	unsigned int		firstFrameSkipped;
+	Mutex			lock;
+	Condition		jobFinished;
+} ExportContext;
+
+// One frame being decoded, quantized and compressed on a pool worker
+typedef struct ExportJob
+{
+	ExportContext*	context;
+	const Frame*	frame;
+	const Frame*	previousFrame;
+	unsigned int	duration;
+	int		imageNumber;
+	unsigned char*	indices;
+	unsigned char*	mask;
+	IplImage*	screenImage;
+	IplImage*	previousScreenImage;
+	ColorHistogram*	histogram;
+	ColorMap*	localMap;
+	ByteBuffer	encoded;
+	ExportResult	result;
+	int		finished;
+} ExportJob;
+
+// An image being mapped to the fixed palette, shared by its tiles
+typedef struct UniformMapping
+{
+	const IplImage*	image;
+	unsigned char*	indices;
+} UniformMapping;
+
+// A range of frames whose colors are counted on a pool worker, for the global palette
+typedef struct HistogramJob
+{
+	ExportContext*	context;
+	const Frame**	frames;
+	int		frameCount;
+	ColorHistogram	histogram;
+	ExportResult	result;
+	int		finished;
+} HistogramJob;
+
+static void startExportJob(ThreadPool* pool, ExportJob* job, FrameList* list, int index);
+static void encodeFrame(void* argument);
+static void waitUntilFinished(ThreadPool* pool, ExportContext* context, const int* finished);
+static const IplImage* fitToScreen(const ExportContext* context, const IplImage* image, IplImage** screenImage);
+static void findFrameRect(const ExportContext* context, const IplImage* previous, const IplImage* current, ImageRect* rect);
+static void clearUnchangedPixels(const ImageRect* rect, const unsigned char* mask, unsigned char* indices, int transparentIndex);
+static int paletteColorLimit(const ExportContext* context);
+static int reserveTransparentIndex(GifPalette* palette);
+static ExportResult buildGlobalColorMap(ExportContext* context, FrameList* list, int frameCount, ThreadPool* pool, ColorMap* map);
+static void countFrameColors(void* argument);
+static void buildUniformPalette(GifPalette* palette);
+static void mapToColorMap(ExportContext* context, const ColorMap* map, const IplImage* image, unsigned char* indices);
+static void quantizeUniform(const IplImage* image, unsigned char* indices);
+static void quantizeUniformTile(void* context, const ImageTile* tile);
+static unsigned char levelOf(unsigned char value, int levels);
+
+/*
+	Function that sets export options to the defaults: one median cut palette for the whole GIF, without dithering,
+	where each frame only stores the rectangle that changed since the frame before it, from the start of the timeline.
+	Input: options - the options to set.
+	Output: None.
+*/
+void initExportOptions(ExportOptions* options)
+{
+	options->paletteMode = PALETTE_GLOBAL;
+	options->ditherMode = DITHER_NONE;
+	options->frameDiffMode = FRAME_DIFF_RECTANGLE;
+	options->startTime = 0;
+}
+
+/*
+	Function that encodes the whole timeline into a GIF89a file, on a thread pool of its own.
+	Input: list - the frames to export.
+		   cache - the decoded image cache the frames are read through.
+		   outputPath - the path of the GIF file to create.
+		   options - how the frames are turned into palette images.
+	Output: EXPORT_SUCCESS, or the reason the export failed.
+*/
+ExportResult exportGif(FrameList* list, ImageCache* cache, const char* outputPath, const ExportOptions* options)
+{
+	ThreadPool* pool = createThreadPool(THREAD_POOL_ONE_PER_PROCESSOR);
+	ExportResult result = exportGifOnPool(list, cache, outputPath, options, pool);
+
+	freeThreadPool(&pool);
+	return result;
+}
+
+/*
+	Function that encodes the whole timeline into a GIF89a file.
+	Frames are decoded, quantized and compressed in parallel on the given pool and written in timeline order.
+	At most EXPORT_JOBS_PER_WORKER frames per worker are in flight, which bounds the memory used.
+	The GIF starts with the frame on screen at the start time, shown for the rest of its duration.
+	The logical screen is the project's canvas, which every frame is fitted to once and cached at,
+	or without a canvas the size of that first frame, other frames are then resized to it.
+	Each frame's delay is its duration rounded to the GIF's 10 ms unit.
+	With a global palette the colors of every frame are counted first, also in parallel, and one median cut
+	palette is written for the whole GIF. With a palette per frame each frame gets a median cut palette of its own.
+	When frames are diffed, every frame after the first is compared with the frame before it and only the rectangle
+	that changed is stored, drawn over the previous frame. With transparency the pixels of that rectangle which
+	did not change are also left transparent, which costs one palette color but compresses better.
+	Input: list - the frames to export.
+		   cache - the decoded image cache the frames are read through.
+		   outputPath - the path of the GIF file to create.
+		   options - how the frames are turned into palette images.
+		   pool - the pool to encode on. When called from one of its tasks, the calling worker encodes frames too while it waits.
+	Output: EXPORT_SUCCESS, or the reason the export failed.
+*/
+ExportResult exportGifOnPool(FrameList* list, ImageCache* cache, const char* outputPath, const ExportOptions* options, ThreadPool* pool)
+{
+	GifWriter* writer = NULL;
+	GifPalette palette;
+	ColorMap* globalMap = NULL;
+	ExportContext context;
+	ExportJob* jobs = NULL;
+	ExportJob* job = NULL;
+	ImageCacheEntry* entry = NULL;
+	ExportResult result = EXPORT_SUCCESS;
+	int frameCount = frameNodeListLength(list);
+	int jobCount = 0, nextFrame = 0, i = 0;
+
+	if (!frameCount)
+	{
+		return EXPORT_EMPTY_PROJECT;
+	}
+	context.firstFrame = findFrameAtTime(list, options->startTime);
+	if (TIMELINE_END == context.firstFrame)
+	{
+		return EXPORT_START_PAST_END;
+	}
+	context.firstFrameSkipped = (unsigned int)(options->startTime - getFrameStartTime(list, context.firstFrame));
+	frameCount -= context.firstFrame;
+	context.canvas = &list->canvas;
+	if (isCanvasSet(context.canvas))
+	{
+		context.width = (int)context.canvas->width;
+		context.height = (int)context.canvas->height;
+	}
+	else
+	{
+		entry = acquireFrameImage(cache, getFrameAtIndex(list, context.firstFrame));
+		if (!entry)
+		{
+			return EXPORT_DECODE_FAILED;
+		}
+		context.width = entry->image->width;
+		context.height = entry->image->height;
+		releaseCachedImage(cache, &entry);
+	}
+	context.cache = cache;
+	context.pool = pool;
+	context.paletteMode = options->paletteMode;
+	context.ditherMode = options->ditherMode;
+	context.frameDiffMode = options->frameDiffMode;
+	context.palette = &palette;
+	context.colorMap = NULL;
+	context.transparentIndex = GIF_NO_TRANSPARENCY;
+	initMutex(&context.lock);
+	initCondition(&context.jobFinished);
+
+	if (PALETTE_GLOBAL == context.paletteMode)
+	{
+		globalMap = (ColorMap*)malloc(sizeof(ColorMap));
+		if (!globalMap)
+		{
+			printf("Memory allocation failed!\n");
+			exit(MEMORY_ALLOCATION_ERROR_CODE);
+		}
+		result = buildGlobalColorMap(&context, list, frameCount, pool, globalMap);
+		context.palette = &globalMap->palette;
+		context.colorMap = globalMap;
+	}
+	else if (PALETTE_UNIFORM == context.paletteMode && DITHER_NONE != context.ditherMode)
+	{
+		// Dithering looks colors up in a color map, which the fixed palette otherwise does not need
+		globalMap = (ColorMap*)malloc(sizeof(ColorMap));
+		if (!globalMap)
+		{
+			printf("Memory allocation failed!\n");
+			exit(MEMORY_ALLOCATION_ERROR_CODE);
+		}
+		buildUniformPalette(&globalMap->palette);
+		buildColorMap(globalMap);
+		context.palette = &globalMap->palette;
+		context.colorMap = globalMap;
+	}
+	else
+	{
+		buildUniformPalette(&palette);
+	}
+	if (FRAME_DIFF_TRANSPARENT == context.frameDiffMode && PALETTE_PER_FRAME != context.paletteMode)
+	{
+		context.transparentIndex = reserveTransparentIndex(globalMap ? &globalMap->palette : &palette);
+	}
+	if (EXPORT_SUCCESS == result)
+	{
+		writer = openGifWriter(outputPath, context.width, context.height,
+			PALETTE_PER_FRAME == context.paletteMode ? NULL : context.palette, GIF_LOOP_FOREVER);
+		result = writer ? EXPORT_SUCCESS : EXPORT_WRITE_FAILED;
+	}
+	if (EXPORT_SUCCESS != result)
+	{
+		free(globalMap);
+		destroyCondition(&context.jobFinished);
+		destroyMutex(&context.lock);
+		return result;
+	}
+
+	jobCount = pool->workerCount * EXPORT_JOBS_PER_WORKER;
+	if (jobCount < INC)
+	{
+		jobCount = INC;
+	}
+	if (jobCount > frameCount)
+	{
+		jobCount = frameCount;
+	}
+	jobs = (ExportJob*)malloc(sizeof(ExportJob) * jobCount);
+	if (!jobs)
+	{
+		printf("Memory allocation failed!\n");
+		exit(MEMORY_ALLOCATION_ERROR_CODE);
+	}
+	for (i = 0; i < jobCount; i++)
+	{
+		jobs[i].context = &context;
+		jobs[i].indices = (unsigned char*)malloc((size_t)context.width * context.height);
+		jobs[i].mask = NULL;
+		jobs[i].screenImage = NULL;
+		jobs[i].previousScreenImage = NULL;
+		jobs[i].histogram = NULL;
+		jobs[i].localMap = NULL;
+		if (PALETTE_PER_FRAME == context.paletteMode)
+		{
+			jobs[i].histogram = (ColorHistogram*)malloc(sizeof(ColorHistogram));
+			jobs[i].localMap = (ColorMap*)malloc(sizeof(ColorMap));
+		}
+		if (FRAME_DIFF_TRANSPARENT == context.frameDiffMode)
+		{
+			jobs[i].mask = (unsigned char*)malloc((size_t)context.width * context.height);
+		}
+		if (!jobs[i].indices || (PALETTE_PER_FRAME == context.paletteMode && (!jobs[i].histogram || !jobs[i].localMap))
+			|| (FRAME_DIFF_TRANSPARENT == context.frameDiffMode && !jobs[i].mask))
+		{
+			printf("Memory allocation failed!\n");
+			exit(MEMORY_ALLOCATION_ERROR_CODE);
+		}
+		initByteBuffer(&jobs[i].encoded);
+	}
+
+	for (nextFrame = 0; nextFrame < jobCount; nextFrame++)
+	{
+		startExportJob(pool, &jobs[nextFrame], list, context.firstFrame + nextFrame);
+	}
+	for (i = 0; EXPORT_SUCCESS == result && i < frameCount; i++)
+	{
+		job = &jobs[i % jobCount];
+		waitUntilFinished(pool, &context, &job->finished);
+		result = job->result;
+		if (EXPORT_SUCCESS == result && GIF_WRITE_SUCCESS != writeGifBytes(writer, &job->encoded))
+		{
+			result = EXPORT_WRITE_FAILED;
+		}
+		if (EXPORT_SUCCESS == result && nextFrame < frameCount)
+		{
+			startExportJob(pool, job, list, context.firstFrame + nextFrame);
+			nextFrame++;
+		}
+	}
+
+	// Lets the jobs still in flight after a failure finish before their buffers are freed
+	for (i = 0; i < jobCount; i++)
+	{
+		waitUntilFinished(pool, &context, &jobs[i].finished);
+	}
+	if (GIF_WRITE_SUCCESS != closeGifWriter(&writer) && EXPORT_SUCCESS == result)
+	{
+		result = EXPORT_WRITE_FAILED;
+	}
+	for (i = 0; i < jobCount; i++)
+	{
+		freeByteBuffer(&jobs[i].encoded);
+		cvReleaseImage(&jobs[i].screenImage);
+		cvReleaseImage(&jobs[i].previousScreenImage);
+		free(jobs[i].localMap);
+		free(jobs[i].histogram);
+		free(jobs[i].mask);
+		free(jobs[i].indices);
+	}
+	free(jobs);
+	free(globalMap);
+	destroyCondition(&context.jobFinished);
+	destroyMutex(&context.lock);
+	return result;
+}
+
+/*
+	Function that describes the result of an export for the user.
+	Input: result - the export result.
+	Output: a message describing the result.
+*/
+const char* exportResultMessage(ExportResult result)
+{
+	switch (result)
+	{
+	case EXPORT_SUCCESS:
+		return "GIF exported successfully!";
+	case EXPORT_EMPTY_PROJECT:
+		return "There are no frames to export!";
+	case EXPORT_DECODE_FAILED:
+		return "A frame image could not be opened, the GIF is incomplete!";
+	case EXPORT_START_PAST_END:
+		return "The start time is past the end of the movie!";
+	default:
+		return "Could not write the GIF file!";
+	}
+}
+
+/*
+	Hands the frame at the given timeline index to a job and queues it on the pool.
+	Frames are looked up here, on the writing thread, so the list is never read by the workers.
+*/
+static void startExportJob(ThreadPool* pool, ExportJob* job, FrameList* list, int index)
+{
+	job->frame = getFrameAtIndex(list, index);
+	job->previousFrame = index > job->context->firstFrame && FRAME_DIFF_OFF != job->context->frameDiffMode
+		? getFrameAtIndex(list, index - 1) : NULL;
+	job->duration = job->frame->duration - (index == job->context->firstFrame ? job->context->firstFrameSkipped : 0);
+	job->imageNumber = index + FIRST_NODE_INDEX;
+	job->result = EXPORT_SUCCESS;
+	job->finished = FALSE;
+	submitTask(pool, encodeFrame, job);
+}
+
+/*
+	Pool task: decodes one frame through the cache, quantizes it to the palette and LZW-compresses it.
+	When frames are diffed the frame before it is read too, usually still in the cache from its own job,
+	and only the rectangle that changed is quantized and compressed.
+*/
+static void encodeFrame(void* argument)
+{
+	ExportJob* job = (ExportJob*)argument;
+	ExportContext* context = job->context;
+	ImageCacheEntry* entry = acquireCanvasImage(context->cache, NULL, job->frame, context->canvas);
+	ImageCacheEntry* previousEntry = NULL;
+	const IplImage* image = NULL;
+	const IplImage* previous = NULL;
+	IplImage region;
+	ImageRect rect;
+	GifImage gifImage;
+
+	job->encoded.size = 0;
+	if (!entry)
+	{
+		printf("Could not open or find image number %d\n", job->imageNumber);
+		job->result = EXPORT_DECODE_FAILED;
+	}
+	else
+	{
+		image = fitToScreen(context, entry->image, &job->screenImage);
+		rect.left = 0;
+		rect.top = 0;
+		rect.width = context->width;
+		rect.height = context->height;
+		// A previous frame that cannot be read fails the export in its own job, this one is then stored whole
+		previousEntry = job->previousFrame ? acquireCanvasImage(context->cache, NULL, job->previousFrame, context->canvas) : NULL;
+		if (previousEntry)
+		{
+			previous = fitToScreen(context, previousEntry->image, &job->previousScreenImage);
+			findFrameRect(context, previous, image, &rect);
+		}
+		cvInitImageHeader(&region, cvSize(rect.width, rect.height), IPL_DEPTH_8U, BGR_CHANNELS, IPL_ORIGIN_TL, IMAGE_ROW_ALIGNMENT);
+		cvSetData(&region, image->imageData + (size_t)rect.top * image->widthStep + (size_t)rect.left * BGR_CHANNELS, image->widthStep);
+
+		gifImage.palette = context->palette;
+		gifImage.hasLocalPalette = FALSE;
+		gifImage.transparentIndex = context->transparentIndex;
+		if (PALETTE_PER_FRAME != context->paletteMode)
+		{
+			mapToColorMap(context, context->colorMap, &region, job->indices);
+		}
+		else
+		{
+			clearColorHistogram(job->histogram);
+			addImageToHistogram(job->histogram, &region);
+			buildMedianCutPalette(job->histogram, paletteColorLimit(context), &job->localMap->palette);
+			buildColorMap(job->localMap);
+			mapToColorMap(context, job->localMap, &region, job->indices);
+			if (FRAME_DIFF_TRANSPARENT == context->frameDiffMode)
+			{
+				gifImage.transparentIndex = reserveTransparentIndex(&job->localMap->palette);
+			}
+			gifImage.palette = &job->localMap->palette;
+			gifImage.hasLocalPalette = TRUE;
+		}
+		if (previousEntry && FRAME_DIFF_TRANSPARENT == context->frameDiffMode)
+		{
+			findUnchangedPixels(previous, image, &rect, job->mask);
+			clearUnchangedPixels(&rect, job->mask, job->indices, gifImage.transparentIndex);
+		}
+		if (previousEntry)
+		{
+			releaseCachedImage(context->cache, &previousEntry);
+		}
+		releaseCachedImage(context->cache, &entry);
+
+		gifImage.indices = job->indices;
+		gifImage.left = rect.left;
+		gifImage.top = rect.top;
+		gifImage.width = rect.width;
+		gifImage.height = rect.height;
+		gifImage.delayMilliseconds = job->duration;
+		gifImage.disposal = GIF_DISPOSAL_NONE;
+		encodeGifImage(&gifImage, &job->encoded);
+	}
+
+	lockMutex(&context->lock);
+	job->finished = TRUE;
+	broadcastCondition(&context->jobFinished);
+	unlockMutex(&context->lock);
+}
+
+/*
+	Blocks the writing thread until a job has finished, running its own queued jobs meanwhile.
+*/
+static void waitUntilFinished(ThreadPool* pool, ExportContext* context, const int* finished)
+{
+	lockMutex(&context->lock);
+	while (!*finished)
+	{
+		unlockMutex(&context->lock);
+		if (runPendingTask(pool))
+		{
+			lockMutex(&context->lock);
+			continue;
+		}
+		lockMutex(&context->lock);
+		if (!*finished)
+		{
+			waitCondition(&context->jobFinished, &context->lock);
+		}
+	}
+	unlockMutex(&context->lock);
+}
+
+/*
+	Gives a decoded image at the size of the logical screen, resizing it into the job's buffer when needed.
+	Images fitted to a canvas already have its size and are returned as they are.
+*/
+static const IplImage* fitToScreen(const ExportContext* context, const IplImage* image, IplImage** screenImage)
+{
+	if (image->width == context->width && image->height == context->height)
+	{
+		return image;
+	}
+	if (!*screenImage)
+	{
+		*screenImage = cvCreateImage(cvSize(context->width, context->height), IPL_DEPTH_8U, BGR_CHANNELS);
+	}
+	cvResize(image, *screenImage, CV_INTER_AREA);
+	return *screenImage;
+}
+
+/*
+	Finds the rectangle of a frame to store: the pixels that changed since the previous frame,
+	or a single pixel when nothing did, since a GIF image cannot be empty.
+	With ordered dithering the rectangle starts on the pattern's grid, so stored pixels keep the pattern of the frames around them.
+*/
+static void findFrameRect(const ExportContext* context, const IplImage* previous, const IplImage* current, ImageRect* rect)
+{
+	if (FRAME_UNCHANGED == findChangedRect(previous, current, rect))
+	{
+		rect->left = 0;
+		rect->top = 0;
+		rect->width = INC;
+		rect->height = INC;
+	}
+	if (DITHER_ORDERED == context->ditherMode)
+	{
+		rect->width += rect->left % BAYER_SIZE;
+		rect->left -= rect->left % BAYER_SIZE;
+		rect->height += rect->top % BAYER_SIZE;
+		rect->top -= rect->top % BAYER_SIZE;
+	}
+}
+
+/*
+	Replaces the indices of the pixels that did not change with the transparent index.
+*/
+static void clearUnchangedPixels(const ImageRect* rect, const unsigned char* mask, unsigned char* indices, int transparentIndex)
+{
+	size_t pixelCount = (size_t)rect->width * rect->height;
+	size_t i = 0;
+
+	for (i = 0; i < pixelCount; i++)
+	{
+		if (PIXEL_UNCHANGED == mask[i])
+		{
+			indices[i] = (unsigned char)transparentIndex;
+		}
+	}
+}
+
+/*
+	Gives how many colors a median cut palette may have, one less when a color is kept for transparency.
+*/
+static int paletteColorLimit(const ExportContext* context)
+{
+	return FRAME_DIFF_TRANSPARENT == context->frameDiffMode ? GIF_MAX_COLORS - INC : GIF_MAX_COLORS;
+}
+
+/*
+	Adds a color after the last one of a palette, to be used as the transparent index.
+	It is added after the color map is built, so no pixel is ever mapped to it.
+*/
+static int reserveTransparentIndex(GifPalette* palette)
+{
+	palette->colors[palette->size][0] = 0;
+	palette->colors[palette->size][1] = 0;
+	palette->colors[palette->size][2] = 0;
+	return palette->size++;
+}
+
+/*
+	Counts the colors of the exported frames, split into ranges counted in parallel, and builds one palette and color map from them.
+	The frames are counted as fitted to the canvas, or without one at their own size, before any resize to the logical screen.
+*/
+static ExportResult buildGlobalColorMap(ExportContext* context, FrameList* list, int frameCount, ThreadPool* pool, ColorMap* map)
+{
+	HistogramJob* jobs = NULL;
+	const Frame** frames = NULL;
+	ExportResult result = EXPORT_SUCCESS;
+	int jobCount = pool->workerCount * EXPORT_JOBS_PER_WORKER;
+	int i = 0, firstFrame = 0;
+
+	if (jobCount < INC)
+	{
+		jobCount = INC;
+	}
+	if (jobCount > frameCount)
+	{
+		jobCount = frameCount;
+	}
+	frames = (const Frame**)malloc(sizeof(Frame*) * frameCount);
+	jobs = (HistogramJob*)malloc(sizeof(HistogramJob) * jobCount);
+	if (!frames || !jobs)
+	{
+		printf("Memory allocation failed!\n");
+		exit(MEMORY_ALLOCATION_ERROR_CODE);
+	}
+	for (i = 0; i < frameCount; i++)
+	{
+		frames[i] = getFrameAtIndex(list, context->firstFrame + i);
+	}
+
+	for (i = 0; i < jobCount; i++)
+	{
+		jobs[i].context = context;
+		jobs[i].frames = frames + firstFrame;
+		jobs[i].frameCount = (int)((long long)frameCount * (i + INC) / jobCount) - firstFrame;
+		jobs[i].result = EXPORT_SUCCESS;
+		jobs[i].finished = FALSE;
+		firstFrame += jobs[i].frameCount;
+		submitTask(pool, countFrameColors, &jobs[i]);
+	}
+	for (i = 0; i < jobCount; i++)
+	{
+		waitUntilFinished(pool, context, &jobs[i].finished);
+		if (EXPORT_SUCCESS != jobs[i].result)
+		{
+			result = jobs[i].result;
+		}
+		if (i)
+		{
+			mergeColorHistograms(&jobs[0].histogram, &jobs[i].histogram);
+		}
+	}
+
+	if (EXPORT_SUCCESS == result)
+	{
+		buildMedianCutPalette(&jobs[0].histogram, paletteColorLimit(context), &map->palette);
+		buildColorMap(map);
+	}
+	free(jobs);
+	free(frames);
+	return result;
+}
+
+/*
+	Pool task: counts the colors of a range of frames into the job's histogram.
+*/
+static void countFrameColors(void* argument)
+{
+	HistogramJob* job = (HistogramJob*)argument;
+	ExportContext* context = job->context;
+	ImageCacheEntry* entry = NULL;
+	int i = 0;
+
+	clearColorHistogram(&job->histogram);
+	for (i = 0; EXPORT_SUCCESS == job->result && i < job->frameCount; i++)
+	{
+		entry = acquireCanvasImage(context->cache, NULL, job->frames[i], context->canvas);
+		if (!entry)
+		{
+			printf("Could not open or find image of frame %s\n", job->frames[i]->name);
+			job->result = EXPORT_DECODE_FAILED;
+		}
+		else
+		{
+			addImageToHistogram(&job->histogram, entry->image);
+			releaseCachedImage(context->cache, &entry);
+		}
+	}
+
+	lockMutex(&context->lock);
+	job->finished = TRUE;
+	broadcastCondition(&context->jobFinished);
+	unlockMutex(&context->lock);
+}
+
+/*
+	Maps a frame to palette indices with the export's dithering, or to the fixed palette directly when there is no color map.
+*/
+static void mapToColorMap(ExportContext* context, const ColorMap* map, const IplImage* image, unsigned char* indices)
+{
+	if (!map)
+	{
+		quantizeUniform(image, indices);
+	}
+	else if (DITHER_FLOYD_STEINBERG == context->ditherMode)
+	{
+		ditherFloydSteinberg(map, image, indices, context->pool);
+	}
+	else if (DITHER_ORDERED == context->ditherMode)
+	{
+		ditherOrdered(map, image, indices);
+	}
+	else
+	{
+		mapImageToPalette(map, image, indices);
+	}
+}
+
+/*
+	Fills the palette with an evenly spaced 6x7x6 color cube (252 colors), green gets the extra level.
+*/
+static void buildUniformPalette(GifPalette* palette)
+{
+	int red = 0, green = 0, blue = 0, index = 0;
+
+	for (red = 0; red < UNIFORM_RED_LEVELS; red++)
+	{
+		for (green = 0; green < UNIFORM_GREEN_LEVELS; green++)
+		{
+			for (blue = 0; blue < UNIFORM_BLUE_LEVELS; blue++)
+			{
+				palette->colors[index][0] = (unsigned char)(red * MAX_CHANNEL_VALUE / (UNIFORM_RED_LEVELS - INC));
+				palette->colors[index][1] = (unsigned char)(green * MAX_CHANNEL_VALUE / (UNIFORM_GREEN_LEVELS - INC));
+				palette->colors[index][2] = (unsigned char)(blue * MAX_CHANNEL_VALUE / (UNIFORM_BLUE_LEVELS - INC));
+				index++;
+			}
+		}
+	}
+	palette->size = index;
+}
+
+/*
+	Maps every pixel of a BGR image to the nearest color of the uniform palette, in tiles shared with the export's pool.
+*/
+static void quantizeUniform(const IplImage* image, unsigned char* indices)
+{
+	UniformMapping mapping;
+
+	mapping.image = image;
+	mapping.indices = indices;
+	runTiled(image->width, image->height, UNIFORM_BYTES_PER_PIXEL, quantizeUniformTile, &mapping);
+}
+
+/*
+	Tile kernel: maps the pixels of one tile to the uniform palette.
+*/
+static void quantizeUniformTile(void* context, const ImageTile* tile)
+{
+	const UniformMapping* mapping = (const UniformMapping*)context;
+	const IplImage* image = mapping->image;
+	const unsigned char* pixel = NULL;
+	unsigned char* index = NULL;
+	int x = 0, y = 0;
+
+	for (y = tile->top; y < tile->top + tile->height; y++)
+	{
+		pixel = (const unsigned char*)image->imageData + (size_t)y * image->widthStep + (size_t)tile->left * BGR_CHANNELS;
+		index = mapping->indices + (size_t)y * image->width + tile->left;
+		for (x = 0; x < tile->width; x++)
+		{
+			*index++ = (unsigned char)(
+				(levelOf(pixel[RED_CHANNEL], UNIFORM_RED_LEVELS) * UNIFORM_GREEN_LEVELS
+					+ levelOf(pixel[GREEN_CHANNEL], UNIFORM_GREEN_LEVELS)) * UNIFORM_BLUE_LEVELS
+				+ levelOf(pixel[BLUE_CHANNEL], UNIFORM_BLUE_LEVELS));
+			pixel += BGR_CHANNELS;
+		}
+	}
+}
+
+static unsigned char levelOf(unsigned char value, int levels)
+{
+	return (unsigned char)((value * (levels - INC) + MAX_CHANNEL_VALUE / 2) / MAX_CHANNEL_VALUE);
+}
@@ -0,0 +1,56 @@
+/*********************************
+*		GIF EDITOR PROJECT       *
+*     GIF Export Declaration     *
+**********************************/
+
+#ifndef GIFEXPORTH
+#define GIFEXPORTH
+
+#include "linkedList.h"
+#include "imageCache.h"
+#include "gifWriter.h"
+#include "threadPool.h"
+#include "quantize.h"
+#include "dither.h"
+#include "frameDiff.h"
+
+#define UNIFORM_RED_LEVELS 6
+#define UNIFORM_GREEN_LEVELS 7
+#define UNIFORM_BLUE_LEVELS 6
+#define MAX_CHANNEL_VALUE 255
+#define EXPORT_JOBS_PER_WORKER 2
+
+typedef enum ExportResult
+{
+	EXPORT_SUCCESS = 0,
+	EXPORT_EMPTY_PROJECT = 1,
+	EXPORT_DECODE_FAILED = 2,
+	EXPORT_WRITE_FAILED = 3,
+	EXPORT_START_PAST_END = 4
+} ExportResult;
+
+typedef enum PaletteMode
+{
+	PALETTE_UNIFORM = 0,
+	PALETTE_GLOBAL = 1,
+	PALETTE_PER_FRAME = 2
+} PaletteMode;
+
+// Choices of how an export turns the frames into palette images
+typedef struct ExportOptions
+{
+	PaletteMode	paletteMode;
+	DitherMode	ditherMode;
+	FrameDiffMode	frameDiffMode;
+	uint64_t	startTime;
+} ExportOptions;
+
+void initExportOptions(ExportOptions* options);
+
+ExportResult exportGif(FrameList* list, ImageCache* cache, const char* outputPath, const ExportOptions* options);
+
+ExportResult exportGifOnPool(FrameList* list, ImageCache* cache, const char* outputPath, const ExportOptions* options, ThreadPool* pool);
+
+const char* exportResultMessage(ExportResult result);
+
+#endif
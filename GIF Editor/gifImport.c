@@ -0,0 +1,151 @@
+/*********************************
+*		GIF EDITOR PROJECT       *
+*           GIF Import           *
+**********************************/
+
+#define _CRT_SECURE_NO_WARNINGS
+#define CV_IGNORE_DEBUG_BUILD_GUARD
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <opencv2/core/core_c.h>
+#include <opencv2/imgcodecs/imgcodecs_c.h>
+#include "gifImport.h"
+
+static char* createBaseName(const char* gifPath);
+static void createUniqueFrameName(FrameList* list, char* name, const char* baseName, int frameNumber);
+
+/*
+	Function that appends the frames of an existing GIF to the end of the timeline.
+	The GIF is read one frame at a time: each composed frame is written to the folder as an image
+	and only then is the next one decoded, so the animation is never held in memory as a whole.
+	Frames are named after the GIF file and its frame numbers, and keep the GIF's delays.
+	Input: list - the frames to append to.
+		   gifPath - the path of the GIF file to import.
+		   folderDirectory - the folder the frame images are written into, the file names are appended to it as is.
+		   importedCount - where the number of frames added to the list is stored.
+	Output: IMPORT_SUCCESS, or the reason the import stopped, the frames read before that are kept.
+*/
+ImportResult importGif(FrameList* list, const char* gifPath, const char* folderDirectory, int* importedCount)
+{
+	GifReader* reader = openGifReader(gifPath);
+	IplImage* canvasImage = NULL;
+	ImportResult result = IMPORT_SUCCESS;
+	char* baseName = NULL;
+	char* name = NULL;
+	char* path = NULL;
+	unsigned int delay = 0;
+	int status = GIF_READ_FRAME;
+
+	*importedCount = 0;
+	if (!reader)
+	{
+		return IMPORT_OPEN_FAILED;
+	}
+
+	baseName = createBaseName(gifPath);
+	name = (char*)malloc(strlen(baseName) + IMPORT_NUMBER_MAX_LENGTH + INC);
+	path = (char*)malloc(strlen(folderDirectory) + strlen(baseName) + IMPORT_NUMBER_MAX_LENGTH + strlen(IMPORT_FRAME_EXTENSION) + INC);
+	canvasImage = cvCreateImageHeader(cvSize(reader->width, reader->height), IPL_DEPTH_8U, GIF_READER_CHANNELS);
+	if (!name || !path || !canvasImage)
+	{
+		printf("Memory allocation failed!\n");
+		exit(MEMORY_ALLOCATION_ERROR_CODE);
+	}
+	cvSetData(canvasImage, reader->canvas, reader->width * GIF_READER_CHANNELS);
+
+	while (IMPORT_SUCCESS == result && GIF_READ_FRAME == (status = readNextGifFrame(reader, &delay)))
+	{
+		createUniqueFrameName(list, name, baseName, *importedCount + FIRST_NODE_INDEX);
+		sprintf(path, "%s%s%s", folderDirectory, name, IMPORT_FRAME_EXTENSION);
+		if (!cvSaveImage(path, canvasImage, NULL))
+		{
+			result = IMPORT_WRITE_FAILED;
+		}
+		else
+		{
+			insertFrameToList(list, createFrame(list, name, delay, path));
+			(*importedCount)++;
+		}
+	}
+	if (IMPORT_SUCCESS == result && GIF_READ_ERROR == status)
+	{
+		result = IMPORT_READ_FAILED;
+	}
+
+	cvReleaseImageHeader(&canvasImage);
+	closeGifReader(&reader);
+	free(baseName);
+	free(name);
+	free(path);
+	return result;
+}
+
+/*
+	Function that describes the result of an import for the user.
+	Input: result - the import result.
+	Output: a message describing the result.
+*/
+const char* importResultMessage(ImportResult result)
+{
+	switch (result)
+	{
+	case IMPORT_SUCCESS:
+		return "GIF imported successfully!";
+	case IMPORT_OPEN_FAILED:
+		return "Could not open the file as a GIF!";
+	case IMPORT_READ_FAILED:
+		return "The GIF is damaged, only the frames before the damage were imported!";
+	default:
+		return "Could not write a frame image, the import stopped!";
+	}
+}
+
+/*
+	Returns a copy of the GIF's file name without its folder and extension.
+*/
+static char* createBaseName(const char* gifPath)
+{
+	const char* start = gifPath;
+	const char* end = NULL;
+	const char* current = NULL;
+	char* baseName = NULL;
+
+	for (current = gifPath; *current; current++)
+	{
+		if ('/' == *current || '\\' == *current)
+		{
+			start = current + INC;
+		}
+	}
+	end = strrchr(start, '.');
+	if (!end || end == start)
+	{
+		end = start + strlen(start);
+	}
+
+	baseName = (char*)malloc(end - start + INC);
+	if (!baseName)
+	{
+		printf("Memory allocation failed!\n");
+		exit(MEMORY_ALLOCATION_ERROR_CODE);
+	}
+	memcpy(baseName, start, end - start);
+	baseName[end - start] = NULL_CHAR;
+	return baseName;
+}
+
+/*
+	Writes "<baseName>_<frameNumber>" into name, adding a copy number if a frame already has that name.
+*/
+static void createUniqueFrameName(FrameList* list, char* name, const char* baseName, int frameNumber)
+{
+	int copyNumber = FIRST_NODE_INDEX;
+
+	sprintf(name, "%s_%d", baseName, frameNumber);
+	while (findFrameNodeByFrameNameInList(list, name))
+	{
+		copyNumber++;
+		sprintf(name, "%s_%d_%d", baseName, frameNumber, copyNumber);
+	}
+}
@@ -0,0 +1,27 @@
+/*********************************
+*		GIF EDITOR PROJECT       *
+*     GIF Import Declaration     *
+**********************************/
+
+#ifndef GIFIMPORTH
+#define GIFIMPORTH
+
+#include "linkedList.h"
+#include "gifReader.h"
+
+#define IMPORT_FRAME_EXTENSION ".png"
+#define IMPORT_NUMBER_MAX_LENGTH 24
+
+typedef enum ImportResult
+{
+	IMPORT_SUCCESS = 0,
+	IMPORT_OPEN_FAILED = 1,
+	IMPORT_READ_FAILED = 2,
+	IMPORT_WRITE_FAILED = 3
+} ImportResult;
+
+ImportResult importGif(FrameList* list, const char* gifPath, const char* folderDirectory, int* importedCount);
+
+const char* importResultMessage(ImportResult result);
+
+#endif
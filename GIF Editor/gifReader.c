@@ -0,0 +1,490 @@
+/*********************************
+*		GIF EDITOR PROJECT       *
+*           GIF Reader           *
+**********************************/
+
+#define _CRT_SECURE_NO_WARNINGS
+#include <stdlib.h>
+#include <string.h>
+#include "gifReader.h"
+#include "linkedList.h"
+
+#define GIF_SIGNATURE_LENGTH 6
+#define GIF_SCREEN_DESCRIPTOR_LENGTH 7
+#define GIF_IMAGE_DESCRIPTOR_LENGTH 9
+#define GIF_EXTENSION_INTRODUCER 0x21
+#define GIF_IMAGE_SEPARATOR 0x2C
+#define GIF_TRAILER 0x3B
+#define GIF_GRAPHIC_CONTROL_LABEL 0xF9
+#define GIF_GRAPHIC_CONTROL_LENGTH 4
+#define GIF_COLOR_TABLE_FLAG 0x80
+#define GIF_INTERLACE_FLAG 0x40
+#define GIF_COLOR_TABLE_SIZE_MASK 0x07
+#define GIF_TRANSPARENCY_FLAG 0x01
+#define GIF_DISPOSAL_SHIFT 2
+#define GIF_DISPOSAL_MASK 0x07
+#define GIF_INTERLACE_PASSES 4
+#define BITS_IN_BYTE 8
+#define NO_CODE -1
+#define SCREEN_WIDTH_OFFSET 6
+#define SCREEN_HEIGHT_OFFSET 8
+#define SCREEN_FIELDS_OFFSET 10
+#define SCREEN_BACKGROUND_OFFSET 11
+#define IMAGE_LEFT_OFFSET 0
+#define IMAGE_TOP_OFFSET 2
+#define IMAGE_WIDTH_OFFSET 4
+#define IMAGE_HEIGHT_OFFSET 6
+#define IMAGE_FIELDS_OFFSET 8
+#define CONTROL_FIELDS_OFFSET 0
+#define CONTROL_DELAY_OFFSET 1
+#define CONTROL_TRANSPARENT_OFFSET 3
+#define READ_BINARY_MODE "rb"
+#define ONE_ELEMENT 1
+
+static const int interlaceStart[GIF_INTERLACE_PASSES] = { 0, 4, 2, 1 };
+static const int interlaceStep[GIF_INTERLACE_PASSES] = { 8, 8, 4, 2 };
+
+static int readColorTable(FILE* file, GifPalette* palette, int packedFields);
+static int readGraphicControl(FILE* file, unsigned int* delayMilliseconds, int* transparentIndex, int* disposal);
+static int skipSubBlocks(FILE* file);
+static int readImage(GifReader* reader, int transparentIndex, int disposal);
+static int decodeImageData(GifReader* reader, int left, int top, int width, int height, int interlaced,
+	const GifPalette* palette, int transparentIndex);
+static int readCode(LzwDecoder* decoder, FILE* file, int codeSize);
+static int readDataByte(LzwDecoder* decoder, FILE* file);
+static void fillCanvas(GifReader* reader, int left, int top, int width, int height);
+static int readWord(const unsigned char* bytes);
+
+/*
+	Function that opens a GIF file and reads its header, ready to read the frames one by one.
+	Input: path - the path of the GIF file.
+	Output: pointer to the reader, or NULL if the file could not be opened or is not a GIF.
+*/
+GifReader* openGifReader(const char* path)
+{
+	GifReader* reader = NULL;
+	unsigned char header[GIF_SIGNATURE_LENGTH + GIF_SCREEN_DESCRIPTOR_LENGTH];
+	FILE* file = fopen(path, READ_BINARY_MODE);
+
+	if (!file)
+	{
+		return NULL;
+	}
+	if (fread(header, sizeof(header), ONE_ELEMENT, file) != ONE_ELEMENT
+		|| (memcmp(header, "GIF87a", GIF_SIGNATURE_LENGTH) && memcmp(header, "GIF89a", GIF_SIGNATURE_LENGTH))
+		|| !readWord(header + SCREEN_WIDTH_OFFSET) || !readWord(header + SCREEN_HEIGHT_OFFSET))
+	{
+		fclose(file);
+		return NULL;
+	}
+
+	reader = (GifReader*)malloc(sizeof(GifReader));
+	if (!reader)
+	{
+		printf("Memory allocation failed!\n");
+		exit(MEMORY_ALLOCATION_ERROR_CODE);
+	}
+	reader->file = file;
+	reader->width = readWord(header + SCREEN_WIDTH_OFFSET);
+	reader->height = readWord(header + SCREEN_HEIGHT_OFFSET);
+	reader->hasGlobalPalette = header[SCREEN_FIELDS_OFFSET] & GIF_COLOR_TABLE_FLAG;
+	reader->globalPalette.size = 0;
+	reader->backgroundIndex = header[SCREEN_BACKGROUND_OFFSET];
+	reader->savedCanvas = NULL;
+	reader->previousDisposal = GIF_DISPOSAL_NONE;
+	reader->canvas = (unsigned char*)malloc((size_t)reader->width * reader->height * GIF_READER_CHANNELS);
+	if (!reader->canvas)
+	{
+		printf("Memory allocation failed!\n");
+		exit(MEMORY_ALLOCATION_ERROR_CODE);
+	}
+
+	if (reader->hasGlobalPalette && GIF_READ_ERROR == readColorTable(file, &reader->globalPalette, header[SCREEN_FIELDS_OFFSET]))
+	{
+		closeGifReader(&reader);
+		return NULL;
+	}
+	fillCanvas(reader, 0, 0, reader->width, reader->height);
+	return reader;
+}
+
+/*
+	Function that reads the next frame of the GIF and composes it onto the logical screen.
+	After a frame is read, reader->canvas holds the whole screen as it should be shown,
+	width * height pixels of 3 bytes in blue, green, red order, valid until the next call.
+	Input: reader - the open reader.
+		   delayMilliseconds - where the frame's delay is stored, a delay of 0 becomes GIF_DEFAULT_DELAY_MILLISECONDS.
+	Output: GIF_READ_FRAME if a frame was read, GIF_READ_END after the last frame, GIF_READ_ERROR if the file is damaged.
+*/
+int readNextGifFrame(GifReader* reader, unsigned int* delayMilliseconds)
+{
+	unsigned int delay = 0;
+	int transparentIndex = GIF_NO_TRANSPARENCY;
+	int disposal = GIF_DISPOSAL_NONE;
+	int blockType = 0;
+
+	while (TRUE)
+	{
+		blockType = fgetc(reader->file);
+		if (EOF == blockType || GIF_TRAILER == blockType)
+		{
+			// A missing trailer is accepted, the frames read until the end of the file are kept
+			return GIF_READ_END;
+		}
+		else if (GIF_EXTENSION_INTRODUCER == blockType)
+		{
+			if (GIF_GRAPHIC_CONTROL_LABEL == fgetc(reader->file))
+			{
+				if (GIF_READ_ERROR == readGraphicControl(reader->file, &delay, &transparentIndex, &disposal))
+				{
+					return GIF_READ_ERROR;
+				}
+			}
+			else if (GIF_READ_ERROR == skipSubBlocks(reader->file))
+			{
+				return GIF_READ_ERROR;
+			}
+		}
+		else if (GIF_IMAGE_SEPARATOR == blockType)
+		{
+			*delayMilliseconds = delay ? delay : GIF_DEFAULT_DELAY_MILLISECONDS;
+			return readImage(reader, transparentIndex, disposal);
+		}
+		else
+		{
+			return GIF_READ_ERROR;
+		}
+	}
+}
+
+/*
+	Function that closes the GIF file and frees the reader.
+	Input: reader - the reader to close.
+	Output: None.
+*/
+void closeGifReader(GifReader** reader)
+{
+	if (!*reader)
+	{
+		return;
+	}
+	fclose((*reader)->file);
+	free((*reader)->canvas);
+	free((*reader)->savedCanvas);
+	free(*reader);
+	*reader = NULL;
+}
+
+/*
+	Reads a color table whose size is given by the low bits of a descriptor's packed fields.
+*/
+static int readColorTable(FILE* file, GifPalette* palette, int packedFields)
+{
+	palette->size = 2 << (packedFields & GIF_COLOR_TABLE_SIZE_MASK);
+	if (fread(palette->colors, sizeof(palette->colors[0]), palette->size, file) != (size_t)palette->size)
+	{
+		return GIF_READ_ERROR;
+	}
+	return GIF_READ_FRAME;
+}
+
+/*
+	Reads a graphic control extension, the introducer and label were already read.
+*/
+static int readGraphicControl(FILE* file, unsigned int* delayMilliseconds, int* transparentIndex, int* disposal)
+{
+	unsigned char fields[GIF_GRAPHIC_CONTROL_LENGTH];
+	int blockSize = fgetc(file);
+
+	if (GIF_GRAPHIC_CONTROL_LENGTH != blockSize || fread(fields, sizeof(fields), ONE_ELEMENT, file) != ONE_ELEMENT)
+	{
+		return GIF_READ_ERROR;
+	}
+	*disposal = (fields[CONTROL_FIELDS_OFFSET] >> GIF_DISPOSAL_SHIFT) & GIF_DISPOSAL_MASK;
+	*delayMilliseconds = readWord(fields + CONTROL_DELAY_OFFSET) * GIF_DELAY_UNIT_MILLISECONDS;
+	*transparentIndex = (fields[CONTROL_FIELDS_OFFSET] & GIF_TRANSPARENCY_FLAG) ? fields[CONTROL_TRANSPARENT_OFFSET] : GIF_NO_TRANSPARENCY;
+	return skipSubBlocks(file);
+}
+
+/*
+	Skips data sub-blocks up to and including the block terminator.
+*/
+static int skipSubBlocks(FILE* file)
+{
+	int blockSize = 0;
+
+	while ((blockSize = fgetc(file)) > 0)
+	{
+		if (fseek(file, blockSize, SEEK_CUR))
+		{
+			return GIF_READ_ERROR;
+		}
+	}
+	return EOF == blockSize ? GIF_READ_ERROR : GIF_READ_FRAME;
+}
+
+/*
+	Reads an image descriptor and its data, first applying the disposal of the frame before it.
+*/
+static int readImage(GifReader* reader, int transparentIndex, int disposal)
+{
+	unsigned char descriptor[GIF_IMAGE_DESCRIPTOR_LENGTH];
+	GifPalette localPalette;
+	const GifPalette* palette = reader->hasGlobalPalette ? &reader->globalPalette : NULL;
+	size_t canvasBytes = (size_t)reader->width * reader->height * GIF_READER_CHANNELS;
+
+	if (fread(descriptor, sizeof(descriptor), ONE_ELEMENT, reader->file) != ONE_ELEMENT)
+	{
+		return GIF_READ_ERROR;
+	}
+	if (descriptor[IMAGE_FIELDS_OFFSET] & GIF_COLOR_TABLE_FLAG)
+	{
+		if (GIF_READ_ERROR == readColorTable(reader->file, &localPalette, descriptor[IMAGE_FIELDS_OFFSET]))
+		{
+			return GIF_READ_ERROR;
+		}
+		palette = &localPalette;
+	}
+	if (!palette)
+	{
+		return GIF_READ_ERROR;
+	}
+
+	if (GIF_DISPOSAL_BACKGROUND == reader->previousDisposal)
+	{
+		fillCanvas(reader, reader->previousLeft, reader->previousTop, reader->previousWidth, reader->previousHeight);
+	}
+	else if (GIF_DISPOSAL_PREVIOUS == reader->previousDisposal && reader->savedCanvas)
+	{
+		memcpy(reader->canvas, reader->savedCanvas, canvasBytes);
+	}
+	if (GIF_DISPOSAL_PREVIOUS == disposal)
+	{
+		if (!reader->savedCanvas)
+		{
+			reader->savedCanvas = (unsigned char*)malloc(canvasBytes);
+			if (!reader->savedCanvas)
+			{
+				printf("Memory allocation failed!\n");
+				exit(MEMORY_ALLOCATION_ERROR_CODE);
+			}
+		}
+		memcpy(reader->savedCanvas, reader->canvas, canvasBytes);
+	}
+
+	reader->previousDisposal = disposal;
+	reader->previousLeft = readWord(descriptor + IMAGE_LEFT_OFFSET);
+	reader->previousTop = readWord(descriptor + IMAGE_TOP_OFFSET);
+	reader->previousWidth = readWord(descriptor + IMAGE_WIDTH_OFFSET);
+	reader->previousHeight = readWord(descriptor + IMAGE_HEIGHT_OFFSET);
+	return decodeImageData(reader, reader->previousLeft, reader->previousTop, reader->previousWidth, reader->previousHeight,
+		descriptor[IMAGE_FIELDS_OFFSET] & GIF_INTERLACE_FLAG, palette, transparentIndex);
+}
+
+/*
+	Decodes the LZW data of one image straight onto the canvas, pixels outside the screen are dropped.
+	Data that ends early or holds an impossible code leaves the rest of the image unchanged, like most viewers do.
+*/
+static int decodeImageData(GifReader* reader, int left, int top, int width, int height, int interlaced,
+	const GifPalette* palette, int transparentIndex)
+{
+	LzwDecoder* decoder = &reader->decoder;
+	unsigned char* pixel = NULL;
+	long long pixelsLeft = (long long)width * height;
+	int minCodeSize = fgetc(reader->file);
+	int clearCode = 0, endCode = 0, nextCode = 0, codeSize = 0;
+	int code = 0, inputCode = 0, previousCode = NO_CODE, firstByte = 0, stackSize = 0;
+	int x = 0, row = 0, pass = 0, index = 0;
+
+	if (minCodeSize < INC || minCodeSize > BITS_IN_BYTE)
+	{
+		return GIF_READ_ERROR;
+	}
+	clearCode = 1 << minCodeSize;
+	endCode = clearCode + INC;
+	nextCode = endCode + INC;
+	codeSize = minCodeSize + INC;
+	for (code = 0; code < clearCode; code++)
+	{
+		decoder->prefix[code] = 0;
+		decoder->suffix[code] = (unsigned char)code;
+	}
+	decoder->blockSize = 0;
+	decoder->blockPosition = 0;
+	decoder->blocksEnded = FALSE;
+	decoder->bits = 0;
+	decoder->bitCount = 0;
+
+	while (pixelsLeft > 0 && (code = readCode(decoder, reader->file, codeSize)) >= 0 && code != endCode)
+	{
+		if (code == clearCode)
+		{
+			nextCode = endCode + INC;
+			codeSize = minCodeSize + INC;
+			previousCode = NO_CODE;
+			continue;
+		}
+		if (NO_CODE == previousCode)
+		{
+			if (code >= clearCode)
+			{
+				break;
+			}
+			firstByte = code;
+			decoder->stack[0] = (unsigned char)code;
+			stackSize = INC;
+		}
+		else
+		{
+			inputCode = code;
+			stackSize = 0;
+			if (code >= nextCode)
+			{
+				if (code > nextCode)
+				{
+					break;
+				}
+				// The code being defined right now: the previous string followed by its own first byte
+				decoder->stack[stackSize++] = (unsigned char)firstByte;
+				code = previousCode;
+			}
+			while (code >= clearCode)
+			{
+				decoder->stack[stackSize++] = decoder->suffix[code];
+				code = decoder->prefix[code];
+			}
+			firstByte = code;
+			decoder->stack[stackSize++] = (unsigned char)code;
+
+			if (nextCode < GIF_MAX_CODES)
+			{
+				decoder->prefix[nextCode] = (unsigned short)previousCode;
+				decoder->suffix[nextCode] = (unsigned char)firstByte;
+				nextCode++;
+				if (nextCode == (1 << codeSize) && codeSize < GIF_MAX_CODE_BITS)
+				{
+					codeSize++;
+				}
+			}
+			code = inputCode;
+		}
+		previousCode = code;
+
+		// The string was pushed last byte first
+		while (stackSize > 0 && pixelsLeft > 0)
+		{
+			index = decoder->stack[--stackSize];
+			if (index != transparentIndex && index < palette->size
+				&& left + x < reader->width && top + row < reader->height)
+			{
+				pixel = reader->canvas + ((size_t)(top + row) * reader->width + left + x) * GIF_READER_CHANNELS;
+				pixel[0] = palette->colors[index][2];
+				pixel[1] = palette->colors[index][1];
+				pixel[2] = palette->colors[index][0];
+			}
+			pixelsLeft--;
+			if (++x == width)
+			{
+				x = 0;
+				if (!interlaced)
+				{
+					row++;
+				}
+				else
+				{
+					row += interlaceStep[pass];
+					while (row >= height && pass < GIF_INTERLACE_PASSES - INC)
+					{
+						pass++;
+						row = interlaceStart[pass];
+					}
+				}
+			}
+		}
+	}
+
+	if (!decoder->blocksEnded && GIF_READ_ERROR == skipSubBlocks(reader->file))
+	{
+		return GIF_READ_ERROR;
+	}
+	return ferror(reader->file) || feof(reader->file) ? GIF_READ_ERROR : GIF_READ_FRAME;
+}
+
+/*
+	Reads the next variable width code, codes are packed least significant bit first.
+*/
+static int readCode(LzwDecoder* decoder, FILE* file, int codeSize)
+{
+	int byte = 0, code = 0;
+
+	while (decoder->bitCount < codeSize)
+	{
+		byte = readDataByte(decoder, file);
+		if (EOF == byte)
+		{
+			return EOF;
+		}
+		decoder->bits |= (unsigned int)byte << decoder->bitCount;
+		decoder->bitCount += BITS_IN_BYTE;
+	}
+	code = decoder->bits & ((1 << codeSize) - 1);
+	decoder->bits >>= codeSize;
+	decoder->bitCount -= codeSize;
+	return code;
+}
+
+/*
+	Returns the next byte of image data, reading a new sub-block when the current one is used up.
+	Returns EOF once the block terminator is reached.
+*/
+static int readDataByte(LzwDecoder* decoder, FILE* file)
+{
+	if (decoder->blockPosition == decoder->blockSize)
+	{
+		if (decoder->blocksEnded)
+		{
+			return EOF;
+		}
+		decoder->blockSize = fgetc(file);
+		decoder->blockPosition = 0;
+		if (decoder->blockSize <= 0
+			|| fread(decoder->block, decoder->blockSize, ONE_ELEMENT, file) != ONE_ELEMENT)
+		{
+			decoder->blockSize = 0;
+			decoder->blocksEnded = TRUE;
+			return EOF;
+		}
+	}
+	return decoder->block[decoder->blockPosition++];
+}
+
+/*
+	Fills a rectangle of the canvas with the background color, clipped to the screen.
+*/
+static void fillCanvas(GifReader* reader, int left, int top, int width, int height)
+{
+	unsigned char color[GIF_READER_CHANNELS] = { 0, 0, 0 };
+	unsigned char* pixel = NULL;
+	int x = 0, y = 0;
+
+	if (reader->hasGlobalPalette && reader->backgroundIndex < reader->globalPalette.size)
+	{
+		color[0] = reader->globalPalette.colors[reader->backgroundIndex][2];
+		color[1] = reader->globalPalette.colors[reader->backgroundIndex][1];
+		color[2] = reader->globalPalette.colors[reader->backgroundIndex][0];
+	}
+	for (y = top; y < top + height && y < reader->height; y++)
+	{
+		pixel = reader->canvas + ((size_t)y * reader->width + left) * GIF_READER_CHANNELS;
+		for (x = left; x < left + width && x < reader->width; x++)
+		{
+			memcpy(pixel, color, GIF_READER_CHANNELS);
+			pixel += GIF_READER_CHANNELS;
+		}
+	}
+}
+
+static int readWord(const unsigned char* bytes)
+{
+	return bytes[0] | (bytes[1] << BITS_IN_BYTE);
+}
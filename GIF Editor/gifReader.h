@@ -0,0 +1,60 @@
+/*********************************
+*		GIF EDITOR PROJECT       *
+*     GIF Reader Declaration     *
+**********************************/
+
+#ifndef GIFREADERH
+#define GIFREADERH
+
+#include <stdio.h>
+#include "gifWriter.h"
+
+#define GIF_DISPOSAL_PREVIOUS 3
+#define GIF_DEFAULT_DELAY_MILLISECONDS 100
+#define GIF_READER_CHANNELS 3
+
+#define GIF_READ_FRAME 1
+#define GIF_READ_END 0
+#define GIF_READ_ERROR -1
+
+// State of the LZW decoder of the image being read, codes are decoded straight into the canvas
+typedef struct LzwDecoder
+{
+	unsigned short	prefix[GIF_MAX_CODES];
+	unsigned char	suffix[GIF_MAX_CODES];
+	unsigned char	stack[GIF_MAX_CODES + 1];
+	unsigned char	block[GIF_SUB_BLOCK_SIZE];
+	int		blockSize;
+	int		blockPosition;
+	int		blocksEnded;
+	unsigned int	bits;
+	int		bitCount;
+} LzwDecoder;
+
+// Open GIF file read one frame at a time.
+// Only the composed logical screen is kept in memory, never the whole animation.
+typedef struct GifReader
+{
+	FILE*		file;
+	int		width;
+	int		height;
+	GifPalette	globalPalette;
+	int		hasGlobalPalette;
+	int		backgroundIndex;
+	unsigned char*	canvas;
+	unsigned char*	savedCanvas;
+	int		previousDisposal;
+	int		previousLeft;
+	int		previousTop;
+	int		previousWidth;
+	int		previousHeight;
+	LzwDecoder	decoder;
+} GifReader;
+
+GifReader* openGifReader(const char* path);
+
+int readNextGifFrame(GifReader* reader, unsigned int* delayMilliseconds);
+
+void closeGifReader(GifReader** reader);
+
+#endif
@@ -0,0 +1,426 @@
+/*********************************
+*		GIF EDITOR PROJECT       *
+*   GIF89a Writer & LZW Encoder  *
+**********************************/
+
+#define _CRT_SECURE_NO_WARNINGS
+#include <stdlib.h>
+#include <string.h>
+#include "gifWriter.h"
+#include "linkedList.h"
+
+#define GIF_SIGNATURE "GIF89a"
+#define GIF_SIGNATURE_LENGTH 6
+#define GIF_EXTENSION_INTRODUCER 0x21
+#define GIF_GRAPHIC_CONTROL_LABEL 0xF9
+#define GIF_APPLICATION_LABEL 0xFF
+#define GIF_IMAGE_SEPARATOR 0x2C
+#define GIF_TRAILER 0x3B
+#define GIF_BLOCK_TERMINATOR 0x00
+#define GIF_COLOR_TABLE_FLAG 0x80
+#define GIF_COLOR_RESOLUTION_BITS 0x70
+#define GIF_TRANSPARENCY_FLAG 0x01
+#define GIF_DISPOSAL_SHIFT 2
+#define NETSCAPE_EXTENSION "NETSCAPE2.0"
+#define NETSCAPE_EXTENSION_LENGTH 11
+#define NETSCAPE_LOOP_SUB_BLOCK_ID 1
+#define LZW_EMPTY_KEY 0
+#define LZW_HASH_MULTIPLIER 2654435761u
+#define LZW_HASH_SHIFT 19
+#define WRITE_BINARY_MODE "wb"
+#define ONE_BYTE 1
+
+// State of the LZW encoder for one image: code table and the bit packer feeding sub-blocks
+typedef struct LzwEncoder
+{
+	unsigned int	keys[GIF_LZW_HASH_SIZE];
+	unsigned short	codes[GIF_LZW_HASH_SIZE];
+	int		minCodeSize;
+	int		codeSize;
+	int		nextCode;
+	unsigned long long	bitBuffer;
+	int		bitCount;
+	unsigned char	block[GIF_SUB_BLOCK_SIZE + INC];
+	int		blockLength;
+	ByteBuffer*	output;
+} LzwEncoder;
+
+static int bitsForColorCount(int colorCount);
+static void appendByte(ByteBuffer* buffer, unsigned char byte);
+static void appendWord(ByteBuffer* buffer, int word);
+static void appendPalette(ByteBuffer* buffer, const GifPalette* palette, int tableBits);
+static void resetCodeTable(LzwEncoder* encoder);
+static void writeCode(LzwEncoder* encoder, int code);
+static void flushBits(LzwEncoder* encoder);
+static void flushBlock(LzwEncoder* encoder);
+static void encodeLzw(LzwEncoder* encoder, const unsigned char* indices, size_t count);
+
+/*
+	Function that initializes an empty byte buffer.
+	Input: buffer - the buffer to initialize.
+	Output: None.
+*/
+void initByteBuffer(ByteBuffer* buffer)
+{
+	buffer->data = NULL;
+	buffer->size = 0;
+	buffer->capacity = 0;
+}
+
+/*
+	Function that frees the memory of a byte buffer.
+	Input: buffer - the buffer to free.
+	Output: None.
+*/
+void freeByteBuffer(ByteBuffer* buffer)
+{
+	free(buffer->data);
+	initByteBuffer(buffer);
+}
+
+/*
+	Function that appends bytes to the end of a byte buffer, growing it as needed.
+	Input: buffer - the buffer.
+		   bytes - the bytes to append.
+		   count - the number of bytes.
+	Output: None.
+*/
+void appendBytes(ByteBuffer* buffer, const void* bytes, size_t count)
+{
+	size_t capacity = buffer->capacity ? buffer->capacity : BYTE_BUFFER_INITIAL_CAPACITY;
+	unsigned char* data = NULL;
+
+	if (buffer->size + count > buffer->capacity)
+	{
+		while (capacity < buffer->size + count)
+		{
+			capacity *= 2;
+		}
+		data = (unsigned char*)realloc(buffer->data, capacity);
+		if (!data)
+		{
+			printf("Memory allocation failed!\n");
+			exit(MEMORY_ALLOCATION_ERROR_CODE);
+		}
+		buffer->data = data;
+		buffer->capacity = capacity;
+	}
+	memcpy(buffer->data + buffer->size, bytes, count);
+	buffer->size += count;
+}
+
+/*
+	Function that creates a GIF89a file and writes its header, logical screen and loop extension.
+	Input: path - the path of the GIF file to create.
+		   width, height - the logical screen size.
+		   globalPalette - the global color table, or NULL if every image brings its own.
+		   loopCount - how many times viewers repeat the animation, GIF_LOOP_FOREVER for no end.
+	Output: pointer to the open writer, or NULL if the file could not be created.
+*/
+GifWriter* openGifWriter(const char* path, int width, int height, const GifPalette* globalPalette, int loopCount)
+{
+	GifWriter* writer = NULL;
+	ByteBuffer header;
+	int tableBits = 0;
+	FILE* file = fopen(path, WRITE_BINARY_MODE);
+
+	if (!file)
+	{
+		return NULL;
+	}
+	writer = (GifWriter*)malloc(sizeof(GifWriter));
+	if (!writer)
+	{
+		printf("Memory allocation failed!\n");
+		exit(MEMORY_ALLOCATION_ERROR_CODE);
+	}
+	writer->file = file;
+	writer->width = width;
+	writer->height = height;
+
+	initByteBuffer(&header);
+	appendBytes(&header, GIF_SIGNATURE, GIF_SIGNATURE_LENGTH);
+	appendWord(&header, width);
+	appendWord(&header, height);
+	if (globalPalette)
+	{
+		tableBits = bitsForColorCount(globalPalette->size);
+		appendByte(&header, (unsigned char)(GIF_COLOR_TABLE_FLAG | GIF_COLOR_RESOLUTION_BITS | (tableBits - INC)));
+	}
+	else
+	{
+		appendByte(&header, GIF_COLOR_RESOLUTION_BITS);
+	}
+	appendByte(&header, 0); // background color index
+	appendByte(&header, 0); // pixel aspect ratio
+	if (globalPalette)
+	{
+		appendPalette(&header, globalPalette, tableBits);
+	}
+
+	appendByte(&header, GIF_EXTENSION_INTRODUCER);
+	appendByte(&header, GIF_APPLICATION_LABEL);
+	appendByte(&header, NETSCAPE_EXTENSION_LENGTH);
+	appendBytes(&header, NETSCAPE_EXTENSION, NETSCAPE_EXTENSION_LENGTH);
+	appendByte(&header, 3); // loop sub-block length
+	appendByte(&header, NETSCAPE_LOOP_SUB_BLOCK_ID);
+	appendWord(&header, loopCount);
+	appendByte(&header, GIF_BLOCK_TERMINATOR);
+
+	writeGifBytes(writer, &header);
+	freeByteBuffer(&header);
+	return writer;
+}
+
+/*
+	Function that encodes one image (graphic control extension, image descriptor,
+	local color table and LZW data) and appends it to a buffer.
+	Encoding only touches the buffer, so images can be encoded on any thread.
+	Input: image - the image to encode.
+		   output - the buffer the encoded image is appended to.
+	Output: None.
+*/
+void encodeGifImage(const GifImage* image, ByteBuffer* output)
+{
+	LzwEncoder* encoder = NULL;
+	int tableBits = bitsForColorCount(image->palette->size);
+	unsigned int delay = (image->delayMilliseconds + GIF_DELAY_UNIT_MILLISECONDS / 2) / GIF_DELAY_UNIT_MILLISECONDS;
+
+	appendByte(output, GIF_EXTENSION_INTRODUCER);
+	appendByte(output, GIF_GRAPHIC_CONTROL_LABEL);
+	appendByte(output, 4); // graphic control block length
+	appendByte(output, (unsigned char)((image->disposal << GIF_DISPOSAL_SHIFT) |
+		(GIF_NO_TRANSPARENCY != image->transparentIndex ? GIF_TRANSPARENCY_FLAG : 0)));
+	appendWord(output, delay > 0xFFFF ? 0xFFFF : (int)delay);
+	appendByte(output, (unsigned char)(GIF_NO_TRANSPARENCY != image->transparentIndex ? image->transparentIndex : 0));
+	appendByte(output, GIF_BLOCK_TERMINATOR);
+
+	appendByte(output, GIF_IMAGE_SEPARATOR);
+	appendWord(output, image->left);
+	appendWord(output, image->top);
+	appendWord(output, image->width);
+	appendWord(output, image->height);
+	if (image->hasLocalPalette)
+	{
+		appendByte(output, (unsigned char)(GIF_COLOR_TABLE_FLAG | (tableBits - INC)));
+		appendPalette(output, image->palette, tableBits);
+	}
+	else
+	{
+		appendByte(output, 0);
+	}
+
+	encoder = (LzwEncoder*)malloc(sizeof(LzwEncoder));
+	if (!encoder)
+	{
+		printf("Memory allocation failed!\n");
+		exit(MEMORY_ALLOCATION_ERROR_CODE);
+	}
+	encoder->minCodeSize = tableBits < GIF_MIN_CODE_SIZE ? GIF_MIN_CODE_SIZE : tableBits;
+	encoder->output = output;
+	appendByte(output, (unsigned char)encoder->minCodeSize);
+	encodeLzw(encoder, image->indices, (size_t)image->width * image->height);
+	appendByte(output, GIF_BLOCK_TERMINATOR);
+	free(encoder);
+}
+
+/*
+	Function that writes encoded bytes to the GIF file.
+	Input: writer - the open writer.
+		   bytes - the bytes to write.
+	Output: GIF_WRITE_SUCCESS or GIF_WRITE_FAILURE.
+*/
+int writeGifBytes(GifWriter* writer, const ByteBuffer* bytes)
+{
+	if (bytes->size != fwrite(bytes->data, sizeof(unsigned char), bytes->size, writer->file))
+	{
+		return GIF_WRITE_FAILURE;
+	}
+	return GIF_WRITE_SUCCESS;
+}
+
+/*
+	Function that writes the trailer, closes the file and frees the writer.
+	Input: writer - pointer to the writer to close.
+	Output: GIF_WRITE_SUCCESS if everything reached the file, else GIF_WRITE_FAILURE.
+*/
+int closeGifWriter(GifWriter** writer)
+{
+	int result = GIF_WRITE_SUCCESS;
+
+	if (!*writer)
+	{
+		return GIF_WRITE_FAILURE;
+	}
+	if (EOF == fputc(GIF_TRAILER, (*writer)->file) || ferror((*writer)->file))
+	{
+		result = GIF_WRITE_FAILURE;
+	}
+	if (fclose((*writer)->file))
+	{
+		result = GIF_WRITE_FAILURE;
+	}
+	free(*writer);
+	*writer = NULL;
+	return result;
+}
+
+/*
+	Returns the number of bits of the smallest color table (2 to 256 entries) that fits the colors.
+*/
+static int bitsForColorCount(int colorCount)
+{
+	int bits = INC;
+
+	while ((1 << bits) < colorCount)
+	{
+		bits++;
+	}
+	return bits;
+}
+
+static void appendByte(ByteBuffer* buffer, unsigned char byte)
+{
+	appendBytes(buffer, &byte, ONE_BYTE);
+}
+
+/*
+	Appends a 16 bit little endian value, the byte order of every GIF field.
+*/
+static void appendWord(ByteBuffer* buffer, int word)
+{
+	unsigned char bytes[2];
+
+	bytes[0] = (unsigned char)(word & 0xFF);
+	bytes[1] = (unsigned char)((word >> 8) & 0xFF);
+	appendBytes(buffer, bytes, sizeof(bytes));
+}
+
+/*
+	Appends a color table of 2^tableBits entries, unused entries are black.
+*/
+static void appendPalette(ByteBuffer* buffer, const GifPalette* palette, int tableBits)
+{
+	unsigned char black[3] = { 0, 0, 0 };
+	int i = 0;
+
+	appendBytes(buffer, palette->colors, sizeof(palette->colors[0]) * palette->size);
+	for (i = palette->size; i < (1 << tableBits); i++)
+	{
+		appendBytes(buffer, black, sizeof(black));
+	}
+}
+
+static void resetCodeTable(LzwEncoder* encoder)
+{
+	memset(encoder->keys, LZW_EMPTY_KEY, sizeof(encoder->keys));
+	encoder->codeSize = encoder->minCodeSize + INC;
+	encoder->nextCode = (1 << encoder->minCodeSize) + 2;
+}
+
+static void flushBlock(LzwEncoder* encoder)
+{
+	if (encoder->blockLength)
+	{
+		encoder->block[0] = (unsigned char)encoder->blockLength;
+		appendBytes(encoder->output, encoder->block, encoder->blockLength + INC);
+		encoder->blockLength = 0;
+	}
+}
+
+/*
+	LZW compression of palette indices. The string table is a hash table keyed by
+	(prefix code, next index), so each pixel costs one multiply and usually one probe.
+*/
+static void encodeLzw(LzwEncoder* encoder, const unsigned char* indices, size_t count)
+{
+	int clearCode = 1 << encoder->minCodeSize;
+	int prefix = 0, slot = 0;
+	unsigned int key = 0;
+	size_t i = 0;
+
+	encoder->bitBuffer = 0;
+	encoder->bitCount = 0;
+	encoder->blockLength = 0;
+	resetCodeTable(encoder);
+	writeCode(encoder, clearCode);
+
+	if (count)
+	{
+		prefix = indices[0];
+		for (i = INC; i < count; i++)
+		{
+			// keys are stored plus one so zero can mark an empty slot
+			key = (((unsigned int)prefix << 8) | indices[i]) + INC;
+			slot = (int)((key * LZW_HASH_MULTIPLIER) >> LZW_HASH_SHIFT) & (GIF_LZW_HASH_SIZE - 1);
+			while (encoder->keys[slot] != LZW_EMPTY_KEY && encoder->keys[slot] != key)
+			{
+				slot = (slot + INC) & (GIF_LZW_HASH_SIZE - 1);
+			}
+			if (encoder->keys[slot] == key)
+			{
+				prefix = encoder->codes[slot];
+				continue;
+			}
+
+			writeCode(encoder, prefix);
+			if (encoder->nextCode < GIF_LAST_TABLE_CODE)
+			{
+				encoder->keys[slot] = key;
+				encoder->codes[slot] = (unsigned short)encoder->nextCode++;
+			}
+			else
+			{
+				writeCode(encoder, clearCode);
+				resetCodeTable(encoder);
+			}
+			prefix = indices[i];
+		}
+		writeCode(encoder, prefix);
+	}
+	writeCode(encoder, clearCode + INC); // end of information
+	flushBits(encoder);
+	flushBlock(encoder);
+}
+
+/*
+	Packs a code into the bit buffer, least significant bit first, and moves whole bytes into the sub-block.
+	The decoder builds its table one code behind the encoder, so the code width grows only after
+	the code that makes the table reach the next power of two was written.
+*/
+static void writeCode(LzwEncoder* encoder, int code)
+{
+	encoder->bitBuffer |= (unsigned long long)code << encoder->bitCount;
+	encoder->bitCount += encoder->codeSize;
+	while (encoder->bitCount >= 8)
+	{
+		encoder->block[INC + encoder->blockLength++] = (unsigned char)(encoder->bitBuffer & 0xFF);
+		encoder->bitBuffer >>= 8;
+		encoder->bitCount -= 8;
+		if (GIF_SUB_BLOCK_SIZE == encoder->blockLength)
+		{
+			flushBlock(encoder);
+		}
+	}
+	if (encoder->nextCode >= (1 << encoder->codeSize) && encoder->codeSize < GIF_MAX_CODE_BITS)
+	{
+		encoder->codeSize++;
+	}
+}
+
+/*
+	Moves the last partial byte of the bit buffer into the sub-block.
+*/
+static void flushBits(LzwEncoder* encoder)
+{
+	if (encoder->bitCount > 0)
+	{
+		encoder->block[INC + encoder->blockLength++] = (unsigned char)(encoder->bitBuffer & 0xFF);
+		encoder->bitBuffer = 0;
+		encoder->bitCount = 0;
+		if (GIF_SUB_BLOCK_SIZE == encoder->blockLength)
+		{
+			flushBlock(encoder);
+		}
+	}
+}
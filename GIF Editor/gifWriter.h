@@ -0,0 +1,82 @@
+/*********************************
+*		GIF EDITOR PROJECT       *
+*     GIF Writer Declaration     *
+**********************************/
+
+#ifndef GIFWRITERH
+#define GIFWRITERH
+
+#include <stdio.h>
+#include <stddef.h>
+
+#define GIF_MAX_COLORS 256
+#define GIF_MIN_CODE_SIZE 2
+#define GIF_MAX_CODE_BITS 12
+#define GIF_MAX_CODES (1 << GIF_MAX_CODE_BITS)
+#define GIF_LAST_TABLE_CODE (GIF_MAX_CODES - 1)
+#define GIF_LZW_HASH_SIZE 8192
+#define GIF_SUB_BLOCK_SIZE 255
+#define GIF_DELAY_UNIT_MILLISECONDS 10
+#define GIF_LOOP_FOREVER 0
+#define GIF_NO_TRANSPARENCY -1
+#define GIF_DISPOSAL_NONE 1
+#define GIF_DISPOSAL_BACKGROUND 2
+#define BYTE_BUFFER_INITIAL_CAPACITY 4096
+
+#define GIF_WRITE_SUCCESS 1
+#define GIF_WRITE_FAILURE 0
+
+// Color table, colors are stored red, green, blue like in the file
+typedef struct GifPalette
+{
+	unsigned char	colors[GIF_MAX_COLORS][3];
+	int		size;
+} GifPalette;
+
+// Growable byte array that encoded images are written into before reaching the file
+typedef struct ByteBuffer
+{
+	unsigned char*	data;
+	size_t		size;
+	size_t		capacity;
+} ByteBuffer;
+
+// One image of the animation: palette indices of a rectangle of the logical screen.
+// palette is the table the indices refer to, written as a local table if hasLocalPalette is set.
+typedef struct GifImage
+{
+	const unsigned char*	indices;
+	int			left;
+	int			top;
+	int			width;
+	int			height;
+	const GifPalette*	palette;
+	int			hasLocalPalette;
+	unsigned int		delayMilliseconds;
+	int			transparentIndex;
+	int			disposal;
+} GifImage;
+
+// Open GIF89a file being written
+typedef struct GifWriter
+{
+	FILE*	file;
+	int	width;
+	int	height;
+} GifWriter;
+
+void initByteBuffer(ByteBuffer* buffer);
+
+void freeByteBuffer(ByteBuffer* buffer);
+
+void appendBytes(ByteBuffer* buffer, const void* bytes, size_t count);
+
+GifWriter* openGifWriter(const char* path, int width, int height, const GifPalette* globalPalette, int loopCount);
+
+void encodeGifImage(const GifImage* image, ByteBuffer* output);
+
+int writeGifBytes(GifWriter* writer, const ByteBuffer* bytes);
+
+int closeGifWriter(GifWriter** writer);
+
+#endif
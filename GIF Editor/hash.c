@@ -0,0 +1,112 @@
+/*********************************
+*		GIF EDITOR PROJECT       *
+*         Hash Functions         *
+**********************************/
+
+#include <string.h>
+#include "hash.h"
+
+#define BITS_IN_BYTE 8
+
+static uint64_t mixHash(uint64_t hash);
+static uint64_t rotateLeft(uint64_t value, int bits);
+
+/*
+	Function that hashes a null terminated string (FNV-1a).
+	Input: string - the string to hash.
+	Output: 32 bit hash of the string.
+*/
+unsigned int hashString(const char* string)
+{
+	unsigned int hash = FNV_OFFSET_BASIS;
+	const unsigned char* current = (const unsigned char*)string;
+
+	while (*current)
+	{
+		hash ^= *current;
+		hash *= FNV_PRIME;
+		current++;
+	}
+	return hash;
+}
+
+/*
+	Function that continues a 64 bit hash over a block of bytes, a word at a time.
+	Each word is mixed in with a full avalanche step, so every byte affects every bit of the result.
+	The bytes after the last whole word are mixed in as one word together with their count.
+	Blocks can be hashed one after another by passing the previous result, starting from FNV_OFFSET_BASIS_64.
+	Input: data - the bytes to hash.
+		   size - the number of bytes.
+		   hash - the hash of the bytes before this block.
+	Output: 64 bit hash of all the bytes so far.
+*/
+uint64_t hashBytes(const void* data, size_t size, uint64_t hash)
+{
+	const unsigned char* current = (const unsigned char*)data;
+	uint64_t word = 0;
+	size_t i = 0;
+
+	for (; size >= sizeof(uint64_t); size -= sizeof(uint64_t))
+	{
+		memcpy(&word, current, sizeof(uint64_t));
+		hash = mixHash(hash ^ word);
+		current += sizeof(uint64_t);
+	}
+	if (size)
+	{
+		word = (uint64_t)size << HASH_TAIL_LENGTH_SHIFT;
+		for (i = 0; i < size; i++)
+		{
+			word |= (uint64_t)current[i] << (i * BITS_IN_BYTE);
+		}
+		hash = mixHash(hash ^ word);
+	}
+	return hash;
+}
+
+/*
+	Function that hashes a block of bytes with a 64 bit hash unrelated to hashBytes (xxHash style rounds),
+	so data whose hashBytes collides can still be told apart by this one.
+	Input: data - the bytes to hash.
+		   size - the number of bytes.
+	Output: 64 bit hash of the bytes.
+*/
+uint64_t hashBytesAlternate(const void* data, size_t size)
+{
+	const unsigned char* current = (const unsigned char*)data;
+	uint64_t hash = ALTERNATE_HASH_SEED ^ (uint64_t)size;
+	uint64_t word = 0;
+	size_t i = 0;
+
+	for (; size >= sizeof(uint64_t); size -= sizeof(uint64_t))
+	{
+		memcpy(&word, current, sizeof(uint64_t));
+		hash = rotateLeft(hash + word * ALTERNATE_HASH_PRIME_2, ALTERNATE_HASH_ROTATION) * ALTERNATE_HASH_PRIME_1;
+		current += sizeof(uint64_t);
+	}
+	word = 0;
+	for (i = 0; i < size; i++)
+	{
+		word |= (uint64_t)current[i] << (i * BITS_IN_BYTE);
+	}
+	hash = rotateLeft(hash + word * ALTERNATE_HASH_PRIME_2, ALTERNATE_HASH_ROTATION) * ALTERNATE_HASH_PRIME_1;
+	return mixHash(hash);
+}
+
+/*
+	Spreads every bit of the hash over all of its bits (the MurmurHash3 finalizer).
+*/
+static uint64_t mixHash(uint64_t hash)
+{
+	hash ^= hash >> HASH_MIX_SHIFT;
+	hash *= HASH_MIX_MULTIPLIER_1;
+	hash ^= hash >> HASH_MIX_SHIFT;
+	hash *= HASH_MIX_MULTIPLIER_2;
+	hash ^= hash >> HASH_MIX_SHIFT;
+	return hash;
+}
+
+static uint64_t rotateLeft(uint64_t value, int bits)
+{
+	return (value << bits) | (value >> (BITS_IN_BYTE * sizeof(uint64_t) - bits));
+}
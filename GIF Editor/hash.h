@@ -0,0 +1,31 @@
+/*********************************
+*		GIF EDITOR PROJECT       *
+*    Hash Functions Declaration  *
+**********************************/
+
+#ifndef HASHH
+#define HASHH
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define FNV_OFFSET_BASIS 2166136261u
+#define FNV_PRIME 16777619u
+#define FNV_OFFSET_BASIS_64 14695981039346656037ull
+#define FNV_PRIME_64 1099511628211ull
+#define HASH_MIX_SHIFT 33
+#define HASH_MIX_MULTIPLIER_1 0xFF51AFD7ED558CCDull
+#define HASH_MIX_MULTIPLIER_2 0xC4CEB9FE1A85EC53ull
+#define HASH_TAIL_LENGTH_SHIFT 56
+#define ALTERNATE_HASH_SEED 0x27D4EB2F165667C5ull
+#define ALTERNATE_HASH_PRIME_1 0x9E3779B185EBCA87ull
+#define ALTERNATE_HASH_PRIME_2 0xC2B2AE3D27D4EB4Full
+#define ALTERNATE_HASH_ROTATION 31
+
+unsigned int hashString(const char* string);
+
+uint64_t hashBytes(const void* data, size_t size, uint64_t hash);
+
+uint64_t hashBytesAlternate(const void* data, size_t size);
+
+#endif
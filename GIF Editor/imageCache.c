@@ -0,0 +1,434 @@
+/*********************************
+*		GIF EDITOR PROJECT       *
+*          Image Cache           *
+**********************************/
+
+#define _CRT_SECURE_NO_WARNINGS
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <opencv2/imgcodecs/imgcodecs_c.h>
+#include "imageCache.h"
+#include "hash.h"
+
+// What decoding a frame's image for the cache needs
+typedef struct FrameRequest
+{
+	ImageCache*	cache;
+	const Frame*	frame;
+} FrameRequest;
+
+static IplImage* decodeFrameRequest(void* argument, MappedFile* mapping);
+static IplImage* applyFrameEffects(void* argument, MappedFile* mapping);
+static void* allocateOrExit(size_t size);
+static ImageCacheEntry* findEntry(const ImageCache* cache, const char* key);
+static void unlinkFromLru(ImageCache* cache, ImageCacheEntry* entry);
+static void linkAsNewest(ImageCache* cache, ImageCacheEntry* entry);
+static void removeFromBucket(ImageCache* cache, ImageCacheEntry* entry);
+static void growBuckets(ImageCache* cache);
+static void evictToBudget(ImageCache* cache);
+static void freeEntry(ImageCacheEntry* entry);
+
+/*
+	Function that creates an empty image cache.
+	Input: budgetBytes - the maximum amount of decoded image memory to keep once images are released.
+	Output: pointer to the new ImageCache.
+*/
+ImageCache* createImageCache(size_t budgetBytes)
+{
+	ImageCache* cache = (ImageCache*)allocateOrExit(sizeof(ImageCache));
+
+	initMutex(&cache->lock);
+	initCondition(&cache->imageDecoded);
+	cache->store = NULL;
+	cache->bucketCount = IMAGE_CACHE_INITIAL_BUCKETS;
+	cache->buckets = (ImageCacheEntry**)calloc(cache->bucketCount, sizeof(ImageCacheEntry*));
+	if (!cache->buckets)
+	{
+		printf("Memory allocation failed!\n");
+		exit(MEMORY_ALLOCATION_ERROR_CODE);
+	}
+	cache->entryCount = 0;
+	cache->newest = NULL;
+	cache->oldest = NULL;
+	cache->budgetBytes = budgetBytes;
+	cache->usedBytes = 0;
+	cache->hits = 0;
+	cache->misses = 0;
+	cache->evictions = 0;
+
+	return cache;
+}
+
+/*
+	Function that frees an image cache and every image inside it.
+	Input: cache - pointer to the ImageCache* to free.
+	Output: None.
+*/
+void freeImageCache(ImageCache** cache)
+{
+	ImageCacheEntry* current = NULL;
+	ImageCacheEntry* next = NULL;
+
+	if (!*cache)
+	{
+		return;
+	}
+	current = (*cache)->newest;
+	while (current)
+	{
+		next = current->older;
+		freeEntry(current);
+		current = next;
+	}
+	free((*cache)->buckets);
+	destroyCondition(&(*cache)->imageDecoded);
+	destroyMutex(&(*cache)->lock);
+	free(*cache);
+	*cache = NULL;
+}
+
+/*
+	Function that makes the cache read frame images through a frame store, or stop when store is NULL.
+	It is attached before the cache is shared with other threads and must stay open until the cache is freed.
+	Input: cache - the image cache.
+		   store - the frame store, or NULL.
+	Output: None.
+*/
+void attachFrameStore(ImageCache* cache, FrameStore* store)
+{
+	cache->store = store;
+}
+
+/*
+	Function that returns the decoded image of a frame, decoding it only if it is not cached yet.
+	A frame with effects gets its image with the effects applied, made from the cached image without them.
+	The returned entry is pinned and will not be evicted until it is released.
+	Input: cache - the image cache.
+		   frame - the frame whose image is needed.
+	Output: pinned cache entry holding the image, or NULL if the image could not be decoded.
+*/
+ImageCacheEntry* acquireFrameImage(ImageCache* cache, const Frame* frame)
+{
+	FrameRequest request;
+	ImageCacheEntry* entry = NULL;
+	char* key = NULL;
+
+	request.cache = cache;
+	request.frame = frame;
+	if (!frame->effectCount)
+	{
+		return acquireCachedImage(cache, frame->imageKey, decodeFrameRequest, &request);
+	}
+	key = createEffectsKey(frame->imageKey, frame);
+	entry = acquireCachedImage(cache, key, applyFrameEffects, &request);
+	free(key);
+	return entry;
+}
+
+/*
+	Function that returns a cached image by its key, making it with the given function only if it is not cached yet.
+	Lets images that are not a frame's own image, like downscaled previews, share the cache and its budget.
+	The returned entry is pinned and will not be evicted until it is released.
+	Input: cache - the image cache.
+		   key - the key of the image, it must not collide with the paths of frames.
+		   decode - makes the image when it is missing, called without the cache's lock.
+					It sets the mapping it was given when the image's pixels point into a mapped file.
+		   argument - handed to decode.
+	Output: pinned cache entry holding the image, or NULL if decode did not return an image.
+*/
+ImageCacheEntry* acquireCachedImage(ImageCache* cache, const char* key, DecodeImageFunction decode, void* argument)
+{
+	ImageCacheEntry* entry = NULL;
+	IplImage* image = NULL;
+	unsigned int bucket = 0;
+	size_t keyLength = 0;
+
+	lockMutex(&cache->lock);
+	entry = findEntry(cache, key);
+	while (entry && !entry->image) // another thread is decoding the same image, its result is shared
+	{
+		waitCondition(&cache->imageDecoded, &cache->lock);
+		entry = findEntry(cache, key);
+	}
+	if (entry)
+	{
+		cache->hits++;
+		unlinkFromLru(cache, entry);
+		linkAsNewest(cache, entry);
+		entry->pinCount++;
+		unlockMutex(&cache->lock);
+		return entry;
+	}
+	cache->misses++;
+
+	// The entry is added before decoding, without an image and outside of the LRU list, so it is never evicted
+	entry = (ImageCacheEntry*)allocateOrExit(sizeof(ImageCacheEntry));
+	keyLength = strlen(key);
+	entry->key = (char*)allocateOrExit(sizeof(char) * (keyLength + INC));
+	strcpy(entry->key, key);
+	entry->image = NULL;
+	entry->mapping.data = NULL;
+	entry->bytes = 0;
+	entry->pinCount = 1;
+	entry->newer = NULL;
+	entry->older = NULL;
+	bucket = hashString(entry->key) & (cache->bucketCount - 1);
+	entry->nextInBucket = cache->buckets[bucket];
+	cache->buckets[bucket] = entry;
+	cache->entryCount++;
+	if (cache->entryCount > cache->bucketCount * IMAGE_CACHE_MAX_LOAD_FACTOR)
+	{
+		growBuckets(cache);
+	}
+	unlockMutex(&cache->lock);
+
+	image = decode(argument, &entry->mapping);
+
+	lockMutex(&cache->lock);
+	if (!image)
+	{
+		removeFromBucket(cache, entry);
+		cache->entryCount--;
+		freeEntry(entry);
+		entry = NULL;
+	}
+	else
+	{
+		entry->image = image;
+		entry->bytes = sizeof(IplImage) + (size_t)image->imageSize;
+		linkAsNewest(cache, entry);
+		cache->usedBytes += entry->bytes;
+		evictToBudget(cache);
+	}
+	broadcastCondition(&cache->imageDecoded);
+	unlockMutex(&cache->lock);
+
+	return entry;
+}
+
+/*
+	Function that unpins an image acquired with acquireFrameImage, letting it be evicted when over budget.
+	Input: cache - the image cache.
+		   entry - pointer to the acquired entry, set to NULL after release.
+	Output: None.
+*/
+void releaseCachedImage(ImageCache* cache, ImageCacheEntry** entry)
+{
+	if (!*entry)
+	{
+		return;
+	}
+	lockMutex(&cache->lock);
+	(*entry)->pinCount--;
+	evictToBudget(cache);
+	unlockMutex(&cache->lock);
+	*entry = NULL;
+}
+
+/*
+	Function that prints the hit and miss counters of the cache, used to size the budget.
+	Input: cache - the image cache.
+	Output: None.
+*/
+void printImageCacheStats(ImageCache* cache)
+{
+	unsigned long lookups = 0;
+
+	lockMutex(&cache->lock);
+	lookups = cache->hits + cache->misses;
+	printf("Image cache: %lu hits, %lu misses (%.1f%% hit rate), %lu evictions\n",
+		cache->hits, cache->misses, lookups ? 100.0 * cache->hits / lookups : 0.0, cache->evictions);
+	printf("             %d images, %.1f MB used of %.1f MB budget\n",
+		cache->entryCount, cache->usedBytes / BYTES_IN_MEGABYTE, cache->budgetBytes / BYTES_IN_MEGABYTE);
+	unlockMutex(&cache->lock);
+}
+
+/*
+	Function that decodes a frame's image without going through a cache,
+	from the bytes embedded in its bundle, read in place without a copy, or else from its file.
+	Input: frame - the frame whose image is decoded.
+	Output: the new image, which the caller releases, or NULL if it could not be decoded.
+*/
+IplImage* decodeFrameImage(const Frame* frame)
+{
+	CvMat encoded;
+
+	if (frame->imageData)
+	{
+		encoded = cvMat(1, (int)frame->imageSize, CV_8UC1, (void*)frame->imageData);
+		return cvDecodeImage(&encoded, CV_LOAD_IMAGE_COLOR);
+	}
+	return cvLoadImage(frame->path, CV_LOAD_IMAGE_COLOR);
+}
+
+static IplImage* decodeFrameRequest(void* argument, MappedFile* mapping)
+{
+	FrameRequest* request = (FrameRequest*)argument;
+
+	mapping->data = NULL;
+	if (request->cache->store)
+	{
+		return loadFrameThroughStore(request->cache->store, request->frame, mapping);
+	}
+	return decodeFrameImage(request->frame);
+}
+
+/*
+	Applies a frame's effects to its image, which is decoded or found through the cache like a frame without effects.
+*/
+static IplImage* applyFrameEffects(void* argument, MappedFile* mapping)
+{
+	FrameRequest* request = (FrameRequest*)argument;
+	ImageCacheEntry* source = acquireCachedImage(request->cache, request->frame->imageKey, decodeFrameRequest, request);
+	IplImage* image = NULL;
+
+	mapping->data = NULL;
+	if (!source)
+	{
+		return NULL;
+	}
+	image = applyEffects(request->frame->effects, request->frame->effectCount, source->image, source->image->width, source->image->height);
+	releaseCachedImage(request->cache, &source);
+	return image;
+}
+
+static void* allocateOrExit(size_t size)
+{
+	void* memory = malloc(size);
+	if (!memory)
+	{
+		printf("Memory allocation failed!\n");
+		exit(MEMORY_ALLOCATION_ERROR_CODE);
+	}
+	return memory;
+}
+
+static ImageCacheEntry* findEntry(const ImageCache* cache, const char* key)
+{
+	ImageCacheEntry* current = cache->buckets[hashString(key) & (cache->bucketCount - 1)];
+
+	while (current && EQUAL_STRINGS_VALUE != strcmp(current->key, key))
+	{
+		current = current->nextInBucket;
+	}
+	return current;
+}
+
+static void unlinkFromLru(ImageCache* cache, ImageCacheEntry* entry)
+{
+	if (entry->newer)
+	{
+		entry->newer->older = entry->older;
+	}
+	else
+	{
+		cache->newest = entry->older;
+	}
+	if (entry->older)
+	{
+		entry->older->newer = entry->newer;
+	}
+	else
+	{
+		cache->oldest = entry->newer;
+	}
+	entry->newer = NULL;
+	entry->older = NULL;
+}
+
+static void linkAsNewest(ImageCache* cache, ImageCacheEntry* entry)
+{
+	entry->newer = NULL;
+	entry->older = cache->newest;
+	if (cache->newest)
+	{
+		cache->newest->newer = entry;
+	}
+	cache->newest = entry;
+	if (!cache->oldest)
+	{
+		cache->oldest = entry;
+	}
+}
+
+static void removeFromBucket(ImageCache* cache, ImageCacheEntry* entry)
+{
+	ImageCacheEntry** link = &cache->buckets[hashString(entry->key) & (cache->bucketCount - 1)];
+
+	while (*link != entry)
+	{
+		link = &(*link)->nextInBucket;
+	}
+	*link = entry->nextInBucket;
+}
+
+static void growBuckets(ImageCache* cache)
+{
+	int newCount = cache->bucketCount * 2;
+	ImageCacheEntry** newBuckets = (ImageCacheEntry**)calloc(newCount, sizeof(ImageCacheEntry*));
+	ImageCacheEntry* current = NULL;
+	unsigned int bucket = 0;
+	int i = 0;
+
+	if (!newBuckets)
+	{
+		printf("Memory allocation failed!\n");
+		exit(MEMORY_ALLOCATION_ERROR_CODE);
+	}
+	// Walks the chains rather than the LRU list, which does not hold the images still being decoded
+	for (i = 0; i < cache->bucketCount; i++)
+	{
+		while (cache->buckets[i])
+		{
+			current = cache->buckets[i];
+			cache->buckets[i] = current->nextInBucket;
+			bucket = hashString(current->key) & (newCount - 1);
+			current->nextInBucket = newBuckets[bucket];
+			newBuckets[bucket] = current;
+		}
+	}
+	free(cache->buckets);
+	cache->buckets = newBuckets;
+	cache->bucketCount = newCount;
+}
+
+/*
+	Evicts unpinned entries from the least recently used end until the cache fits its budget.
+	Pinned entries are skipped, so the cache may stay over budget while images are on screen.
+*/
+static void evictToBudget(ImageCache* cache)
+{
+	ImageCacheEntry* current = cache->oldest;
+	ImageCacheEntry* newer = NULL;
+
+	while (current && cache->usedBytes > cache->budgetBytes)
+	{
+		newer = current->newer;
+		if (!current->pinCount)
+		{
+			unlinkFromLru(cache, current);
+			removeFromBucket(cache, current);
+			cache->usedBytes -= current->bytes;
+			cache->entryCount--;
+			cache->evictions++;
+			freeEntry(current);
+		}
+		current = newer;
+	}
+}
+
+static void freeEntry(ImageCacheEntry* entry)
+{
+	if (entry->mapping.data)
+	{
+		cvReleaseImageHeader(&entry->image);
+		unmapFile(&entry->mapping);
+	}
+	else
+	{
+		cvReleaseImage(&entry->image);
+	}
+	free(entry->key);
+	free(entry);
+}
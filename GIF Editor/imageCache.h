@@ -0,0 +1,75 @@
+/*********************************
+*		GIF EDITOR PROJECT       *
+*   Image Cache Declaration      *
+**********************************/
+
+#ifndef IMAGECACHEH
+#define IMAGECACHEH
+#define CV_IGNORE_DEBUG_BUILD_GUARD
+
+#include <stddef.h>
+#include <opencv2/core/core_c.h>
+#include "linkedList.h"
+#include "platform.h"
+#include "frameStore.h"
+#include "effects.h"
+
+#define IMAGE_CACHE_BUDGET_BYTES (256u * 1024u * 1024u)
+#define IMAGE_CACHE_INITIAL_BUCKETS 64
+#define IMAGE_CACHE_MAX_LOAD_FACTOR 2
+#define BYTES_IN_MEGABYTE (1024.0 * 1024.0)
+
+typedef IplImage* (*DecodeImageFunction)(void* argument, MappedFile* mapping);
+
+// Decoded image entry, kept in a hash bucket chain and in the LRU list.
+// mapping is the stored frame the image's pixels are mapped from, its data is NULL when the image owns its pixels.
+typedef struct ImageCacheEntry
+{
+	char*		key;
+	IplImage*	image;
+	MappedFile	mapping;
+	size_t		bytes;
+	int		pinCount;
+	struct ImageCacheEntry* nextInBucket;
+	struct ImageCacheEntry* newer;
+	struct ImageCacheEntry* older;
+} ImageCacheEntry;
+
+// Memory budgeted cache of decoded images, evicting the least recently used first.
+// Safe to share between threads, images are decoded outside of the lock
+// and threads asking for an image that is being decoded wait for it instead of decoding it again.
+// With a frame store attached, frame images are mapped from it instead of decoded when they were decoded before.
+typedef struct ImageCache
+{
+	FrameStore*		store;
+	Mutex			lock;
+	Condition		imageDecoded;
+	ImageCacheEntry**	buckets;
+	int			bucketCount;
+	int			entryCount;
+	ImageCacheEntry*	newest;
+	ImageCacheEntry*	oldest;
+	size_t		budgetBytes;
+	size_t		usedBytes;
+	unsigned long	hits;
+	unsigned long	misses;
+	unsigned long	evictions;
+} ImageCache;
+
+ImageCache* createImageCache(size_t budgetBytes);
+
+void freeImageCache(ImageCache** cache);
+
+void attachFrameStore(ImageCache* cache, FrameStore* store);
+
+ImageCacheEntry* acquireFrameImage(ImageCache* cache, const Frame* frame);
+
+ImageCacheEntry* acquireCachedImage(ImageCache* cache, const char* key, DecodeImageFunction decode, void* argument);
+
+IplImage* decodeFrameImage(const Frame* frame);
+
+void releaseCachedImage(ImageCache* cache, ImageCacheEntry** entry);
+
+void printImageCacheStats(ImageCache* cache);
+
+#endif
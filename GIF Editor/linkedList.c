@@ -1,445 +1,627 @@
-#define _CRT_SECURE_NO_WARNINGS
-#include <stdio.h>
-#include <stdlib.h>
-#include <string.h>
-#include "linkedList.h"
-
-/*
-	Function that creates a Frame and returns a pointer to it. 
-	Input: name - the name of the frame, 
-		   duration - the duration of the frame (milliseconds),
-		   path - the path to the frame.
-	Output: pointer to a Frame struct with the given parameters. 
-
-*/
-Frame* createFrame(char* name, unsigned int duration, char* path)
-{
-	Frame* frame = NULL;
-	int length = 0;
-
-	frame = (Frame*)malloc(sizeof(Frame));
-	if (!frame)
-	{
-		printf("Memory allocation failed!\n"); 
-		exit(MEMORY_ALLOCATION_ERROR_CODE);
-	}
-
-	length = strlen(name);
-	frame->name = (char*)malloc(sizeof(char) * (length + INC));
-	if (!frame->name)
-	{
-		printf("Memory allocation failed!\n");
-		exit(MEMORY_ALLOCATION_ERROR_CODE);
-	}
-	strcpy(frame->name, name);
-	frame->name[length] = NULL_CHAR;
-
-	frame->duration = duration;
-
-	length = strlen(path);
-	frame->path = (char*)malloc(sizeof(char) * (length + INC));
-	if (!frame->path)
-	{
-		printf("Memory allocation failed!\n");
-		exit(MEMORY_ALLOCATION_ERROR_CODE);
-	}
-	strcpy(frame->path, path);
-	frame->path[length] = NULL_CHAR;
-
-	return frame; 
-}
-
-/*
-	Function that frees the allocated memory for a Frame struct.
-	Input: frame - pointer to a frame to free.
-	Output: None.
-*/
-void freeFrame(Frame* frame)
-{
-	if (!frame)
-	{
-		return; 
-	}
-	free(frame->name); 
-	free(frame->path);
-	free(frame); 
-	frame = NULL;
-}
-
-/*
-	Function that creates FrameNode struct and returns pointer to it.
-	Input: frame - pointer to Frame struct that will be the frame property of the FrameNode.
-	Output: pointer to a FrameNode strcut with the given frame property and NULL as next FrameNode*.
-*/
-FrameNode* createFrameNode(Frame* frame)
-{
-	FrameNode* frameNode = NULL; 
-	if (!frame)
-	{
-		return NULL;
-	}
-
-	frameNode = (FrameNode*)malloc(sizeof(FrameNode));
-	if (!frameNode)
-	{
-		printf("Allocation memory failed!\n");
-		exit(MEMORY_ALLOCATION_ERROR_CODE);
-	}
-
-	frameNode->frame = frame;
-	frameNode->next = NULL; 
-	return frameNode;
-}
-
-
-/*
-	Function that frees allocated memory for single FrameNode*.
-	Input: node - pointer to FrameNode* to free.
-	Output: None.
-*/
-void freeFrameNode(FrameNode** node)
-{
-	if (!*node)
-	{
-		return;
-	}
-	freeFrame((*node)->frame);
-	(*node)->next = NULL;
-	free(*node);
-	*node = NULL;
-}
-
-/*
-	Function that frees allocated memory for FrameNode* list.
-	Input: head - pointer to a head node of FrameNode* list.
-	Output: None.
-*/
-void freeFrameNodeList(FrameNode** head)
-{
-	FrameNode* current = *head;
-	FrameNode* next = NULL;
-
-	while (current)
-	{
-		next = current->next;
-		freeFrameNode(&current);
-		current = next;
-	}
-
-	*head = NULL;
-}
-
-/**
-* Function that returns the length of FrameNode* list. 
-* Input: head - head node of FrameNode* list. 
-* Output: length of the list. 
-*/
-int frameNodeListLength(FrameNode* head)
-{
-	FrameNode* current = head;
-	int counter = 0; 
-	while (current)
-	{
-		counter++;
-		current = current->next;
-	}
-	return counter;
-}
-
-/*
-	Function that inserts created FrameNode* created with given Frame* into FrameNode* list.
-	Input: head - pointer to FrameNode* list.
-	       frame - frame to set as property for the new FrameNode* that will be added to the list. 
-	Output: None.
-*/
-void insertFrameToList(FrameNode** head, Frame* frame)
-{
-	FrameNode* frameToAdd = createFrameNode(frame); 
-	FrameNode* current = *head; 
-
-	if (!*head)
-	{
-		*head = frameToAdd;
-		return; 
-	}
-	while (current->next)
-	{
-		current = current->next; 
-	}
-	current->next = frameToAdd;
-}
-
-/*
-	Function that checks if there is FrameNode* with a given name in a FrameNode* list.
-	Input: head - FrameNode* list head.
-		   name - the name of the frame to find.
-		   notFoundMessage - the message that will be printed if the frame does not exist in the list. 
-	Output: None.
-*/
-int isFrameNameAlreadyExistsInList(FrameNode* head, char* name, char* notFoundMessage)
-{
-	FrameNode* current = head;
-	int count = 1;
-
-	while (current)
-	{
-		if (EQUAL_STRINGS_VALUE == strcmp(current->frame->name, name))
-		{
-			return count;
-		}
-		current = current->next;
-		count++;
-	}
-	if (notFoundMessage)
-	{
-		printf(NOT_FOUND_MESSAGE);
-	}
-	return NOT_FOUND;
-}
-
-/*
-	Function that searches for FrameNode* in FrameNode* list with frame property with given name and returns pointer to it. 
-	Input: head - head node inside FrameNode* list.
-		   frameName - the name of the frame to search for. 
-	Output: FrameNode* of the frame found, or NULL if there is no FrameNode* with frame property with frameName.
-*/
-FrameNode* findFrameNodeByFrameNameInList(FrameNode* head, char* frameName)
-{
-	FrameNode* current = head; 
-	while (current)
-	{
-		if (EQUAL_STRINGS_VALUE == strcmp(current->frame->name, frameName))
-		{
-			return current; 
-		}
-		current = current->next; 
-	}
-
-	return NULL;
-}
-
-/*
-	Function that removes a FrameNode* from a FrameNode* list by frame's property name.
-	Input: head - pointer to FrameNode* list. 
-		   frameName - the FrameNode* that has this frame name and has to be deleted.
-	Output: None.
-*/
-void removeFrameNodeFromList(FrameNode** head, char* frameName)
-{
-	FrameNode* current = *head; 
-	FrameNode* temp = NULL;
-	if (!*head)
-	{
-		return;
-	}
-	else if (EQUAL_STRINGS_VALUE == strcmp((*head)->frame->name, frameName))
-	{
-		*head = (*head)->next;
-		free(current);
-		return;
-	}
-	while (current->next && EQUAL_STRINGS_VALUE != strcmp(current->next->frame->name, frameName))
-	{
-		current = current->next;
-	}
-	if (current->next)
-	{
-		temp = current->next;
-		current->next = temp->next;
-		free(temp);
-		return;
-	}
-	printf("No such frame with name %s\n", frameName);
-}
-
-/*
-	Function that deletes the last node of a FrameNode* list. 
-	Input: head - pointer to FrameNode* list head node.
-	Output: None.
-*/
-void deleteLastNode(FrameNode** head)
-{
-	FrameNode* current = *head;
-	FrameNode* previous = NULL;
-
-	if (!*head)
-	{
-		printf("List is empty. Unable to delete last node.\n");
-		return;
-	}
-
-	if (!(*head)->next)
-	{
-		free((*head)->frame);
-		free(*head);
-		*head = NULL;
-		return;
-	}
-
-	while (current->next != NULL)
-	{
-		previous = current;
-		current = current->next;
-	}
-
-	free(current->frame);
-	free(current);
-	previous->next = NULL;
-}
-
-/*
-	Function that changes a FrameNode* duration in a FrameNode* list by frame's property name and given new duration value.
-	Input: head - pointer to FrameNode* list.
-		   frameName - the FrameNode* that has this frame name to change its duration.
-		   newDuration - the new duration to set to the FrameNode* with given frame name. 
-	Output: None.
-*/
-void changeFrameNodeDurationInList(FrameNode* head, char* frameName, unsigned int newDuration)
-{
-	FrameNode* node = findFrameNodeByFrameNameInList(head, frameName);
-	if (node)
-	{
-		node->frame->duration = newDuration;
-	}
-}
-
-/*
-	Function that changes the duration of all FrameNode* in the list.
-	Input: head - head node of FrameNode* list. 
-		   newDuration - the duration to set to all FrameNode* in the list. 
-	Output: None.
-*/
-void changeAllFrameNodesDurationsInList(FrameNode* head, unsigned int newDuration)
-{
-	FrameNode* current = head; 
-	while (current)
-	{
-		current->frame->duration = newDuration;
-		current = current->next; 
-	}
-}
-
-/*
-	Function that prints FrameNode* list.
-	Input: head - FrameNode* list head.
-	Output: None.
-*/
-void printFrameNodeList(FrameNode* head)
-{
-	FrameNode* current = head;
-	printf("                Name            Duration        Path\n");
-	while (current)
-	{
-		printf("                %s               %u ms        %s\n", current->frame->name, current->frame->duration, current->frame->path);
-		current = current->next;
-	}
-	printf("\n");
-}
-
-/**
-	Function that inserts a given frame to FrameNode* list in a given k position.
-	Input: head - pointer to FrameNode* list head node.
-		   frame - frame to insert.
-		   k - index where to insert.
-	Output: None.
-*/
-void insertFrameAtPositionK(FrameNode** head, Frame* frame, int k)
-{
-	FrameNode* current = *head; 
-	FrameNode* toAdd = createFrameNode(frame); 
-	int i = 1;
-
-	if (FIRST_NODE_INDEX == k)
-	{
-		toAdd->next = *head; 
-		*head = toAdd; 
-		return;
-	}
-	for (i = 1; current && i < k; i++)
-	{
-		current = current->next;
-	}
-	if (current)
-	{
-		current->next = toAdd;
-	}
-}
-
-/**
-	Function that deletes FrameNode* in FrameNode* list in a given k position.
-	Input: head - pointer to FrameNode* list head node.
-		   k - index where to delete.
-	Output: None.
-*/
-void deleteFrameAtPositionK(FrameNode** head, int k)
-{
-	FrameNode* current = *head;
-	FrameNode* temp = NULL;
-	int i = 1; 
-
-	if (FIRST_NODE_INDEX == k)
-	{
-		*head = (*head)->next;
-		freeFrameNode(&current);
-		return;
-	}
-
-	for (i = 1; current && i < k; i++)
-	{
-		temp = current; 
-		current = current->next; 
-	}
-
-	if (current->next)
-	{
-		temp->next = current->next;
-	}
-	else
-	{
-		temp->next = NULL;
-	}
-	if (current)
-	{
-		freeFrameNode(&current);
-	}
-}
-
-/*
-	Function that changes a FrameNode* position in a FrameNode* list by frame's property name and given position.
-	Input: head - pointer to FrameNode* list.
-		   frameName - the FrameNode* that has this frame name and has to be changed in position.
-		   newPosition - the new position of the FrameNode* in the list.
-		   NOTE: the indexing starts from 1 to n, where n is the length of the list.
-	Output: None.
-*/
-void changeFrameNodePosition(FrameNode** head, char* frameName, int newPosition)
-{
-	Frame* saveFrame = NULL;
-	int listLength = frameNodeListLength(*head); 
-	int currentIndex = isFrameNameAlreadyExistsInList(*head, frameName, NOT_FOUND_MESSAGE);
-	FrameNode* toCopyData = findFrameNodeByFrameNameInList(*head, frameName);
-	
-	saveFrame = (Frame*)malloc(sizeof(Frame));
-	if (!saveFrame)
-	{
-		printf("Memory allocation error!\n");
-		exit(MEMORY_ALLOCATION_ERROR_CODE);
-	}
-
-	saveFrame = createFrame(toCopyData->frame->name, toCopyData->frame->duration, toCopyData->frame->path);
-
-	if (!currentIndex)
-	{
-		return;
-	}
-	if (currentIndex == newPosition)
-	{
-		return;
-	}
-	if (currentIndex < newPosition)
-	{
-		newPosition--;
-	}
-	deleteFrameAtPositionK(head, currentIndex);
-	insertFrameAtPositionK(head, saveFrame, newPosition);
-}
\ No newline at end of file
+#define _CRT_SECURE_NO_WARNINGS
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "linkedList.h"
+
+static void reserveFrames(FrameList* list, int required);
+static void renumberFrames(FrameList* list, int first, int last);
+static void indexAllFrames(FrameList* list);
+static void indexTimeline(FrameList* list);
+
+/*
+	Function that creates a Frame inside a FrameList's arena and returns a pointer to it.
+	The frame is owned by the list and freed together with it.
+	Input: list - the FrameList that will own the frame,
+		   name - the name of the frame, 
+		   duration - the duration of the frame (milliseconds),
+		   path - the path to the frame, stored once for all frames that share it.
+	Output: pointer to a Frame struct with the given parameters. 
+
+*/
+Frame* createFrame(FrameList* list, char* name, unsigned int duration, char* path)
+{
+	Frame* frame = (Frame*)arenaAllocate(&list->arena, sizeof(Frame));
+
+	frame->name = arenaCopyString(&list->arena, name);
+	frame->duration = duration;
+	frame->path = internString(&list->paths, path);
+	frame->imageData = NULL;
+	frame->imageSize = 0;
+	frame->imageKey = frame->path;
+	frame->effects = NULL;
+	frame->effectCount = 0;
+	frame->index = 0;
+
+	return frame; 
+}
+
+/*
+	Function that creates an empty FrameList and returns pointer to it.
+	Input: None.
+	Output: pointer to a FrameList with no frames and an empty name index.
+*/
+FrameList* createFrameList(void)
+{
+	FrameList* list = (FrameList*)malloc(sizeof(FrameList));
+	if (!list)
+	{
+		printf("Memory allocation failed!\n");
+		exit(MEMORY_ALLOCATION_ERROR_CODE);
+	}
+	list->capacity = FRAME_LIST_INITIAL_CAPACITY;
+	list->frames = (Frame**)malloc(sizeof(Frame*) * list->capacity);
+	if (!list->frames)
+	{
+		printf("Memory allocation failed!\n");
+		exit(MEMORY_ALLOCATION_ERROR_CODE);
+	}
+	list->length = 0;
+	initFrameIndex(&list->names);
+	list->namesIndexed = TRUE;
+	initTimelineIndex(&list->timeline);
+	initArena(&list->arena);
+	initStringPool(&list->paths, &list->arena);
+	list->source.context = NULL;
+	list->source.path = NULL;
+	list->source.readFrame = NULL;
+	list->source.close = NULL;
+	list->canvas.width = NO_CANVAS;
+	list->canvas.height = NO_CANVAS;
+	list->canvas.fit = NO_CANVAS;
+	return list;
+}
+
+/*
+	Function that frees allocated memory for FrameList and all of its frames in one shot.
+	Input: list - pointer to the FrameList* to free.
+	Output: None.
+*/
+void freeFrameNodeList(FrameList** list)
+{
+	if (!*list)
+	{
+		return;
+	}
+	if ((*list)->source.close)
+	{
+		(*list)->source.close((*list)->source.context);
+	}
+	freeStringPool(&(*list)->paths);
+	freeArena(&(*list)->arena);
+	freeFrameIndex(&(*list)->names);
+	freeTimelineIndex(&(*list)->timeline);
+	free((*list)->frames);
+	free(*list);
+	*list = NULL;
+}
+
+/*
+	Function that gives an empty FrameList frames that are read from a source only when they are needed.
+	Nothing is read here, so attaching costs the same for any number of frames.
+	Input: list - an empty FrameList.
+		   source - the source of the frames, the list closes it when it is freed or released.
+		   frameCount - the number of frames in the source.
+	Output: None.
+*/
+void attachFrameSource(FrameList* list, const FrameSource* source, int frameCount)
+{
+	if (frameCount > list->capacity)
+	{
+		free(list->frames);
+		list->capacity = frameCount;
+		list->frames = (Frame**)calloc(list->capacity, sizeof(Frame*));
+		if (!list->frames)
+		{
+			printf("Memory allocation failed!\n");
+			exit(MEMORY_ALLOCATION_ERROR_CODE);
+		}
+	}
+	else
+	{
+		memset(list->frames, 0, sizeof(Frame*) * frameCount);
+	}
+	list->length = frameCount;
+	list->namesIndexed = !frameCount;
+	list->timeline.valid = !frameCount;
+	list->source = *source;
+}
+
+/*
+	Function that reads every frame still in the list's source, copies their strings and embedded images into the list
+	and closes the source. Needed before the file a list was read from is written over.
+	Input: list - the FrameList.
+	Output: None.
+*/
+void releaseFrameSource(FrameList* list)
+{
+	Frame* frame = NULL;
+	unsigned char* imageData = NULL;
+	int i = 0;
+
+	if (!list->source.close)
+	{
+		return;
+	}
+	for (i = 0; i < list->length; i++)
+	{
+		frame = getFrameAtIndex(list, i);
+		frame->name = arenaCopyString(&list->arena, frame->name);
+		frame->path = internString(&list->paths, frame->path);
+		if (frame->imageData)
+		{
+			imageData = (unsigned char*)arenaAllocate(&list->arena, frame->imageSize);
+			memcpy(imageData, frame->imageData, frame->imageSize);
+			frame->imageData = imageData;
+			frame->imageKey = arenaCopyString(&list->arena, frame->imageKey);
+		}
+		else
+		{
+			frame->imageKey = frame->path;
+		}
+		setFrameEffects(list, frame, frame->effects, frame->effectCount);
+	}
+	list->source.close(list->source.context);
+	list->source.context = NULL;
+	list->source.path = NULL;
+	list->source.readFrame = NULL;
+	list->source.close = NULL;
+}
+
+/**
+* Function that returns the length of the FrameList. 
+* Input: list - the FrameList. 
+* Output: length of the list. 
+*/
+int frameNodeListLength(FrameList* list)
+{
+	return list->length;
+}
+
+/*
+	Function that returns the frame at a given array index, for walking the list in order.
+	A frame that was not read from the list's source yet is read now.
+	Input: list - the FrameList.
+		   index - index of the frame, from 0 to length - 1.
+	Output: the frame at that index.
+*/
+Frame* getFrameAtIndex(FrameList* list, int index)
+{
+	if (!list->frames[index])
+	{
+		list->frames[index] = (Frame*)arenaAllocate(&list->arena, sizeof(Frame));
+		list->source.readFrame(list->source.context, index, list->frames[index]);
+		list->frames[index]->index = index;
+	}
+	return list->frames[index];
+}
+
+/*
+	Function that appends a Frame* to the end of the FrameList.
+	Input: list - the FrameList.
+	       frame - frame to add. 
+	Output: None.
+*/
+void insertFrameToList(FrameList* list, Frame* frame)
+{
+	if (!frame)
+	{
+		return;
+	}
+	indexAllFrames(list);
+	reserveFrames(list, list->length + INC);
+	list->frames[list->length] = frame;
+	frame->index = list->length;
+	list->length++;
+	addToFrameIndex(&list->names, frame);
+	if (list->timeline.valid)
+	{
+		appendTimelineDuration(&list->timeline, frame->duration);
+	}
+}
+
+/*
+	Function that checks if there is a Frame with a given name in the FrameList.
+	Input: list - the FrameList.
+		   name - the name of the frame to find.
+		   notFoundMessage - the message that will be printed if the frame does not exist in the list. 
+	Output: the position of the frame (starting from 1), or NOT_FOUND.
+*/
+int isFrameNameAlreadyExistsInList(FrameList* list, char* name, char* notFoundMessage)
+{
+	Frame* frame = findFrameNodeByFrameNameInList(list, name);
+
+	if (!frame)
+	{
+		if (notFoundMessage)
+		{
+			printf(NOT_FOUND_MESSAGE);
+		}
+		return NOT_FOUND;
+	}
+	return frame->index + FIRST_NODE_INDEX;
+}
+
+/*
+	Function that searches for a Frame in the FrameList by its name and returns pointer to it. 
+	Input: list - the FrameList.
+		   frameName - the name of the frame to search for. 
+	Output: the Frame* found, or NULL if there is no frame with frameName.
+*/
+Frame* findFrameNodeByFrameNameInList(FrameList* list, char* frameName)
+{
+	indexAllFrames(list);
+	return findInFrameIndex(&list->names, frameName);
+}
+
+/*
+	Function that removes a Frame from the FrameList by its name.
+	Input: list - the FrameList. 
+		   frameName - the name of the frame that has to be deleted.
+	Output: None.
+*/
+void removeFrameNodeFromList(FrameList* list, char* frameName)
+{
+	Frame* frame = findFrameNodeByFrameNameInList(list, frameName);
+
+	if (!frame)
+	{
+		printf("No such frame with name %s\n", frameName);
+		return;
+	}
+	deleteFrameAtPositionK(list, frame->index + FIRST_NODE_INDEX);
+}
+
+/*
+	Function that deletes the last frame of the FrameList. 
+	Input: list - the FrameList.
+	Output: None.
+*/
+void deleteLastNode(FrameList* list)
+{
+	if (!list->length)
+	{
+		printf("List is empty. Unable to delete last node.\n");
+		return;
+	}
+	deleteFrameAtPositionK(list, list->length);
+}
+
+/*
+	Function that changes a frame's duration in the FrameList by the frame's name and given new duration value.
+	The frame and its index are found in O(1) and the timeline index is updated in O(log n).
+	Input: list - the FrameList.
+		   frameName - the name of the frame to change its duration.
+		   newDuration - the new duration to set to the frame with given frame name. 
+	Output: None.
+*/
+void changeFrameNodeDurationInList(FrameList* list, char* frameName, unsigned int newDuration)
+{
+	Frame* frame = findFrameNodeByFrameNameInList(list, frameName);
+	if (frame)
+	{
+		changeFrameDurationAtIndex(list, frame->index, newDuration);
+	}
+}
+
+/*
+	Function that changes the duration of all frames in the list.
+	Input: list - the FrameList. 
+		   newDuration - the duration to set to all frames in the list. 
+	Output: None.
+*/
+void changeAllFrameNodesDurationsInList(FrameList* list, unsigned int newDuration)
+{
+	int i = 0;
+
+	for (i = 0; i < list->length; i++)
+	{
+		getFrameAtIndex(list, i)->duration = newDuration;
+	}
+	setUniformTimelineDuration(&list->timeline, list->length, newDuration);
+}
+
+/*
+	Function that prints the FrameList.
+	Input: list - the FrameList.
+	Output: None.
+*/
+void printFrameNodeList(FrameList* list)
+{
+	Frame* frame = NULL;
+	int i = 0;
+
+	printf("                Name            Duration        Path\n");
+	for (i = 0; i < list->length; i++)
+	{
+		frame = getFrameAtIndex(list, i);
+		printf("                %s               %u ms        %s", frame->name, frame->duration, frame->path);
+		printf(frame->effectCount ? "        (%d effects)\n" : "\n", frame->effectCount);
+	}
+	printf("\n");
+}
+
+/**
+	Function that inserts a given frame to the FrameList in a given k position.
+	Input: list - the FrameList.
+		   frame - frame to insert.
+		   k - position where to insert (starting from 1), past the end appends.
+	Output: None.
+*/
+void insertFrameAtPositionK(FrameList* list, Frame* frame, int k)
+{
+	int index = k - FIRST_NODE_INDEX;
+
+	if (!frame)
+	{
+		return;
+	}
+	indexAllFrames(list);
+	if (index < 0)
+	{
+		index = 0;
+	}
+	if (index > list->length)
+	{
+		index = list->length;
+	}
+	reserveFrames(list, list->length + INC);
+	memmove(&list->frames[index + INC], &list->frames[index], sizeof(Frame*) * (list->length - index));
+	list->frames[index] = frame;
+	list->length++;
+	renumberFrames(list, index, list->length - INC);
+	addToFrameIndex(&list->names, frame);
+	if (list->timeline.valid && index == list->length - INC)
+	{
+		appendTimelineDuration(&list->timeline, frame->duration);
+	}
+	else
+	{
+		list->timeline.valid = FALSE;
+	}
+}
+
+/**
+	Function that deletes the frame in a given k position of the FrameList.
+	The frame's memory stays in the list's arena until the list is freed.
+	Input: list - the FrameList.
+		   k - position to delete (starting from 1).
+	Output: None.
+*/
+void deleteFrameAtPositionK(FrameList* list, int k)
+{
+	int index = k - FIRST_NODE_INDEX;
+	Frame* frame = NULL;
+
+	if (index < 0 || index >= list->length)
+	{
+		return;
+	}
+	indexAllFrames(list);
+	frame = list->frames[index];
+	memmove(&list->frames[index], &list->frames[index + INC], sizeof(Frame*) * (list->length - index - INC));
+	list->length--;
+	renumberFrames(list, index, list->length - INC);
+	removeFromFrameIndex(&list->names, frame);
+	if (list->timeline.valid && index == list->length)
+	{
+		removeLastTimelineDuration(&list->timeline);
+	}
+	else
+	{
+		list->timeline.valid = FALSE;
+	}
+}
+
+/*
+	Function that changes a frame's position in the FrameList by the frame's name and given position.
+	Only the frames between the old and the new position are shifted.
+	Input: list - the FrameList.
+		   frameName - the name of the frame that has to be changed in position.
+		   newPosition - the new position of the frame in the list.
+		   NOTE: the indexing starts from 1 to n, where n is the length of the list.
+	Output: None.
+*/
+void changeFrameNodePosition(FrameList* list, char* frameName, int newPosition)
+{
+	int currentIndex = isFrameNameAlreadyExistsInList(list, frameName, NOT_FOUND_MESSAGE) - FIRST_NODE_INDEX;
+	int newIndex = newPosition - FIRST_NODE_INDEX;
+	Frame* frame = NULL;
+
+	if (currentIndex < 0 || newIndex < 0 || newIndex >= list->length || currentIndex == newIndex)
+	{
+		return;
+	}
+	frame = list->frames[currentIndex];
+	if (currentIndex < newIndex)
+	{
+		memmove(&list->frames[currentIndex], &list->frames[currentIndex + INC], sizeof(Frame*) * (newIndex - currentIndex));
+		list->frames[newIndex] = frame;
+		renumberFrames(list, currentIndex, newIndex);
+	}
+	else
+	{
+		memmove(&list->frames[newIndex + INC], &list->frames[newIndex], sizeof(Frame*) * (currentIndex - newIndex));
+		list->frames[newIndex] = frame;
+		renumberFrames(list, newIndex, currentIndex);
+	}
+	list->timeline.valid = FALSE;
+}
+
+/*
+	Function that removes many frames at once, keeping the order of the others.
+	The array is compacted in one pass, so removing any number of frames costs the same as removing one.
+	Input: list - the FrameList.
+		   marked - one value per frame in timeline order, frames with a nonzero value are removed.
+	Output: None.
+*/
+void removeMarkedFrames(FrameList* list, const unsigned char* marked)
+{
+	int i = 0, kept = 0;
+
+	indexAllFrames(list);
+	for (i = 0; i < list->length; i++)
+	{
+		if (marked[i])
+		{
+			removeFromFrameIndex(&list->names, list->frames[i]);
+		}
+		else
+		{
+			list->frames[kept] = list->frames[i];
+			list->frames[kept]->index = kept;
+			kept++;
+		}
+	}
+	list->timeline.valid = list->timeline.valid && kept == list->length;
+	list->length = kept;
+}
+
+/*
+	Function that changes the duration of the frame at a given array index, keeping the timeline index up to date in O(log n).
+	Input: list - the FrameList.
+		   index - index of the frame, from 0 to length - 1.
+		   newDuration - the new duration of the frame.
+	Output: None.
+*/
+void changeFrameDurationAtIndex(FrameList* list, int index, unsigned int newDuration)
+{
+	Frame* frame = getFrameAtIndex(list, index);
+
+	if (list->timeline.valid)
+	{
+		changeTimelineDuration(&list->timeline, index, frame->duration, newDuration);
+	}
+	frame->duration = newDuration;
+}
+
+/*
+	Function that replaces the effects of a frame with a copy of the given ones.
+	Input: list - the FrameList the frame belongs to, the copy is kept in its arena.
+		   frame - the frame.
+		   effects - the new effects in the order they are applied, may point at the frame's current effects.
+		   effectCount - the number of effects, 0 removes them all.
+	Output: None.
+*/
+void setFrameEffects(FrameList* list, Frame* frame, const Effect* effects, int effectCount)
+{
+	Effect* copy = NULL;
+
+	if (effectCount)
+	{
+		copy = (Effect*)arenaAllocate(&list->arena, sizeof(Effect) * effectCount);
+		memcpy(copy, effects, sizeof(Effect) * effectCount);
+	}
+	frame->effects = copy;
+	frame->effectCount = effectCount;
+}
+
+/*
+	Function that gives the total running time of the timeline.
+	Input: list - the FrameList.
+	Output: the sum of the durations of all the frames, in milliseconds.
+*/
+uint64_t getTimelineDuration(FrameList* list)
+{
+	indexTimeline(list);
+	return getTimelineStart(&list->timeline, list->length);
+}
+
+/*
+	Function that gives the time a frame comes on screen, counted from the start of the timeline.
+	Input: list - the FrameList.
+		   index - index of the frame, from 0 to length - 1.
+	Output: the sum of the durations of the frames before it, in milliseconds.
+*/
+uint64_t getFrameStartTime(FrameList* list, int index)
+{
+	indexTimeline(list);
+	return getTimelineStart(&list->timeline, index);
+}
+
+/*
+	Function that finds the frame on screen at a given time, in O(log n).
+	Input: list - the FrameList.
+		   time - milliseconds from the start of the timeline.
+	Output: index of the frame, from 0 to length - 1, or TIMELINE_END if the time is past the end of the timeline.
+*/
+int findFrameAtTime(FrameList* list, uint64_t time)
+{
+	indexTimeline(list);
+	return findTimelinePosition(&list->timeline, time);
+}
+
+/*
+	Makes room for at least the given number of frames, growing the array geometrically.
+*/
+static void reserveFrames(FrameList* list, int required)
+{
+	Frame** frames = NULL;
+	int capacity = list->capacity;
+
+	if (required <= capacity)
+	{
+		return;
+	}
+	while (capacity < required)
+	{
+		capacity *= FRAME_LIST_GROWTH_FACTOR;
+	}
+	frames = (Frame**)realloc(list->frames, sizeof(Frame*) * capacity);
+	if (!frames)
+	{
+		printf("Memory allocation failed!\n");
+		exit(MEMORY_ALLOCATION_ERROR_CODE);
+	}
+	list->frames = frames;
+	list->capacity = capacity;
+}
+
+/*
+	Stores the array index of each frame between two indexes, after the frames there were shifted.
+*/
+static void renumberFrames(FrameList* list, int first, int last)
+{
+	int i = 0;
+
+	for (i = first; i <= last; i++)
+	{
+		list->frames[i]->index = i;
+	}
+}
+
+/*
+	Reads every frame still in the source and builds the name index, done once before the first lookup or change.
+*/
+static void indexAllFrames(FrameList* list)
+{
+	int i = 0;
+
+	if (list->namesIndexed)
+	{
+		return;
+	}
+	for (i = 0; i < list->length; i++)
+	{
+		addToFrameIndex(&list->names, getFrameAtIndex(list, i));
+	}
+	list->namesIndexed = TRUE;
+}
+
+/*
+	Reads every frame still in the source and sums their durations, done once before the first time lookup after a reorder.
+*/
+static void indexTimeline(FrameList* list)
+{
+	int i = 0;
+
+	if (list->timeline.valid)
+	{
+		return;
+	}
+	for (i = 0; i < list->length; i++)
+	{
+		getFrameAtIndex(list, i);
+	}
+	buildTimelineIndex(&list->timeline, list->frames, list->length);
+}
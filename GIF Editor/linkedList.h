@@ -1,65 +1,149 @@
-#ifndef LINKEDLISTH
-#define LINKEDLISTH
-
-#define FALSE 0
-#define TRUE !FALSE
-
-#define INC 1
-#define EQUAL_STRINGS_VALUE 0
-#define NOT_FOUND 0
-#define FIRST_NODE_INDEX 1
-#define NULL_CHAR '\0'
-#define MEMORY_ALLOCATION_ERROR_CODE 1
-#define NOT_FOUND_MESSAGE "The frame does not exist!\n"
-#define NO_NOT_FOUND_MESSAGE NULL
-
-// Frame struct
-typedef struct Frame
-{
-	char*		name;
-	unsigned int	duration;
-	char*		path;  
-} Frame;
-
-// Link (node) struct
-typedef struct FrameNode
-{
-	Frame* frame;
-	struct FrameNode* next;
-} FrameNode;
-
-Frame* createFrame(char* name, unsigned int duration, char* path);
-
-void freeFrame(Frame* frame);
-
-FrameNode* createFrameNode(Frame* frame);
-
-void freeFrameNode(FrameNode** node);
-
-void freeFrameNodeList(FrameNode** head);
-
-int frameNodeListLength(FrameNode* head);
-
-void insertFrameToList(FrameNode** head, Frame* frame);
-
-int isFrameNameAlreadyExistsInList(FrameNode * head, char* name, char* notFoundMessage);
-
-FrameNode* findFrameNodeByFrameNameInList(FrameNode* head, char* frameName);
-
-void removeFrameNodeFromList(FrameNode** head, char* frameName);
-
-void deleteLastNode(FrameNode** head);
-
-void changeFrameNodeDurationInList(FrameNode* head, char* frameName, unsigned int newDuration);
-
-void changeAllFrameNodesDurationsInList(FrameNode* head, unsigned int newDuration);
-
-void printFrameNodeList(FrameNode* head);
-
-void insertFrameAtPositionK(FrameNode** head, Frame* frame, int k);
-
-void deleteFrameAtPositionK(FrameNode** head, int k);
-
-void changeFrameNodePosition(FrameNode** head, char* frameName, int newPosition);
-
-#endif
+#ifndef LINKEDLISTH
+#define LINKEDLISTH
+
+#ifndef FALSE
+#define FALSE 0
+#endif
+#ifndef TRUE
+#define TRUE !FALSE
+#endif
+
+#define INC 1
+#define EQUAL_STRINGS_VALUE 0
+#define NOT_FOUND 0
+#define FIRST_NODE_INDEX 1
+#define NULL_CHAR '\0'
+#define MEMORY_ALLOCATION_ERROR_CODE 1
+#define NOT_FOUND_MESSAGE "The frame does not exist!\n"
+#define NO_NOT_FOUND_MESSAGE NULL
+#define FRAME_LIST_INITIAL_CAPACITY 16
+#define FRAME_LIST_GROWTH_FACTOR 2
+#define EFFECT_VALUE_COUNT 4
+#define NO_CANVAS 0
+
+#include <stddef.h>
+#include <stdint.h>
+#include "frameIndex.h"
+#include "timelineIndex.h"
+#include "arena.h"
+#include "stringPool.h"
+
+// One edit of a frame's image, like a crop or a color change. What the values mean depends on the type, see effects.h.
+// Stored in project files as it is in memory.
+typedef struct Effect
+{
+	uint32_t	type;
+	int32_t		values[EFFECT_VALUE_COUNT];
+} Effect;
+
+// Size every frame is fitted to before it is played or exported, and how. What fit means is in canvas.h.
+// A width of NO_CANVAS leaves the frames at their own size. Stored in project files as it is in memory.
+typedef struct Canvas
+{
+	int32_t		width;
+	int32_t		height;
+	uint32_t	fit;
+} Canvas;
+
+// Frame struct
+// imageData is the encoded image when it is embedded in a project bundle, else NULL and the image is read from path
+// imageKey names the image in the caches: the path for files, the bundle, offset and hash for embedded images
+// effects are applied in order whenever the image is shown or exported, the image file itself is never changed
+// index is the frame's place in its list's array, kept up to date by the list functions so finding it by name is O(1)
+typedef struct Frame
+{
+	char*			name;
+	unsigned int		duration;
+	char*			path;  
+	const unsigned char*	imageData;
+	size_t			imageSize;
+	char*			imageKey;
+	const Effect*		effects;
+	int			effectCount;
+	int			index;
+} Frame;
+
+typedef void (*ReadFrameFunction)(void* context, int index, Frame* frame);
+typedef void (*CloseSourceFunction)(void* context);
+
+// Where the frames of a list that were not read yet come from, like a mapped project file.
+// readFrame fills in a frame, its strings and image data may point into the source which stays open until it is closed.
+// path is the file the source reads, or NULL.
+typedef struct FrameSource
+{
+	void*			context;
+	const char*		path;
+	ReadFrameFunction	readFrame;
+	CloseSourceFunction	close;
+} FrameSource;
+
+// Timeline of frames: a growable array in playback order and an index of their names.
+// The frames and their strings are owned by the list's arena, paths are interned.
+// A list attached to a source holds NULL for frames not read yet, getFrameAtIndex reads them on demand
+// and the name index is only built once a function needs all of the frames.
+// timeline sums the durations for time lookups, it is rebuilt on the first lookup after frames were reordered.
+// canvas is the project's frame size, or NO_CANVAS.
+// Positions given to the list functions start from 1, like the menu shows them.
+typedef struct FrameList
+{
+	Frame**		frames;
+	int		length;
+	int		capacity;
+	FrameIndex	names;
+	int		namesIndexed;
+	TimelineIndex	timeline;
+	Arena		arena;
+	StringPool	paths;
+	FrameSource	source;
+	Canvas		canvas;
+} FrameList;
+
+Frame* createFrame(FrameList* list, char* name, unsigned int duration, char* path);
+
+FrameList* createFrameList(void);
+
+void freeFrameNodeList(FrameList** list);
+
+void attachFrameSource(FrameList* list, const FrameSource* source, int frameCount);
+
+void releaseFrameSource(FrameList* list);
+
+int frameNodeListLength(FrameList* list);
+
+Frame* getFrameAtIndex(FrameList* list, int index);
+
+void insertFrameToList(FrameList* list, Frame* frame);
+
+int isFrameNameAlreadyExistsInList(FrameList* list, char* name, char* notFoundMessage);
+
+Frame* findFrameNodeByFrameNameInList(FrameList* list, char* frameName);
+
+void removeFrameNodeFromList(FrameList* list, char* frameName);
+
+void deleteLastNode(FrameList* list);
+
+void changeFrameNodeDurationInList(FrameList* list, char* frameName, unsigned int newDuration);
+
+void changeAllFrameNodesDurationsInList(FrameList* list, unsigned int newDuration);
+
+void printFrameNodeList(FrameList* list);
+
+void insertFrameAtPositionK(FrameList* list, Frame* frame, int k);
+
+void deleteFrameAtPositionK(FrameList* list, int k);
+
+void changeFrameNodePosition(FrameList* list, char* frameName, int newPosition);
+
+void removeMarkedFrames(FrameList* list, const unsigned char* marked);
+
+void changeFrameDurationAtIndex(FrameList* list, int index, unsigned int newDuration);
+
+void setFrameEffects(FrameList* list, Frame* frame, const Effect* effects, int effectCount);
+
+uint64_t getTimelineDuration(FrameList* list);
+
+uint64_t getFrameStartTime(FrameList* list, int index);
+
+int findFrameAtTime(FrameList* list, uint64_t time);
+
+#endif
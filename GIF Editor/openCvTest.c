@@ -1,454 +1,553 @@
-/*********************************
-*       GIF EDITOR PROJECT		 *
-*         openCV Template     	 *
-**********************************/
-
-#define _CRT_SECURE_NO_WARNINGS
-#define CV_IGNORE_DEBUG_BUILD_GUARD
-
-#include <opencv2/imgcodecs/imgcodecs_c.h>
-#include <stdio.h>
-#include <stdlib.h>
-#include <opencv2/core/core_c.h>
-#include <opencv2/highgui/highgui_c.h>
-#include <stdbool.h>
-#include "linkedList.h"
-#include "view.h"
-
-#define MAX_STRING_LENGTH 1000
-#define INC 1
-#define ONE_ELEMENT 1
-#define ENTER "\n"
-#define NULL_CHAR '\0'
-#define FILE_READ_MODE "r"
-#define WRITE_BINARY_MODE "wb"
-#define READ_BINARY_MODE "rb"
-#define BIN_EXTENSION ".bin"
-
-#define PROJECT_OPTIONS_ERROR_MESSAGE "Invalid choice, try again:\n [0] Create a new project\n [1] Load existing project"
-#define CHANGE_INDEX_ERROR_MESSAGE "The movie contains less frames!\nEnter the new index in the movie you wish to place the frame\n"
-
-typedef enum ProjectOptions
-{
-	NEW_PROJECT_OPTION = 0,
-	LOAD_PROJECT_OPTION = 1
-} ProjectOptions;
-
-typedef enum Options
-{
-	EXIT_OPTION = 0, 
-	ADD_FRAME_OPTION = 1, 
-	REMOVE_FRAME_OPTION = 2, 
-	CHANGE_FRAME_POSITION_OPTION = 3,
-	CHANGE_FRAME_DURATION_OPTION = 4,
-	CHANGE_ALL_FRAMES_DURATION_OPTION = 5,
-	PRINT_ALL_FRAMES_LIST_OPTION = 6,  
-	PLAY_GIF_OPTION = 7,
-	SAVE_PROJECT_OPTION = 8
-} Options;
-
-void improvedFgets(char* buffer, int maxCount, FILE* stream);
-
-bool isFileExist(const char* filePath, const char* readMode);
-
-char* createFullPath(char* folderDirectory, char* projectFileName, char* extension);
-
-void saveProject(FrameNode* list, char* directory, char* projectFileName);
-
-FrameNode* loadProject(char* projectFilePath);
-
-void printMenu(void);
-
-int getIntInput(int minValue, int maxValue, char* errorMessage);
-
-void stringInput(char** buffer);
-
-void runGifEditor(void);
-
-int main(void)
-{
-	runGifEditor();
-	getchar();
-	return 0;
-}
-
-/*
-*	Function that serves like better fgets. 
-*	Input: buffer - the buffer where the input will be stored.
-*		   maxCount - the maximum length of the input.
-*		   stream - the stream where the input will be inputed.
-*	Output: None.
-*/
-void improvedFgets(char* buffer, int maxCount, FILE* stream)
-{
-	fgets(buffer, maxCount, stream);
-	buffer[strcspn(buffer, ENTER)] = NULL_CHAR;
-}
-
-/*
-	Function that checks if file exists. 
-	Input: filePath - the path of the file to check if it exists. 
-		   readMode - the read mode of the file. 
-	Output: true if exists, else false.
-*/
-bool isFileExist(const char* filePath, const char* readMode)
-{
-	FILE* file = NULL;
-	file = fopen(filePath, readMode);
-	if (!file)
-	{
-		return false; 
-	}
-	fclose(file);
-	file = NULL;
-	return true; 
-}
-
-/**
-*	Function that creates full path to a file using given folder directory, project file name and extenstion.
-*   Input: folderDirectory - the folder directory of the file.
-*			projectFileName - the file name of the project.
-*			extension - the file extesntion of the project.
-*	Output: full path that has been created according to given parameters.
-*/
-char* createFullPath(char* folderDirectory, char* projectFileName, char* extension)
-{
-	char* fullPath = NULL;
-	int totalLength = strlen(folderDirectory) + strlen(projectFileName) + strlen(extension) + INC;
-
-	fullPath = (char*)malloc(sizeof(char) * totalLength);
-	if (!fullPath)
-	{
-		printf("Memory allocation error!\n");
-		exit(MEMORY_ALLOCATION_ERROR_CODE);
-	}
-	fullPath[totalLength] = NULL_CHAR;
-
-	strcpy(fullPath, folderDirectory);
-	strcat(fullPath, projectFileName);
-	strcat(fullPath, extension);
-
-	return fullPath;
-}
-
-/**
-*	Function that writes frame data to the file that saves the project in a file,
-*	so it will be possible to load this project in the future.
-*	Input: frame - the frame to write into the file. 
-*		   file - the file in which the frame data will be stored.
-*	Output: None.
-*/
-void writeFrameToFile(const Frame* frame, FILE* file)
-{
-	size_t nameLength = 0, pathLength = 0;
-	
-	nameLength = strlen(frame->name) + INC;
-	fwrite(&nameLength, sizeof(size_t), ONE_ELEMENT, file);
-	fwrite(frame->name, sizeof(char), nameLength, file);
-
-	fwrite(&(frame->duration), sizeof(unsigned int), ONE_ELEMENT, file);
-
-	pathLength = strlen(frame->path) + INC;
-	fwrite(&pathLength, sizeof(size_t), ONE_ELEMENT, file);
-	fwrite(frame->path, sizeof(char), pathLength, file);
-}
-
-/*
-	Function that saves the project in the given directory.
-	Input: list - FrameNode* list of the frames data.
-		   directory - a folder directory in which it is possible to save the project.
-		   projectFileName - the file name of the project in which the data shall be saved.
-	Output: None.
-*/
-void saveProject(FrameNode* list, char* directory, char* projectFileName)
-{
-	FrameNode* current = list; 
-	FILE* file = NULL;
-	char* fullPath = createFullPath(directory, projectFileName, BIN_EXTENSION);
-	file = fopen(fullPath, WRITE_BINARY_MODE);
-
-	if (!file)
-	{
-		printf("Could not open file!\n");
-		exit(MEMORY_ALLOCATION_ERROR_CODE);
-	}
-
-	while (current) 
-	{
-		writeFrameToFile(current->frame, file);
-		current = current->next;
-	}
-
-	fclose(file);
-}
-
-/*
-	Function that loads a project and returns FrameNode* list that consists of the loaded frames data.
-	Input: projectFilePath - the file path of the project to load.
-	Output: FrameNode* list of the frames of the project.
-*/
-FrameNode* loadProject(char* projectFilePath)
-{
-	FrameNode* list = NULL;
-	FrameNode* current = list; 
-	FILE* file = NULL;
-	Frame* frame = NULL;
-	size_t nameLength = 0, pathLength = 0;
-
-	file = fopen(projectFilePath, READ_BINARY_MODE);
-	if (!file)
-	{
-		printf("Could not open file!\n");
-		exit(MEMORY_ALLOCATION_ERROR_CODE);
-	}
-
-	// Read the frames from the file
-	while (!feof(file))
-	{
-		frame = (Frame*)malloc(sizeof(Frame));
-		if (!frame)
-		{
-			printf("Memory allocation error!\n");
-			exit(MEMORY_ALLOCATION_ERROR_CODE);
-		}
-
-		fread(&nameLength, sizeof(size_t), ONE_ELEMENT, file);
-		frame->name = malloc(nameLength);
-		fread(frame->name, sizeof(char), nameLength, file);
-
-		fread(&(frame->duration), sizeof(unsigned int), ONE_ELEMENT, file);
-
-		fread(&pathLength, sizeof(size_t), ONE_ELEMENT, file);
-		frame->path = malloc(pathLength);
-		fread(frame->path, sizeof(char), pathLength, file);
-
-		insertFrameToList(&list, frame);
-	}
-
-	// delete the last node that contains trash information.
-	deleteLastNode(&list);
-
-	fclose(file); 
-	return list; 
-}
-
-/*
-	Function that prints the menu of the program.
-	Input: None.
-	Output: None.
-*/
-void printMenu(void)
-{
-	printf("What would you like to do ?\n");
-	printf("	[0] Exit\n");
-	printf("	[1] Add new Frame\n");
-	printf("	[2] Remove a Frame\n");
-	printf("	[3] Change frame index\n");
-	printf("	[4] Change frame duration\n");
-	printf("	[5] Change duration of all frames\n");
-	printf("	[6] List frames\n");
-	printf("	[7] Play movie!\n");
-	printf("	[8] Save project\n");
-}
-
-/*
-	Function that gets int user input while the input is wrong according to given range. 
-	When the input is valid the function returns the given value. 
-	Input: minValue - the minimum valid value of the input.
-		   maxValue - the maximum valid value of the input.
-		   errorMessage - the error message that the user should get on wrong input that is out the given range.
-	Output: the value of the user input that is in the range from minValue to maxValue inclusive.
-*/
-int getIntInput(int minValue, int maxValue, char* errorMessage)
-{
-	int input = 0;
-	do
-	{
-		scanf("%d", &input);
-		getchar();
-		if ((input > maxValue || input < minValue))
-		{
-			printf("%s\n", errorMessage);
-		}
-	} while (input > maxValue || input < minValue);
-
-	return input;
-}
-
-/*
-	Function that gets char* input from the user. 
-	Input: buffer - a pointer to char* where the inputed data will be stored.
-	Output: None.
-*/
-void stringInput(char** buffer)
-{
-	if (*buffer)
-	{
-		free(*buffer);
-		*buffer = NULL;
-	}
-	*buffer = (char*)malloc(sizeof(char) * MAX_STRING_LENGTH);
-	if (!*buffer)
-	{
-		printf("Memory allocation error!\n");
-		exit(MEMORY_ALLOCATION_ERROR_CODE);
-	}
-	improvedFgets(*buffer, MAX_STRING_LENGTH, stdin);
-}
-
-/**
-*	Function that runs the gif editors code.
-*	Input: None.
-*	Output: None.
-*/
-void runGifEditor(void)
-{
-	FrameNode* list = NULL;
-	Frame* frame = NULL;
-	char* path = NULL;
-	char* name = NULL;
-	char* folderDirectory = NULL;
-	char* projectName = NULL;
-	char* projectPath = NULL;
-	unsigned int duration = 0;
-	int input = 0;
-	int index = 0;
-
-	printf("Welcome to Magshimim Movie Maker! what would you like to do?\n [0] Create a new project\n [1] Load existing project\n");
-	input = getIntInput(NEW_PROJECT_OPTION, LOAD_PROJECT_OPTION, PROJECT_OPTIONS_ERROR_MESSAGE);
-
-	if (NEW_PROJECT_OPTION == input)
-	{
-		printf("Working on a new project.\n\n");
-	}
-	else
-	{
-		printf("Insert the project file path from which the data will be loaded:\n");
-		stringInput(&projectPath);
-		if (isFileExist(projectPath, READ_BINARY_MODE))
-		{
-			list = loadProject(projectPath);
-			free(projectPath);
-		}
-		else
-		{
-			printf("Error! Cannot open file, creating a new project!\n\n"); 
-		}
-	}
-
-	do
-	{
-		printMenu();
-		scanf("%d", &input);
-		getchar();
-
-		if (input < EXIT_OPTION || input > SAVE_PROJECT_OPTION)
-		{
-			printf("You should type one of the options - 0-8!\n");
-		}
-		else
-		{
-			if (ADD_FRAME_OPTION == input)
-			{
-				printf("*** Creating new frame ***\n");
-				printf("Please insert frame path:\n");
-				stringInput(&path);
-
-				printf("Please insert frame duration (in miliseconds):\n");
-				scanf("%u", &duration);
-				getchar();
-
-				printf("Please choose a name for that frame:\n");
-				stringInput(&name);
-
-				if (!isFileExist(path, FILE_READ_MODE))
-				{
-					printf("Can't find file! Frame will not be added\n");
-					free(path);
-					free(name);
-				}
-				else
-				{
-					while (isFrameNameAlreadyExistsInList(list, name, NO_NOT_FOUND_MESSAGE))
-					{
-						printf("The name is already taken, please enter another name:\n");
-						stringInput(&name);
-					}
-					frame = createFrame(name, duration, path);
-					insertFrameToList(&list, frame);
-				}
-			}
-			else if (REMOVE_FRAME_OPTION == input)
-			{
-				printf("Enter the name of the frame to remove: \n");
-				stringInput(&name);
-
-				removeFrameNodeFromList(&list, name);
-			}
-			else if (CHANGE_FRAME_POSITION_OPTION == input)
-			{
-				printf("Enter the name of the frame: \n");
-				stringInput(&name);
-
-				if (isFrameNameAlreadyExistsInList(list, name, NOT_FOUND_MESSAGE))
-				{
-					printf("Enter the new index in the movie you wish to place the frame\n");
-					index = getIntInput(FIRST_NODE_INDEX, frameNodeListLength(list), CHANGE_INDEX_ERROR_MESSAGE);
-					changeFrameNodePosition(&list, name, index);
-				}
-				else
-				{
-					free(name);
-					name = NULL;
-				}
-
-			}
-			else if (CHANGE_FRAME_DURATION_OPTION == input)
-			{
-				printf("Enter the name of the frame: \n");
-				stringInput(&name);
-				
-				printf("Enter the new duration:\n");
-				scanf("%u", &duration);
-				getchar();
-
-				changeFrameNodeDurationInList(list, name, duration);
-			}
-			else if (CHANGE_ALL_FRAMES_DURATION_OPTION == input)
-			{
-				printf("Enter the duration for all frames:\n");
-				scanf("%u", &duration);
-				getchar();
-
-				changeAllFrameNodesDurationsInList(list, duration);
-			}
-			else if (PRINT_ALL_FRAMES_LIST_OPTION == input)
-			{
-				printFrameNodeList(list);
-			}
-			else if (PLAY_GIF_OPTION == input)
-			{
-				play(list);
-			}
-			else if (SAVE_PROJECT_OPTION == input)
-			{
-				printf("Enter folder directory to save the project in it: \n");
-				stringInput(&folderDirectory); 
-				printf("Enter name for the project file: \n");
-				stringInput(&projectName);
-
-				saveProject(list, folderDirectory, projectName);
-
-				free(folderDirectory); 
-				folderDirectory = NULL;
-				free(projectName);
-				projectName = NULL;
-			}
-		}
-		printf("\n");
-	} while (input != EXIT_OPTION);
-
-	freeFrameNodeList(&list);
-
-	printf("Bye!\n");
+/*********************************
+*       GIF EDITOR PROJECT		 *
+*         openCV Template     	 *
+**********************************/
+
+#define _CRT_SECURE_NO_WARNINGS
+#define CV_IGNORE_DEBUG_BUILD_GUARD
+
+#include <opencv2/imgcodecs/imgcodecs_c.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <opencv2/core/core_c.h>
+#include <opencv2/highgui/highgui_c.h>
+#include <stdbool.h>
+#include "linkedList.h"
+#include "view.h"
+#include "imageCache.h"
+#include "gifExport.h"
+#include "gifImport.h"
+#include "project.h"
+#include "bundle.h"
+#include "cli.h"
+#include "optimize.h"
+#include "proxyCache.h"
+#include "canvas.h"
+
+#define MAX_STRING_LENGTH 1000
+#define INC 1
+#define ENTER "\n"
+#define NULL_CHAR '\0'
+#define FILE_READ_MODE "r"
+#define READ_BINARY_MODE "rb"
+
+#define PROJECT_OPTIONS_ERROR_MESSAGE "Invalid choice, try again:\n [0] Create a new project\n [1] Load existing project"
+#define DROP_FRAMES_ERROR_MESSAGE "Invalid choice, try again:\n [0] No\n [1] Yes"
+#define EMBED_IMAGES_ERROR_MESSAGE "Invalid choice, try again:\n [0] No\n [1] Yes"
+#define DITHER_MODE_ERROR_MESSAGE "Invalid choice, try again:\n [0] No\n [1] Error diffusion (smoothest)\n [2] Ordered pattern (fastest)"
+#define FRAME_DIFF_MODE_ERROR_MESSAGE "Invalid choice, try again:\n [0] No, store whole frames\n [1] Store the changed rectangle\n [2] Store the changed rectangle with unchanged pixels transparent (smallest)"
+#define PALETTE_MODE_ERROR_MESSAGE "Invalid choice, try again:\n [0] A fixed palette (fastest)\n [1] One palette for the whole GIF\n [2] A palette for each frame (best colors, bigger file)"
+#define LOOKALIKE_FRAMES_ERROR_MESSAGE "Invalid choice, try again:\n [0] Only identical frames\n [1] Also frames that look alike"
+#define START_TIME_ERROR_MESSAGE "The time can not be negative, try again:"
+#define PREVIEW_MODE_ERROR_MESSAGE "Invalid choice, try again:\n [0] Full resolution\n [1] Previews (opens faster)"
+#define LOOP_COUNT_ERROR_MESSAGE "The number of plays can not be negative, try again:"
+#define EFFECT_CHOICE_ERROR_MESSAGE "Invalid choice, try again:\n [0] Remove all effects\n [1] Grayscale\n [2] Brightness and contrast\n [3] Crop\n [4] Resize\n [5] Flip"
+#define EFFECT_VALUE_ERROR_MESSAGE "The value is out of range, try again:"
+#define FLIP_MODE_ERROR_MESSAGE "Invalid choice, try again:\n [1] Horizontally\n [2] Vertically\n [3] Both"
+#define CANVAS_SIZE_ERROR_MESSAGE "The size is out of range, try again:"
+#define CANVAS_FIT_ERROR_MESSAGE "Invalid choice, try again:\n [0] Letterbox (whole frame, black bars)\n [1] Crop (fill the canvas)\n [2] Stretch"
+#define REMOVE_EFFECTS_CHOICE 0
+#define CHANGE_INDEX_ERROR_MESSAGE "The movie contains less frames!\nEnter the new index in the movie you wish to place the frame\n"
+
+typedef enum ProjectOptions
+{
+	NEW_PROJECT_OPTION = 0,
+	LOAD_PROJECT_OPTION = 1
+} ProjectOptions;
+
+typedef enum Options
+{
+	EXIT_OPTION = 0, 
+	ADD_FRAME_OPTION = 1, 
+	REMOVE_FRAME_OPTION = 2, 
+	CHANGE_FRAME_POSITION_OPTION = 3,
+	CHANGE_FRAME_DURATION_OPTION = 4,
+	CHANGE_ALL_FRAMES_DURATION_OPTION = 5,
+	PRINT_ALL_FRAMES_LIST_OPTION = 6,  
+	PLAY_GIF_OPTION = 7,
+	SAVE_PROJECT_OPTION = 8,
+	EXPORT_GIF_OPTION = 9,
+	IMPORT_GIF_OPTION = 10,
+	MERGE_DUPLICATES_OPTION = 11,
+	CACHE_STATISTICS_OPTION = 12,
+	EDIT_EFFECTS_OPTION = 13,
+	SET_CANVAS_OPTION = 14
+} Options;
+
+void improvedFgets(char* buffer, int maxCount, FILE* stream);
+
+bool isFileExist(const char* filePath, const char* readMode);
+
+void printMenu(void);
+
+int getIntInput(int minValue, int maxValue, char* errorMessage);
+
+void stringInput(char** buffer);
+
+void runGifEditor(void);
+
+void editFrameEffects(FrameList* list, Frame* frame);
+
+int main(int argc, char* argv[])
+{
+	if (argc > 1)
+	{
+		return runCli(argc - 1, argv + 1);
+	}
+	runGifEditor();
+	getchar();
+	return 0;
+}
+
+/*
+*	Function that serves like better fgets. 
+*	Input: buffer - the buffer where the input will be stored.
+*		   maxCount - the maximum length of the input.
+*		   stream - the stream where the input will be inputed.
+*	Output: None.
+*/
+void improvedFgets(char* buffer, int maxCount, FILE* stream)
+{
+	fgets(buffer, maxCount, stream);
+	buffer[strcspn(buffer, ENTER)] = NULL_CHAR;
+}
+
+/*
+	Function that checks if file exists. 
+	Input: filePath - the path of the file to check if it exists. 
+		   readMode - the read mode of the file. 
+	Output: true if exists, else false.
+*/
+bool isFileExist(const char* filePath, const char* readMode)
+{
+	FILE* file = NULL;
+	file = fopen(filePath, readMode);
+	if (!file)
+	{
+		return false; 
+	}
+	fclose(file);
+	file = NULL;
+	return true; 
+}
+
+/*
+	Function that prints the menu of the program.
+	Input: None.
+	Output: None.
+*/
+void printMenu(void)
+{
+	printf("What would you like to do ?\n");
+	printf("	[0] Exit\n");
+	printf("	[1] Add new Frame\n");
+	printf("	[2] Remove a Frame\n");
+	printf("	[3] Change frame index\n");
+	printf("	[4] Change frame duration\n");
+	printf("	[5] Change duration of all frames\n");
+	printf("	[6] List frames\n");
+	printf("	[7] Play movie!\n");
+	printf("	[8] Save project\n");
+	printf("	[9] Export GIF\n");
+	printf("	[10] Import GIF\n");
+	printf("	[11] Merge duplicate frames\n");
+	printf("	[12] Show cache statistics\n");
+	printf("	[13] Edit frame effects\n");
+	printf("	[14] Set canvas size\n");
+}
+
+/*
+	Function that gets int user input while the input is wrong according to given range. 
+	When the input is valid the function returns the given value. 
+	Input: minValue - the minimum valid value of the input.
+		   maxValue - the maximum valid value of the input.
+		   errorMessage - the error message that the user should get on wrong input that is out the given range.
+	Output: the value of the user input that is in the range from minValue to maxValue inclusive.
+*/
+int getIntInput(int minValue, int maxValue, char* errorMessage)
+{
+	int input = 0;
+	do
+	{
+		scanf("%d", &input);
+		getchar();
+		if ((input > maxValue || input < minValue))
+		{
+			printf("%s\n", errorMessage);
+		}
+	} while (input > maxValue || input < minValue);
+
+	return input;
+}
+
+/*
+	Function that gets char* input from the user. 
+	Input: buffer - a pointer to char* where the inputed data will be stored.
+	Output: None.
+*/
+void stringInput(char** buffer)
+{
+	if (*buffer)
+	{
+		free(*buffer);
+		*buffer = NULL;
+	}
+	*buffer = (char*)malloc(sizeof(char) * MAX_STRING_LENGTH);
+	if (!*buffer)
+	{
+		printf("Memory allocation error!\n");
+		exit(MEMORY_ALLOCATION_ERROR_CODE);
+	}
+	improvedFgets(*buffer, MAX_STRING_LENGTH, stdin);
+}
+
+/**
+*	Function that runs the gif editors code.
+*	Input: None.
+*	Output: None.
+*/
+void runGifEditor(void)
+{
+	FrameList* list = createFrameList();
+	Frame* frame = NULL;
+	ImageCache* imageCache = createImageCache(IMAGE_CACHE_BUDGET_BYTES);
+	ProxyCache* proxies = NULL;
+	FrameStore* frameStore = openFrameStore(FRAME_STORE_DIRECTORY, FRAME_STORE_BUDGET_BYTES);
+	char* path = NULL;
+	char* name = NULL;
+	char* folderDirectory = NULL;
+	char* projectName = NULL;
+	char* projectPath = NULL;
+	char* gifPath = NULL;
+	PlaybackOptions playbackOptions;
+	ExportOptions exportOptions;
+	DuplicateReport duplicateReport;
+	CanvasReport canvasReport;
+	unsigned int duration = 0;
+	int input = 0;
+	int index = 0;
+	int importedCount = 0;
+	int firstNewFrame = 0;
+	int canvasWidth = 0;
+	int canvasHeight = 0;
+	int maxDifference = 0;
+	int usePreviews = FALSE;
+
+	attachFrameStore(imageCache, frameStore);
+	initExportOptions(&exportOptions);
+	printf("Welcome to Magshimim Movie Maker! what would you like to do?\n [0] Create a new project\n [1] Load existing project\n");
+	input = getIntInput(NEW_PROJECT_OPTION, LOAD_PROJECT_OPTION, PROJECT_OPTIONS_ERROR_MESSAGE);
+
+	if (NEW_PROJECT_OPTION == input)
+	{
+		printf("Working on a new project.\n\n");
+	}
+	else
+	{
+		printf("Insert the project file path from which the data will be loaded:\n");
+		stringInput(&projectPath);
+		if (isFileExist(projectPath, READ_BINARY_MODE))
+		{
+			freeFrameNodeList(&list);
+			list = loadProject(projectPath);
+			if (!list)
+			{
+				printf("Error! Cannot load the project, creating a new project!\n\n");
+				list = createFrameList();
+			}
+			free(projectPath);
+		}
+		else
+		{
+			printf("Error! Cannot open file, creating a new project!\n\n"); 
+		}
+	}
+
+	do
+	{
+		printMenu();
+		scanf("%d", &input);
+		getchar();
+
+		if (input < EXIT_OPTION || input > SET_CANVAS_OPTION)
+		{
+			printf("You should type one of the options - 0-14!\n");
+		}
+		else
+		{
+			if (ADD_FRAME_OPTION == input)
+			{
+				printf("*** Creating new frame ***\n");
+				printf("Please insert frame path:\n");
+				stringInput(&path);
+
+				printf("Please insert frame duration (in miliseconds):\n");
+				scanf("%u", &duration);
+				getchar();
+
+				printf("Please choose a name for that frame:\n");
+				stringInput(&name);
+
+				if (!isFileExist(path, FILE_READ_MODE))
+				{
+					printf("Can't find file! Frame will not be added\n");
+					free(path);
+					free(name);
+				}
+				else
+				{
+					while (findFrameNodeByFrameNameInList(list, name))
+					{
+						printf("The name is already taken, please enter another name:\n");
+						stringInput(&name);
+					}
+					frame = createFrame(list, name, duration, path);
+					insertFrameToList(list, frame);
+					prepareCanvasImages(list, imageCache, frameNodeListLength(list) - INC, &canvasReport);
+				}
+			}
+			else if (REMOVE_FRAME_OPTION == input)
+			{
+				printf("Enter the name of the frame to remove: \n");
+				stringInput(&name);
+
+				removeFrameNodeFromList(list, name);
+			}
+			else if (CHANGE_FRAME_POSITION_OPTION == input)
+			{
+				printf("Enter the name of the frame: \n");
+				stringInput(&name);
+
+				if (isFrameNameAlreadyExistsInList(list, name, NOT_FOUND_MESSAGE))
+				{
+					printf("Enter the new index in the movie you wish to place the frame\n");
+					index = getIntInput(FIRST_NODE_INDEX, frameNodeListLength(list), CHANGE_INDEX_ERROR_MESSAGE);
+					changeFrameNodePosition(list, name, index);
+				}
+				else
+				{
+					free(name);
+					name = NULL;
+				}
+
+			}
+			else if (CHANGE_FRAME_DURATION_OPTION == input)
+			{
+				printf("Enter the name of the frame: \n");
+				stringInput(&name);
+				
+				printf("Enter the new duration:\n");
+				scanf("%u", &duration);
+				getchar();
+
+				changeFrameNodeDurationInList(list, name, duration);
+			}
+			else if (CHANGE_ALL_FRAMES_DURATION_OPTION == input)
+			{
+				printf("Enter the duration for all frames:\n");
+				scanf("%u", &duration);
+				getchar();
+
+				changeAllFrameNodesDurationsInList(list, duration);
+			}
+			else if (PRINT_ALL_FRAMES_LIST_OPTION == input)
+			{
+				printFrameNodeList(list);
+			}
+			else if (PLAY_GIF_OPTION == input)
+			{
+				printf("Drop frames when playback falls behind?\n [0] No\n [1] Yes\n");
+				playbackOptions.dropLateFrames = getIntInput(FALSE, TRUE, DROP_FRAMES_ERROR_MESSAGE);
+				printf("Start playing at which time of the movie (in miliseconds)?\n");
+				playbackOptions.startTime = (uint64_t)getIntInput(0, INT_MAX, START_TIME_ERROR_MESSAGE);
+				printf("How many times to play the movie? (0 plays it until you stop it)\n");
+				playbackOptions.loopCount = getIntInput(PLAYBACK_LOOP_FOREVER, INT_MAX, LOOP_COUNT_ERROR_MESSAGE);
+				printf("Play the images at full resolution or their previews?\n [0] Full resolution\n [1] Previews (opens faster)\n");
+				usePreviews = getIntInput(FALSE, TRUE, PREVIEW_MODE_ERROR_MESSAGE);
+				if (usePreviews && !proxies)
+				{
+					proxies = openProxyCache(PROXY_CACHE_DIRECTORY);
+				}
+				play(list, imageCache, usePreviews ? proxies : NULL, &playbackOptions);
+			}
+			else if (SAVE_PROJECT_OPTION == input)
+			{
+				printf("Enter folder directory to save the project in it: \n");
+				stringInput(&folderDirectory); 
+				printf("Enter name for the project file: \n");
+				stringInput(&projectName);
+
+				printf("Embed the frame images in the project file?\n [0] No\n [1] Yes\n");
+				if (getIntInput(FALSE, TRUE, EMBED_IMAGES_ERROR_MESSAGE)
+					? PROJECT_NOT_SAVED == saveBundle(list, folderDirectory, projectName)
+					: PROJECT_NOT_SAVED == saveProject(list, folderDirectory, projectName))
+				{
+					printf("The project was not saved!\n");
+				}
+
+				free(folderDirectory); 
+				folderDirectory = NULL;
+				free(projectName);
+				projectName = NULL;
+			}
+			else if (EXPORT_GIF_OPTION == input)
+			{
+				printf("Enter the path of the GIF file to create: \n");
+				stringInput(&gifPath);
+				printf("Which colors should the GIF use?\n [0] A fixed palette (fastest)\n [1] One palette for the whole GIF\n [2] A palette for each frame (best colors, bigger file)\n");
+				exportOptions.paletteMode = (PaletteMode)getIntInput(PALETTE_UNIFORM, PALETTE_PER_FRAME, PALETTE_MODE_ERROR_MESSAGE);
+				printf("Dither the colors?\n [0] No\n [1] Error diffusion (smoothest)\n [2] Ordered pattern (fastest)\n");
+				exportOptions.ditherMode = (DitherMode)getIntInput(DITHER_NONE, DITHER_ORDERED, DITHER_MODE_ERROR_MESSAGE);
+				printf("Store only what changed between frames?\n [0] No, store whole frames\n [1] Store the changed rectangle\n [2] Store the changed rectangle with unchanged pixels transparent (smallest)\n");
+				exportOptions.frameDiffMode = (FrameDiffMode)getIntInput(FRAME_DIFF_OFF, FRAME_DIFF_TRANSPARENT, FRAME_DIFF_MODE_ERROR_MESSAGE);
+				printf("Start the GIF at which time of the movie (in miliseconds)?\n");
+				exportOptions.startTime = (uint64_t)getIntInput(0, INT_MAX, START_TIME_ERROR_MESSAGE);
+
+				printf("%s\n", exportResultMessage(exportGif(list, imageCache, gifPath, &exportOptions)));
+
+				free(gifPath);
+				gifPath = NULL;
+			}
+			else if (IMPORT_GIF_OPTION == input)
+			{
+				printf("Enter the path of the GIF file to import: \n");
+				stringInput(&gifPath);
+				printf("Enter folder directory to write the frame images in it: \n");
+				stringInput(&folderDirectory);
+
+				firstNewFrame = frameNodeListLength(list);
+				printf("%s\n", importResultMessage(importGif(list, gifPath, folderDirectory, &importedCount)));
+				printf("%d frames were added.\n", importedCount);
+				prepareCanvasImages(list, imageCache, firstNewFrame, &canvasReport);
+				printCanvasReport(&list->canvas, &canvasReport);
+
+				free(gifPath);
+				gifPath = NULL;
+				free(folderDirectory);
+				folderDirectory = NULL;
+			}
+			else if (MERGE_DUPLICATES_OPTION == input)
+			{
+				printf("Which frames should be merged?\n [0] Only identical frames\n [1] Also frames that look alike\n");
+				maxDifference = getIntInput(FALSE, TRUE, LOOKALIKE_FRAMES_ERROR_MESSAGE) ? DEFAULT_LOOKALIKE_DIFFERENCE : EXACT_DUPLICATES_ONLY;
+				mergeDuplicateFrames(list, imageCache, maxDifference, &duplicateReport);
+				printDuplicateReport(&duplicateReport);
+			}
+			else if (CACHE_STATISTICS_OPTION == input)
+			{
+				printImageCacheStats(imageCache);
+				if (frameStore)
+				{
+					printFrameStoreStats(frameStore);
+				}
+			}
+			else if (EDIT_EFFECTS_OPTION == input)
+			{
+				printf("Enter the name of the frame: \n");
+				stringInput(&name);
+
+				frame = findFrameNodeByFrameNameInList(list, name);
+				if (frame)
+				{
+					editFrameEffects(list, frame);
+				}
+				else
+				{
+					printf("The frame does not exist!\n");
+				}
+				free(name);
+				name = NULL;
+			}
+			else if (SET_CANVAS_OPTION == input)
+			{
+				printCanvas(&list->canvas);
+				printf("Enter the canvas width (0 lets every frame keep its own size):\n");
+				canvasWidth = getIntInput(NO_CANVAS, MAX_CANVAS_SIZE, CANVAS_SIZE_ERROR_MESSAGE);
+				if (NO_CANVAS == canvasWidth)
+				{
+					clearCanvas(list);
+				}
+				else
+				{
+					printf("Enter the canvas height:\n");
+					canvasHeight = getIntInput(INC, MAX_CANVAS_SIZE, CANVAS_SIZE_ERROR_MESSAGE);
+					printf("How should frames of another shape fit?\n [0] Letterbox (whole frame, black bars)\n [1] Crop (fill the canvas)\n [2] Stretch\n");
+					setCanvas(list, canvasWidth, canvasHeight,
+						(CanvasFit)getIntInput(CANVAS_FIT_LETTERBOX, CANVAS_FIT_STRETCH, CANVAS_FIT_ERROR_MESSAGE));
+					prepareCanvasImages(list, imageCache, 0, &canvasReport);
+					printCanvasReport(&list->canvas, &canvasReport);
+				}
+				printCanvas(&list->canvas);
+			}
+		}
+		printf("\n");
+	} while (input != EXIT_OPTION);
+
+	freeFrameNodeList(&list);
+	freeImageCache(&imageCache);
+	closeFrameStore(&frameStore);
+	closeProxyCache(&proxies);
+
+	printf("Bye!\n");
+}
+
+/*
+	Function that asks the user for an effect and adds it to the end of a frame's effects, or removes all of them.
+	Input: list - the FrameList the frame belongs to.
+		   frame - the frame to edit.
+	Output: None.
+*/
+void editFrameEffects(FrameList* list, Frame* frame)
+{
+	Effect effect;
+	int choice = 0;
+
+	printFrameEffects(frame);
+	printf("What would you like to do?\n [0] Remove all effects\n [1] Grayscale\n [2] Brightness and contrast\n [3] Crop\n [4] Resize\n [5] Flip\n");
+	choice = getIntInput(REMOVE_EFFECTS_CHOICE, EFFECT_TYPE_COUNT, EFFECT_CHOICE_ERROR_MESSAGE);
+	if (REMOVE_EFFECTS_CHOICE == choice)
+	{
+		setFrameEffects(list, frame, NULL, 0);
+		printFrameEffects(frame);
+		return;
+	}
+
+	// the choices are the effect types, one after the other
+	memset(&effect, 0, sizeof(Effect));
+	effect.type = (uint32_t)(choice - INC);
+	if (EFFECT_BRIGHTNESS_CONTRAST == effect.type)
+	{
+		printf("Enter the brightness to add (%d to %d):\n", MIN_BRIGHTNESS, MAX_BRIGHTNESS);
+		effect.values[0] = getIntInput(MIN_BRIGHTNESS, MAX_BRIGHTNESS, EFFECT_VALUE_ERROR_MESSAGE);
+		printf("Enter the contrast in percent (%d to %d, %d keeps it):\n", MIN_CONTRAST_PERCENT, MAX_CONTRAST_PERCENT, NORMAL_CONTRAST_PERCENT);
+		effect.values[1] = getIntInput(MIN_CONTRAST_PERCENT, MAX_CONTRAST_PERCENT, EFFECT_VALUE_ERROR_MESSAGE);
+	}
+	else if (EFFECT_CROP == effect.type)
+	{
+		printf("Enter the left and top of the part to keep:\n");
+		effect.values[0] = getIntInput(0, MAX_EFFECT_SIZE - INC, EFFECT_VALUE_ERROR_MESSAGE);
+		effect.values[1] = getIntInput(0, MAX_EFFECT_SIZE - INC, EFFECT_VALUE_ERROR_MESSAGE);
+		printf("Enter the width and height of the part to keep:\n");
+		effect.values[2] = getIntInput(INC, MAX_EFFECT_SIZE, EFFECT_VALUE_ERROR_MESSAGE);
+		effect.values[3] = getIntInput(INC, MAX_EFFECT_SIZE, EFFECT_VALUE_ERROR_MESSAGE);
+	}
+	else if (EFFECT_RESIZE == effect.type)
+	{
+		printf("Enter the new width and height:\n");
+		effect.values[0] = getIntInput(INC, MAX_EFFECT_SIZE, EFFECT_VALUE_ERROR_MESSAGE);
+		effect.values[1] = getIntInput(INC, MAX_EFFECT_SIZE, EFFECT_VALUE_ERROR_MESSAGE);
+	}
+	else if (EFFECT_FLIP == effect.type)
+	{
+		printf("Flip the frame how?\n [1] Horizontally\n [2] Vertically\n [3] Both\n");
+		effect.values[0] = getIntInput(FLIP_HORIZONTAL, FLIP_BOTH, FLIP_MODE_ERROR_MESSAGE);
+	}
+
+	if (EFFECT_NOT_ADDED == addFrameEffect(list, frame, &effect))
+	{
+		printf("The frame already has %d effects!\n", MAX_EFFECTS_PER_FRAME);
+	}
+	printFrameEffects(frame);
 }
\ No newline at end of file
@@ -0,0 +1,290 @@
+/*********************************
+*		GIF EDITOR PROJECT       *
+*         Optimizations          *
+**********************************/
+
+#define _CRT_SECURE_NO_WARNINGS
+#define CV_IGNORE_DEBUG_BUILD_GUARD
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <opencv2/imgproc/imgproc_c.h>
+#include "optimize.h"
+#include "hash.h"
+
+#define BGR_CHANNELS 3
+#define BLUE_WEIGHT 29 // luma weights in 256ths
+#define GREEN_WEIGHT 150
+#define RED_WEIGHT 77
+#define LUMA_SHIFT 8
+#define IMAGE_ROW_ALIGNMENT 4
+
+// A range of frames hashed on a pool worker
+typedef struct HashJob
+{
+	ImageCache*	cache;
+	const Frame**	frames;
+	FrameHash*	hashes;
+	int		frameCount;
+} HashJob;
+
+static void hashFrames(void* argument);
+static void hashImage(const IplImage* image, FrameHash* hash);
+static int isDuplicate(ImageCache* cache, const Frame* kept, const FrameHash* keptHash,
+	const Frame* frame, const FrameHash* hash, int maxDifference);
+static int haveSameImage(const Frame* first, const Frame* second);
+static int havePixelsEqual(ImageCache* cache, const Frame* first, const Frame* second);
+static int thumbnailDifference(const unsigned char* first, const unsigned char* second);
+
+/*
+	Function that collapses each run of consecutive duplicate frames into its first frame,
+	which is kept with the durations of the whole run added up. Playback and export then decode one frame per run.
+	The frames are decoded and hashed in parallel, exact duplicates are confirmed pixel by pixel before merging.
+	Lookalike frames are found by a perceptual hash: the frame shrunk to a 32x32 gray thumbnail, each pixel the average
+	of its area. Frames look alike when no thumbnail pixel differs by more than the given number of gray levels,
+	so noise averages out while a small object that moved still changes the average of its area.
+	Each frame is compared with the first frame of its run, so a slow fade is never merged into one frame.
+	Frames that cannot be read are never merged.
+	Input: list - the frames to optimize.
+		   cache - the decoded image cache the frames are read through.
+		   maxDifference - EXACT_DUPLICATES_ONLY, or how many gray levels the thumbnails of lookalike frames may differ by.
+		   report - where what was merged is stored.
+	Output: the number of frames that were removed.
+*/
+int mergeDuplicateFrames(FrameList* list, ImageCache* cache, int maxDifference, DuplicateReport* report)
+{
+	ThreadPool* pool = NULL;
+	HashJob* jobs = NULL;
+	const Frame** frames = NULL;
+	FrameHash* hashes = NULL;
+	unsigned char* merged = NULL;
+	Frame* kept = NULL;
+	int frameCount = frameNodeListLength(list);
+	int jobCount = 0, keptIndex = 0, firstFrame = 0, i = 0;
+	int inRun = FALSE;
+
+	report->framesBefore = frameCount;
+	report->framesMerged = 0;
+	report->unreadableFrames = 0;
+	report->runsMerged = 0;
+	if (frameCount < 2)
+	{
+		return 0;
+	}
+
+	frames = (const Frame**)malloc(sizeof(Frame*) * frameCount);
+	hashes = (FrameHash*)calloc(frameCount, sizeof(FrameHash));
+	merged = (unsigned char*)calloc(frameCount, sizeof(unsigned char));
+	if (!frames || !hashes || !merged)
+	{
+		printf("Memory allocation failed!\n");
+		exit(MEMORY_ALLOCATION_ERROR_CODE);
+	}
+	for (i = 0; i < frameCount; i++)
+	{
+		frames[i] = getFrameAtIndex(list, i);
+	}
+
+	pool = createThreadPool(THREAD_POOL_ONE_PER_PROCESSOR);
+	jobCount = pool->workerCount * HASH_JOBS_PER_WORKER;
+	if (jobCount < INC)
+	{
+		jobCount = INC;
+	}
+	if (jobCount > frameCount)
+	{
+		jobCount = frameCount;
+	}
+	jobs = (HashJob*)malloc(sizeof(HashJob) * jobCount);
+	if (!jobs)
+	{
+		printf("Memory allocation failed!\n");
+		exit(MEMORY_ALLOCATION_ERROR_CODE);
+	}
+	for (i = 0; i < jobCount; i++)
+	{
+		jobs[i].cache = cache;
+		jobs[i].frames = frames + firstFrame;
+		jobs[i].hashes = hashes + firstFrame;
+		jobs[i].frameCount = (int)((long long)frameCount * (i + INC) / jobCount) - firstFrame;
+		firstFrame += jobs[i].frameCount;
+		submitTask(pool, hashFrames, &jobs[i]);
+	}
+	waitForAllTasks(pool);
+	freeThreadPool(&pool);
+	free(jobs);
+
+	for (i = 0; i < frameCount; i++)
+	{
+		if (!hashes[i].readable)
+		{
+			report->unreadableFrames++;
+		}
+		if (i && isDuplicate(cache, frames[keptIndex], &hashes[keptIndex], frames[i], &hashes[i], maxDifference)
+			&& frames[keptIndex]->duration <= UINT_MAX - frames[i]->duration)
+		{
+			kept = getFrameAtIndex(list, keptIndex);
+			changeFrameDurationAtIndex(list, keptIndex, kept->duration + frames[i]->duration);
+			merged[i] = TRUE;
+			report->framesMerged++;
+			report->runsMerged += inRun ? 0 : INC;
+			inRun = TRUE;
+			printf("Merged frame %s into %s, its duration is now %u ms\n", frames[i]->name, kept->name, kept->duration);
+		}
+		else
+		{
+			keptIndex = i;
+			inRun = FALSE;
+		}
+	}
+	if (report->framesMerged)
+	{
+		removeMarkedFrames(list, merged);
+	}
+
+	free(merged);
+	free(hashes);
+	free(frames);
+	return report->framesMerged;
+}
+
+/*
+	Function that prints what merging duplicate frames did.
+	Input: report - the report of the merge.
+	Output: None.
+*/
+void printDuplicateReport(const DuplicateReport* report)
+{
+	printf("%d of %d frames were merged into %lu runs, %d frames are left.\n", report->framesMerged, report->framesBefore,
+		report->runsMerged, report->framesBefore - report->framesMerged);
+	if (report->unreadableFrames)
+	{
+		printf("%d frames could not be read and were kept as they are.\n", report->unreadableFrames);
+	}
+}
+
+/*
+	Pool task: decodes a range of frames through the cache and hashes their pixels.
+*/
+static void hashFrames(void* argument)
+{
+	HashJob* job = (HashJob*)argument;
+	ImageCacheEntry* entry = NULL;
+	int i = 0;
+
+	for (i = 0; i < job->frameCount; i++)
+	{
+		entry = acquireFrameImage(job->cache, job->frames[i]);
+		job->hashes[i].readable = entry ? TRUE : FALSE;
+		if (entry)
+		{
+			hashImage(entry->image, &job->hashes[i]);
+			releaseCachedImage(job->cache, &entry);
+		}
+	}
+}
+
+/*
+	Hashes the pixel rows of a BGR image, without the row padding, and shrinks it to its gray thumbnail.
+*/
+static void hashImage(const IplImage* image, FrameHash* hash)
+{
+	unsigned char smallPixels[THUMBNAIL_SIZE][THUMBNAIL_SIZE * BGR_CHANNELS];
+	IplImage small;
+	const unsigned char* pixel = NULL;
+	int x = 0, y = 0;
+
+	hash->width = image->width;
+	hash->height = image->height;
+	hash->exact = FNV_OFFSET_BASIS_64;
+	for (y = 0; y < image->height; y++)
+	{
+		hash->exact = hashBytes(image->imageData + (size_t)y * image->widthStep, (size_t)image->width * BGR_CHANNELS, hash->exact);
+	}
+
+	cvInitImageHeader(&small, cvSize(THUMBNAIL_SIZE, THUMBNAIL_SIZE), IPL_DEPTH_8U, BGR_CHANNELS, IPL_ORIGIN_TL, IMAGE_ROW_ALIGNMENT);
+	cvSetData(&small, smallPixels, sizeof(smallPixels[0]));
+	cvResize(image, &small, CV_INTER_AREA);
+	for (y = 0; y < THUMBNAIL_SIZE; y++)
+	{
+		pixel = smallPixels[y];
+		for (x = 0; x < THUMBNAIL_SIZE; x++)
+		{
+			hash->thumbnail[y * THUMBNAIL_SIZE + x] = (unsigned char)((pixel[0] * BLUE_WEIGHT + pixel[1] * GREEN_WEIGHT + pixel[2] * RED_WEIGHT) >> LUMA_SHIFT);
+			pixel += BGR_CHANNELS;
+		}
+	}
+}
+
+/*
+	Checks if a frame can be merged into the first frame of the run before it.
+*/
+static int isDuplicate(ImageCache* cache, const Frame* kept, const FrameHash* keptHash,
+	const Frame* frame, const FrameHash* hash, int maxDifference)
+{
+	if (!keptHash->readable || !hash->readable || keptHash->width != hash->width || keptHash->height != hash->height)
+	{
+		return FALSE;
+	}
+	if (haveSameImage(kept, frame))
+	{
+		return TRUE;
+	}
+	if (EXACT_DUPLICATES_ONLY != maxDifference && thumbnailDifference(keptHash->thumbnail, hash->thumbnail) <= maxDifference)
+	{
+		return TRUE;
+	}
+	return keptHash->exact == hash->exact && havePixelsEqual(cache, kept, frame);
+}
+
+/*
+	Frames reading the same file, or the same bytes of a bundle, with the same effects are duplicates without looking at their pixels.
+*/
+static int haveSameImage(const Frame* first, const Frame* second)
+{
+	if (!haveSameEffects(first, second))
+	{
+		return FALSE;
+	}
+	if (first->imageData || second->imageData)
+	{
+		return first->imageData == second->imageData;
+	}
+	return first->path == second->path || !strcmp(first->path, second->path);
+}
+
+/*
+	Compares the pixels of two frames of the same size, done once their exact hashes match.
+*/
+static int havePixelsEqual(ImageCache* cache, const Frame* first, const Frame* second)
+{
+	ImageCacheEntry* firstEntry = acquireFrameImage(cache, first);
+	ImageCacheEntry* secondEntry = acquireFrameImage(cache, second);
+	int equal = firstEntry && secondEntry;
+	int y = 0;
+
+	for (y = 0; equal && y < firstEntry->image->height; y++)
+	{
+		equal = !memcmp(firstEntry->image->imageData + (size_t)y * firstEntry->image->widthStep,
+			secondEntry->image->imageData + (size_t)y * secondEntry->image->widthStep, (size_t)firstEntry->image->width * BGR_CHANNELS);
+	}
+	releaseCachedImage(cache, &firstEntry);
+	releaseCachedImage(cache, &secondEntry);
+	return equal;
+}
+
+/*
+	Gives the largest difference between two pixels at the same place of two thumbnails.
+*/
+static int thumbnailDifference(const unsigned char* first, const unsigned char* second)
+{
+	int largest = 0, difference = 0, i = 0;
+
+	for (i = 0; i < THUMBNAIL_SIZE * THUMBNAIL_SIZE; i++)
+	{
+		difference = first[i] > second[i] ? first[i] - second[i] : second[i] - first[i];
+		largest = difference > largest ? difference : largest;
+	}
+	return largest;
+}
@@ -0,0 +1,43 @@
+/*********************************
+*		GIF EDITOR PROJECT       *
+*    Optimizations Declaration   *
+**********************************/
+
+#ifndef OPTIMIZEH
+#define OPTIMIZEH
+
+#include <stdint.h>
+#include "linkedList.h"
+#include "imageCache.h"
+#include "threadPool.h"
+
+#define EXACT_DUPLICATES_ONLY -1
+#define DEFAULT_LOOKALIKE_DIFFERENCE 6 // gray levels, noise averages out well below it but a moving cursor does not
+#define MAX_LOOKALIKE_DIFFERENCE 255
+#define THUMBNAIL_SIZE 32
+#define HASH_JOBS_PER_WORKER 4
+
+// Pixel hashes of one decoded frame
+typedef struct FrameHash
+{
+	uint64_t	exact;
+	unsigned char	thumbnail[THUMBNAIL_SIZE * THUMBNAIL_SIZE];
+	int		width;
+	int		height;
+	int		readable;
+} FrameHash;
+
+// What merging the duplicate frames of a timeline did
+typedef struct DuplicateReport
+{
+	int		framesBefore;
+	int		framesMerged;
+	int		unreadableFrames;
+	unsigned long	runsMerged;
+} DuplicateReport;
+
+int mergeDuplicateFrames(FrameList* list, ImageCache* cache, int maxDifference, DuplicateReport* report);
+
+void printDuplicateReport(const DuplicateReport* report);
+
+#endif
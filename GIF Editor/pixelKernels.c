@@ -0,0 +1,244 @@
+/*********************************
+*		GIF EDITOR PROJECT       *
+*         Pixel Kernels          *
+**********************************/
+
+#include <string.h>
+#include "pixelKernels.h"
+#include "quantize.h"
+#include "frameDiff.h"
+#include "platform.h"
+#ifdef PLATFORM_X86
+#include <emmintrin.h>
+#endif
+
+#define BGR_BLUE 0
+#define BGR_GREEN 1
+#define BGR_RED 2
+#define SSE2_VECTOR_BYTES 16
+#define SSE2_KEYS 8 // two vectors of 32 bit keys, packed into one of 16 bit keys
+#define SSE2_PIXELS_PER_VECTOR 4
+#define SSE2_COMPARE_PIXELS 16
+#define BGR_SAME_BITS 7
+#define QUANTIZE_BLUE_MASK 0x001F
+#define QUANTIZE_GREEN_MASK 0x03E0
+#define QUANTIZE_RED_MASK 0x7C00
+
+// Pixels a 16 byte load starting at a pixel may touch, the row must be at least this long from there
+#define LOAD_PIXELS(channels) ((SSE2_VECTOR_BYTES + (channels) - 1) / (channels))
+
+/*
+	Scalar row kernels, one copy per channel count so the pixel stride and the compare size are constants.
+*/
+#define DEFINE_PIXEL_KERNELS(FORMAT, CHANNELS) \
+static void lookupRow##FORMAT(const unsigned char* table, const unsigned char* pixels, unsigned char* indices, int count) \
+{ \
+	int x = 0; \
+ \
+	for (x = 0; x < count; x++, pixels += (CHANNELS)) \
+	{ \
+		indices[x] = table[QUANTIZE_KEY(pixels[BGR_BLUE], pixels[BGR_GREEN], pixels[BGR_RED])]; \
+	} \
+} \
+ \
+static void countRow##FORMAT(uint64_t* counts, const unsigned char* pixels, int count) \
+{ \
+	int x = 0; \
+ \
+	for (x = 0; x < count; x++, pixels += (CHANNELS)) \
+	{ \
+		counts[QUANTIZE_KEY(pixels[BGR_BLUE], pixels[BGR_GREEN], pixels[BGR_RED])]++; \
+	} \
+} \
+ \
+static void compareRow##FORMAT(const unsigned char* first, const unsigned char* second, unsigned char* mask, int count) \
+{ \
+	int x = 0; \
+ \
+	for (x = 0; x < count; x++, first += (CHANNELS), second += (CHANNELS)) \
+	{ \
+		mask[x] = memcmp(first, second, (CHANNELS)) ? PIXEL_CHANGED : PIXEL_UNCHANGED; \
+	} \
+}
+
+/*
+	SSE2 row kernels: the keys of eight pixels are made with vector shifts and masks, then used as table indices.
+	LOAD_VECTOR gives four pixels as the low three bytes of 32 bit lanes.
+*/
+#define DEFINE_PIXEL_KERNELS_SSE2(FORMAT, CHANNELS, LOAD_VECTOR) \
+TARGET_SSE2 static void lookupRow##FORMAT##Sse2(const unsigned char* table, const unsigned char* pixels, unsigned char* indices, int count) \
+{ \
+	uint16_t keys[SSE2_KEYS]; \
+	int x = 0, i = 0; \
+ \
+	for (; x + SSE2_PIXELS_PER_VECTOR + LOAD_PIXELS(CHANNELS) <= count; x += SSE2_KEYS) \
+	{ \
+		findKeysSse2(LOAD_VECTOR(pixels + x * (CHANNELS)), LOAD_VECTOR(pixels + (x + SSE2_PIXELS_PER_VECTOR) * (CHANNELS)), keys); \
+		for (i = 0; i < SSE2_KEYS; i++) \
+		{ \
+			indices[x + i] = table[keys[i]]; \
+		} \
+	} \
+	lookupRow##FORMAT(table, pixels + x * (CHANNELS), indices + x, count - x); \
+} \
+ \
+TARGET_SSE2 static void countRow##FORMAT##Sse2(uint64_t* counts, const unsigned char* pixels, int count) \
+{ \
+	uint16_t keys[SSE2_KEYS]; \
+	int x = 0, i = 0; \
+ \
+	for (; x + SSE2_PIXELS_PER_VECTOR + LOAD_PIXELS(CHANNELS) <= count; x += SSE2_KEYS) \
+	{ \
+		findKeysSse2(LOAD_VECTOR(pixels + x * (CHANNELS)), LOAD_VECTOR(pixels + (x + SSE2_PIXELS_PER_VECTOR) * (CHANNELS)), keys); \
+		for (i = 0; i < SSE2_KEYS; i++) \
+		{ \
+			counts[keys[i]]++; \
+		} \
+	} \
+	countRow##FORMAT(counts, pixels + x * (CHANNELS), count - x); \
+}
+
+DEFINE_PIXEL_KERNELS(Bgr, BGR_PIXEL_CHANNELS)
+DEFINE_PIXEL_KERNELS(Bgra, BGRA_PIXEL_CHANNELS)
+
+#ifdef PLATFORM_X86
+static __m128i loadBgrSse2(const unsigned char* pixels);
+static __m128i loadBgraSse2(const unsigned char* pixels);
+static void findKeysSse2(__m128i low, __m128i high, uint16_t* keys);
+static void compareRowBgrSse2(const unsigned char* first, const unsigned char* second, unsigned char* mask, int count);
+static void compareRowBgraSse2(const unsigned char* first, const unsigned char* second, unsigned char* mask, int count);
+
+DEFINE_PIXEL_KERNELS_SSE2(Bgr, BGR_PIXEL_CHANNELS, loadBgrSse2)
+DEFINE_PIXEL_KERNELS_SSE2(Bgra, BGRA_PIXEL_CHANNELS, loadBgraSse2)
+#endif
+
+static const PixelKernels scalarKernels[PIXEL_FORMAT_COUNT] =
+{
+	{ PIXEL_FORMAT_BGR, BGR_PIXEL_CHANNELS, lookupRowBgr, countRowBgr, compareRowBgr },
+	{ PIXEL_FORMAT_BGRA, BGRA_PIXEL_CHANNELS, lookupRowBgra, countRowBgra, compareRowBgra }
+};
+
+#ifdef PLATFORM_X86
+static const PixelKernels sse2Kernels[PIXEL_FORMAT_COUNT] =
+{
+	{ PIXEL_FORMAT_BGR, BGR_PIXEL_CHANNELS, lookupRowBgrSse2, countRowBgrSse2, compareRowBgrSse2 },
+	{ PIXEL_FORMAT_BGRA, BGRA_PIXEL_CHANNELS, lookupRowBgraSse2, countRowBgraSse2, compareRowBgraSse2 }
+};
+#endif
+
+/*
+	Function that finds which layout the pixel kernels see an image as.
+	Input: image - an 8-bit image with 3 or 4 channels.
+	Output: PIXEL_FORMAT_BGRA for 4 channels, else PIXEL_FORMAT_BGR.
+*/
+PixelFormat getPixelFormat(const IplImage* image)
+{
+	return BGRA_PIXEL_CHANNELS == image->nChannels ? PIXEL_FORMAT_BGRA : PIXEL_FORMAT_BGR;
+}
+
+/*
+	Function that picks the row kernels of a pixel format for this processor.
+	Called once per image, the kernels are then run on every row of it.
+	Input: format - the layout of the image's pixels.
+		   kernels - where the kernels are stored.
+	Output: None.
+*/
+void choosePixelKernels(PixelFormat format, PixelKernels* kernels)
+{
+	*kernels = scalarKernels[format];
+#ifdef PLATFORM_X86
+	if (getCpuFeatures() & CPU_FEATURE_SSE2)
+	{
+		*kernels = sse2Kernels[format];
+	}
+#endif
+}
+
+#ifdef PLATFORM_X86
+/*
+	Gives four BGR pixels as 32 bit lanes, the top byte of each lane is the next pixel's blue.
+	Each lane is shifted left by its own index, so 16 bytes are read.
+*/
+TARGET_SSE2 static __m128i loadBgrSse2(const unsigned char* pixels)
+{
+	__m128i bytes = _mm_loadu_si128((const __m128i*)pixels);
+	__m128i laneMask = _mm_setr_epi32(-1, 0, 0, 0);
+	__m128i lanes = _mm_and_si128(bytes, laneMask);
+
+	lanes = _mm_or_si128(lanes, _mm_and_si128(_mm_slli_si128(bytes, 1), _mm_slli_si128(laneMask, 4)));
+	lanes = _mm_or_si128(lanes, _mm_and_si128(_mm_slli_si128(bytes, 2), _mm_slli_si128(laneMask, 8)));
+	return _mm_or_si128(lanes, _mm_and_si128(_mm_slli_si128(bytes, 3), _mm_slli_si128(laneMask, 12)));
+}
+
+TARGET_SSE2 static __m128i loadBgraSse2(const unsigned char* pixels)
+{
+	return _mm_loadu_si128((const __m128i*)pixels);
+}
+
+/*
+	Stores the QUANTIZE_KEY of the eight pixels held by two vectors of 32 bit lanes.
+*/
+TARGET_SSE2 static void findKeysSse2(__m128i low, __m128i high, uint16_t* keys)
+{
+	const __m128i blueMask = _mm_set1_epi32(QUANTIZE_BLUE_MASK);
+	const __m128i greenMask = _mm_set1_epi32(QUANTIZE_GREEN_MASK);
+	const __m128i redMask = _mm_set1_epi32(QUANTIZE_RED_MASK);
+
+	low = _mm_or_si128(_mm_or_si128(_mm_and_si128(_mm_srli_epi32(low, 3), blueMask), _mm_and_si128(_mm_srli_epi32(low, 6), greenMask)),
+		_mm_and_si128(_mm_srli_epi32(low, 9), redMask));
+	high = _mm_or_si128(_mm_or_si128(_mm_and_si128(_mm_srli_epi32(high, 3), blueMask), _mm_and_si128(_mm_srli_epi32(high, 6), greenMask)),
+		_mm_and_si128(_mm_srli_epi32(high, 9), redMask));
+	// Keys fit in 15 bits, so the signed pack keeps them as they are
+	_mm_storeu_si128((__m128i*)keys, _mm_packs_epi32(low, high));
+}
+
+/*
+	48 byte compares give a bit per byte, a pixel is unchanged when all three of its bits are set.
+*/
+TARGET_SSE2 static void compareRowBgrSse2(const unsigned char* first, const unsigned char* second, unsigned char* mask, int count)
+{
+	uint64_t same = 0;
+	int x = 0, i = 0;
+
+	for (; x + SSE2_COMPARE_PIXELS <= count; x += SSE2_COMPARE_PIXELS)
+	{
+		same = 0;
+		for (i = 0; i < BGR_PIXEL_CHANNELS; i++)
+		{
+			same |= (uint64_t)(unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(
+				_mm_loadu_si128((const __m128i*)(first + x * BGR_PIXEL_CHANNELS + i * SSE2_VECTOR_BYTES)),
+				_mm_loadu_si128((const __m128i*)(second + x * BGR_PIXEL_CHANNELS + i * SSE2_VECTOR_BYTES)))) << (i * SSE2_VECTOR_BYTES);
+		}
+		for (i = 0; i < SSE2_COMPARE_PIXELS; i++)
+		{
+			mask[x + i] = BGR_SAME_BITS == ((same >> (i * BGR_PIXEL_CHANNELS)) & BGR_SAME_BITS) ? PIXEL_UNCHANGED : PIXEL_CHANGED;
+		}
+	}
+	compareRowBgr(first + x * BGR_PIXEL_CHANNELS, second + x * BGR_PIXEL_CHANNELS, mask + x, count - x);
+}
+
+/*
+	Whole pixels are compared as 32 bit lanes, four bits of the 16 give 16 pixels.
+*/
+TARGET_SSE2 static void compareRowBgraSse2(const unsigned char* first, const unsigned char* second, unsigned char* mask, int count)
+{
+	unsigned int same = 0;
+	int x = 0, i = 0;
+
+	for (; x + SSE2_COMPARE_PIXELS <= count; x += SSE2_COMPARE_PIXELS)
+	{
+		same = 0;
+		for (i = 0; i < SSE2_COMPARE_PIXELS / SSE2_PIXELS_PER_VECTOR; i++)
+		{
+			same |= (unsigned int)_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(
+				_mm_loadu_si128((const __m128i*)(first + (x + i * SSE2_PIXELS_PER_VECTOR) * BGRA_PIXEL_CHANNELS)),
+				_mm_loadu_si128((const __m128i*)(second + (x + i * SSE2_PIXELS_PER_VECTOR) * BGRA_PIXEL_CHANNELS))))) << (i * SSE2_PIXELS_PER_VECTOR);
+		}
+		for (i = 0; i < SSE2_COMPARE_PIXELS; i++)
+		{
+			mask[x + i] = (same >> i) & 1u ? PIXEL_UNCHANGED : PIXEL_CHANGED;
+		}
+	}
+	compareRowBgra(first + x * BGRA_PIXEL_CHANNELS, second + x * BGRA_PIXEL_CHANNELS, mask + x, count - x);
+}
+#endif
@@ -0,0 +1,45 @@
+/*********************************
+*		GIF EDITOR PROJECT       *
+*  Pixel Kernels Declaration     *
+**********************************/
+
+#ifndef PIXELKERNELSH
+#define PIXELKERNELSH
+#define CV_IGNORE_DEBUG_BUILD_GUARD
+
+#include <stdint.h>
+#include <opencv2/core/core_c.h>
+
+#define BGR_PIXEL_CHANNELS 3
+#define BGRA_PIXEL_CHANNELS 4
+
+// The 8-bit layouts the pixel kernels are specialized for. Images with any other depth or channel count
+// never reach them: every decoder hands out 8-bit BGR.
+typedef enum PixelFormat
+{
+	PIXEL_FORMAT_BGR = 0,
+	PIXEL_FORMAT_BGRA = 1,
+	PIXEL_FORMAT_COUNT = 2
+} PixelFormat;
+
+typedef void (*LookupRowFunction)(const unsigned char* table, const unsigned char* pixels, unsigned char* indices, int count);
+typedef void (*CountRowFunction)(uint64_t* counts, const unsigned char* pixels, int count);
+typedef void (*CompareRowFunction)(const unsigned char* first, const unsigned char* second, unsigned char* mask, int count);
+
+// The row kernels of one pixel format on this processor, chosen once per image so no pixel loop branches on the layout.
+// lookupRow stores table[QUANTIZE_KEY] of each pixel, countRow adds each pixel to counts at its QUANTIZE_KEY
+// and compareRow stores PIXEL_UNCHANGED or PIXEL_CHANGED for each pair of pixels.
+typedef struct PixelKernels
+{
+	PixelFormat		format;
+	int			channels;
+	LookupRowFunction	lookupRow;
+	CountRowFunction	countRow;
+	CompareRowFunction	compareRow;
+} PixelKernels;
+
+PixelFormat getPixelFormat(const IplImage* image);
+
+void choosePixelKernels(PixelFormat format, PixelKernels* kernels);
+
+#endif
@@ -0,0 +1,575 @@
+/*********************************
+*		GIF EDITOR PROJECT       *
+*         Platform Layer         *
+**********************************/
+
+#define _CRT_SECURE_NO_WARNINGS
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifndef _WIN32
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <errno.h>
+#include <dirent.h>
+#include <utime.h>
+#endif
+#include "platform.h"
+#include "linkedList.h"
+#if defined(PLATFORM_X86) && defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#define CPUID_BASIC_FEATURES 1
+#define CPUID_EXTENDED_FEATURES 7
+#define CPUID_SSE2_BIT (1 << 26)
+#define CPUID_OSXSAVE_BIT (1 << 27)
+#define CPUID_AVX2_BIT (1 << 5)
+#define XCR0_SSE_AND_AVX_STATE 6
+#define DIRECTORY_PERMISSIONS 0755
+#define PATH_SEPARATOR "/"
+#define ALL_FILES_PATTERN "\\*"
+
+// Start arguments handed from createThread to the native thread entry point
+typedef struct ThreadStart
+{
+	ThreadFunction	function;
+	void*		argument;
+} ThreadStart;
+
+#ifdef _WIN32
+static DWORD WINAPI threadEntry(LPVOID parameter)
+#else
+static void* threadEntry(void* parameter)
+#endif
+{
+	ThreadStart start = *(ThreadStart*)parameter;
+
+	free(parameter);
+	start.function(start.argument);
+	return 0;
+}
+
+/*
+	Function that starts a new thread running the given function.
+	Input: thread - where the created thread handle will be stored.
+		   function - the function the thread will run.
+		   argument - the argument passed to the function.
+	Output: THREAD_CREATED on success, else THREAD_NOT_CREATED.
+*/
+int createThread(Thread* thread, ThreadFunction function, void* argument)
+{
+	ThreadStart* start = (ThreadStart*)malloc(sizeof(ThreadStart));
+	if (!start)
+	{
+		printf("Memory allocation failed!\n");
+		exit(MEMORY_ALLOCATION_ERROR_CODE);
+	}
+	start->function = function;
+	start->argument = argument;
+
+#ifdef _WIN32
+	*thread = CreateThread(NULL, 0, threadEntry, start, 0, NULL);
+	if (!*thread)
+#else
+	if (pthread_create(thread, NULL, threadEntry, start))
+#endif
+	{
+		free(start);
+		return THREAD_NOT_CREATED;
+	}
+	return THREAD_CREATED;
+}
+
+/*
+	Function that waits for a thread to finish and releases its handle.
+	Input: thread - the thread to wait for.
+	Output: None.
+*/
+void joinThread(Thread* thread)
+{
+#ifdef _WIN32
+	WaitForSingleObject(*thread, INFINITE);
+	CloseHandle(*thread);
+#else
+	pthread_join(*thread, NULL);
+#endif
+}
+
+/*
+	Thin wrappers over the native mutex and condition variable APIs.
+*/
+void initMutex(Mutex* mutex)
+{
+#ifdef _WIN32
+	InitializeCriticalSection(mutex);
+#else
+	pthread_mutex_init(mutex, NULL);
+#endif
+}
+
+void destroyMutex(Mutex* mutex)
+{
+#ifdef _WIN32
+	DeleteCriticalSection(mutex);
+#else
+	pthread_mutex_destroy(mutex);
+#endif
+}
+
+void lockMutex(Mutex* mutex)
+{
+#ifdef _WIN32
+	EnterCriticalSection(mutex);
+#else
+	pthread_mutex_lock(mutex);
+#endif
+}
+
+void unlockMutex(Mutex* mutex)
+{
+#ifdef _WIN32
+	LeaveCriticalSection(mutex);
+#else
+	pthread_mutex_unlock(mutex);
+#endif
+}
+
+void initCondition(Condition* condition)
+{
+#ifdef _WIN32
+	InitializeConditionVariable(condition);
+#else
+	pthread_cond_init(condition, NULL);
+#endif
+}
+
+void destroyCondition(Condition* condition)
+{
+#ifdef _WIN32
+	(void)condition; // Windows condition variables own no resources
+#else
+	pthread_cond_destroy(condition);
+#endif
+}
+
+void waitCondition(Condition* condition, Mutex* mutex)
+{
+#ifdef _WIN32
+	SleepConditionVariableCS(condition, mutex, INFINITE);
+#else
+	pthread_cond_wait(condition, mutex);
+#endif
+}
+
+void signalCondition(Condition* condition)
+{
+#ifdef _WIN32
+	WakeConditionVariable(condition);
+#else
+	pthread_cond_signal(condition);
+#endif
+}
+
+void broadcastCondition(Condition* condition)
+{
+#ifdef _WIN32
+	WakeAllConditionVariable(condition);
+#else
+	pthread_cond_broadcast(condition);
+#endif
+}
+
+/*
+	Function that reads a clock that only moves forward, unaffected by changes to the wall clock.
+	Input: None.
+	Output: the current time in microseconds since an arbitrary starting point.
+*/
+unsigned long long getMonotonicTimeMicroseconds(void)
+{
+#ifdef _WIN32
+	LARGE_INTEGER counter, frequency;
+
+	QueryPerformanceCounter(&counter);
+	QueryPerformanceFrequency(&frequency);
+	return (unsigned long long)(counter.QuadPart / frequency.QuadPart) * MICROSECONDS_IN_SECOND
+		+ (unsigned long long)(counter.QuadPart % frequency.QuadPart) * MICROSECONDS_IN_SECOND / frequency.QuadPart;
+#else
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (unsigned long long)now.tv_sec * MICROSECONDS_IN_SECOND + (unsigned long long)now.tv_nsec / NANOSECONDS_IN_MICROSECOND;
+#endif
+}
+
+/*
+	Function that counts the processors the program can run threads on.
+	Input: None.
+	Output: the number of online processors, at least 1.
+*/
+int getProcessorCount(void)
+{
+#ifdef _WIN32
+	SYSTEM_INFO info;
+
+	GetSystemInfo(&info);
+	return info.dwNumberOfProcessors > 0 ? (int)info.dwNumberOfProcessors : 1;
+#else
+	long count = sysconf(_SC_NPROCESSORS_ONLN);
+
+	return count > 0 ? (int)count : 1;
+#endif
+}
+
+/*
+	Function that gives the id of the running process, which no other running process has.
+	Input: None.
+	Output: the process id.
+*/
+unsigned long getProcessId(void)
+{
+#ifdef _WIN32
+	return (unsigned long)GetCurrentProcessId();
+#else
+	return (unsigned long)getpid();
+#endif
+}
+
+/*
+	Function that checks which vector instruction sets the processor and the operating system support.
+	Input: None.
+	Output: bit mask of CPU_FEATURE_ flags, 0 on processors other than x86.
+*/
+int getCpuFeatures(void)
+{
+	int features = 0;
+#if defined(PLATFORM_X86) && defined(_MSC_VER)
+	int registers[4] = { 0 };
+
+	__cpuid(registers, CPUID_BASIC_FEATURES);
+	if (registers[3] & CPUID_SSE2_BIT)
+	{
+		features |= CPU_FEATURE_SSE2;
+	}
+	// AVX2 also needs the operating system to save the wide registers on context switches
+	if ((registers[2] & CPUID_OSXSAVE_BIT) && XCR0_SSE_AND_AVX_STATE == (_xgetbv(0) & XCR0_SSE_AND_AVX_STATE))
+	{
+		__cpuidex(registers, CPUID_EXTENDED_FEATURES, 0);
+		if (registers[1] & CPUID_AVX2_BIT)
+		{
+			features |= CPU_FEATURE_AVX2;
+		}
+	}
+#elif defined(PLATFORM_X86)
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("sse2"))
+	{
+		features |= CPU_FEATURE_SSE2;
+	}
+	if (__builtin_cpu_supports("avx2"))
+	{
+		features |= CPU_FEATURE_AVX2;
+	}
+#endif
+	return features;
+}
+
+/*
+	Function that maps a whole file into memory for reading, pages are read from the disk only when touched.
+	Input: path - the path of the file to map.
+		   mappedFile - where the view of the file is stored.
+	Output: FILE_MAPPED on success, else FILE_NOT_MAPPED, also for empty files.
+*/
+int mapFile(const char* path, MappedFile* mappedFile)
+{
+#ifdef _WIN32
+	LARGE_INTEGER size;
+
+	mappedFile->data = NULL;
+	mappedFile->mapping = NULL;
+	mappedFile->file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (INVALID_HANDLE_VALUE == mappedFile->file)
+	{
+		return FILE_NOT_MAPPED;
+	}
+	if (GetFileSizeEx(mappedFile->file, &size) && size.QuadPart > 0 && (unsigned long long)size.QuadPart <= (size_t)-1)
+	{
+		mappedFile->size = (size_t)size.QuadPart;
+		mappedFile->mapping = CreateFileMappingA(mappedFile->file, NULL, PAGE_READONLY, 0, 0, NULL);
+	}
+	if (mappedFile->mapping)
+	{
+		mappedFile->data = (const unsigned char*)MapViewOfFile(mappedFile->mapping, FILE_MAP_READ, 0, 0, 0);
+	}
+	if (!mappedFile->data)
+	{
+		if (mappedFile->mapping)
+		{
+			CloseHandle(mappedFile->mapping);
+		}
+		CloseHandle(mappedFile->file);
+		return FILE_NOT_MAPPED;
+	}
+	return FILE_MAPPED;
+#else
+	struct stat status;
+	void* data = MAP_FAILED;
+	int file = open(path, O_RDONLY);
+
+	mappedFile->data = NULL;
+	if (file < 0)
+	{
+		return FILE_NOT_MAPPED;
+	}
+	if (!fstat(file, &status) && status.st_size > 0 && (unsigned long long)status.st_size <= (size_t)-1)
+	{
+		mappedFile->size = (size_t)status.st_size;
+		data = mmap(NULL, mappedFile->size, PROT_READ, MAP_PRIVATE, file, 0);
+	}
+	// The mapping keeps the file referenced after the descriptor is closed
+	close(file);
+	if (MAP_FAILED == data)
+	{
+		return FILE_NOT_MAPPED;
+	}
+	mappedFile->data = (const unsigned char*)data;
+	return FILE_MAPPED;
+#endif
+}
+
+/*
+	Function that releases a file mapped with mapFile.
+	Input: mappedFile - the mapped file.
+	Output: None.
+*/
+void unmapFile(MappedFile* mappedFile)
+{
+	if (!mappedFile->data)
+	{
+		return;
+	}
+#ifdef _WIN32
+	UnmapViewOfFile(mappedFile->data);
+	CloseHandle(mappedFile->mapping);
+	CloseHandle(mappedFile->file);
+#else
+	munmap((void*)mappedFile->data, mappedFile->size);
+#endif
+	mappedFile->data = NULL;
+}
+
+/*
+	Function that checks if two paths lead to the same existing file, even when they are written differently.
+	Input: firstPath, secondPath - the paths to compare.
+	Output: SAME_FILE if both name one file, else DIFFERENT_FILES, also if either does not exist.
+*/
+int isSameFile(const char* firstPath, const char* secondPath)
+{
+#ifdef _WIN32
+	BY_HANDLE_FILE_INFORMATION firstInfo, secondInfo;
+	HANDLE first = CreateFileA(firstPath, 0, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, NULL,
+		OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS, NULL);
+	HANDLE second = CreateFileA(secondPath, 0, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, NULL,
+		OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS, NULL);
+	int result = DIFFERENT_FILES;
+
+	if (INVALID_HANDLE_VALUE != first && INVALID_HANDLE_VALUE != second
+		&& GetFileInformationByHandle(first, &firstInfo) && GetFileInformationByHandle(second, &secondInfo)
+		&& firstInfo.dwVolumeSerialNumber == secondInfo.dwVolumeSerialNumber
+		&& firstInfo.nFileIndexHigh == secondInfo.nFileIndexHigh
+		&& firstInfo.nFileIndexLow == secondInfo.nFileIndexLow)
+	{
+		result = SAME_FILE;
+	}
+	if (INVALID_HANDLE_VALUE != first)
+	{
+		CloseHandle(first);
+	}
+	if (INVALID_HANDLE_VALUE != second)
+	{
+		CloseHandle(second);
+	}
+	return result;
+#else
+	struct stat firstStatus, secondStatus;
+
+	if (stat(firstPath, &firstStatus) || stat(secondPath, &secondStatus))
+	{
+		return DIFFERENT_FILES;
+	}
+	return firstStatus.st_dev == secondStatus.st_dev && firstStatus.st_ino == secondStatus.st_ino ? SAME_FILE : DIFFERENT_FILES;
+#endif
+}
+
+/*
+	Function that reads the size and last modification time of a file without opening it.
+	Input: path - the path of the file.
+		   status - where the size and time are stored.
+	Output: FILE_STATUS_READ on success, else FILE_STATUS_NOT_READ.
+*/
+int getFileStatus(const char* path, FileStatus* status)
+{
+#ifdef _WIN32
+	WIN32_FILE_ATTRIBUTE_DATA attributes;
+
+	if (!GetFileAttributesExA(path, GetFileExInfoStandard, &attributes)
+		|| (attributes.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY))
+	{
+		return FILE_STATUS_NOT_READ;
+	}
+	status->size = ((unsigned long long)attributes.nFileSizeHigh << 32) | attributes.nFileSizeLow;
+	status->modifiedTime = ((unsigned long long)attributes.ftLastWriteTime.dwHighDateTime << 32)
+		| attributes.ftLastWriteTime.dwLowDateTime;
+	return FILE_STATUS_READ;
+#else
+	struct stat fileStatus;
+
+	if (stat(path, &fileStatus) || !S_ISREG(fileStatus.st_mode))
+	{
+		return FILE_STATUS_NOT_READ;
+	}
+	status->size = (unsigned long long)fileStatus.st_size;
+	status->modifiedTime = (unsigned long long)fileStatus.st_mtime;
+	return FILE_STATUS_READ;
+#endif
+}
+
+/*
+	Function that makes sure a directory exists, creating it if needed. Only the last directory of the path is created.
+	Input: path - the path of the directory.
+	Output: DIRECTORY_READY if the directory exists now, else DIRECTORY_NOT_READY.
+*/
+int createDirectory(const char* path)
+{
+#ifdef _WIN32
+	DWORD attributes = INVALID_FILE_ATTRIBUTES;
+
+	if (!CreateDirectoryA(path, NULL) && ERROR_ALREADY_EXISTS != GetLastError())
+	{
+		return DIRECTORY_NOT_READY;
+	}
+	attributes = GetFileAttributesA(path);
+	return INVALID_FILE_ATTRIBUTES != attributes && (attributes & FILE_ATTRIBUTE_DIRECTORY) ? DIRECTORY_READY : DIRECTORY_NOT_READY;
+#else
+	struct stat status;
+
+	if (mkdir(path, DIRECTORY_PERMISSIONS) && EEXIST != errno)
+	{
+		return DIRECTORY_NOT_READY;
+	}
+	return !stat(path, &status) && S_ISDIR(status.st_mode) ? DIRECTORY_READY : DIRECTORY_NOT_READY;
+#endif
+}
+
+/*
+	Function that moves a file over another one in a single step, so readers see either the old file or the new one.
+	Input: sourcePath - the file to move, usually a temporary file that was just written.
+		   destinationPath - where it is moved, an existing file there is replaced.
+	Output: FILE_REPLACED on success, else FILE_NOT_REPLACED.
+*/
+int replaceFile(const char* sourcePath, const char* destinationPath)
+{
+#ifdef _WIN32
+	return MoveFileExA(sourcePath, destinationPath, MOVEFILE_REPLACE_EXISTING) ? FILE_REPLACED : FILE_NOT_REPLACED;
+#else
+	return rename(sourcePath, destinationPath) ? FILE_NOT_REPLACED : FILE_REPLACED;
+#endif
+}
+
+/*
+	Function that calls a function for every regular file directly inside a directory, in no particular order.
+	Input: path - the path of the directory.
+		   function - called with the file's name, without the directory, and its size and modification time.
+		   context - handed to function.
+	Output: DIRECTORY_READY if the directory was read, else DIRECTORY_NOT_READY.
+*/
+int listDirectory(const char* path, DirectoryEntryFunction function, void* context)
+{
+#ifdef _WIN32
+	WIN32_FIND_DATAA found;
+	FileStatus status;
+	HANDLE search = INVALID_HANDLE_VALUE;
+	char* pattern = (char*)malloc(strlen(path) + strlen(ALL_FILES_PATTERN) + INC);
+
+	if (!pattern)
+	{
+		printf("Memory allocation failed!\n");
+		exit(MEMORY_ALLOCATION_ERROR_CODE);
+	}
+	strcpy(pattern, path);
+	strcat(pattern, ALL_FILES_PATTERN);
+	search = FindFirstFileA(pattern, &found);
+	free(pattern);
+	if (INVALID_HANDLE_VALUE == search)
+	{
+		return DIRECTORY_NOT_READY;
+	}
+	do
+	{
+		if (!(found.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY))
+		{
+			status.size = ((unsigned long long)found.nFileSizeHigh << 32) | found.nFileSizeLow;
+			status.modifiedTime = ((unsigned long long)found.ftLastWriteTime.dwHighDateTime << 32) | found.ftLastWriteTime.dwLowDateTime;
+			function(context, found.cFileName, &status);
+		}
+	} while (FindNextFileA(search, &found));
+	FindClose(search);
+	return DIRECTORY_READY;
+#else
+	DIR* directory = opendir(path);
+	struct dirent* found = NULL;
+	FileStatus status;
+	char* filePath = NULL;
+
+	if (!directory)
+	{
+		return DIRECTORY_NOT_READY;
+	}
+	while ((found = readdir(directory)) != NULL)
+	{
+		filePath = (char*)malloc(strlen(path) + strlen(PATH_SEPARATOR) + strlen(found->d_name) + INC);
+		if (!filePath)
+		{
+			printf("Memory allocation failed!\n");
+			exit(MEMORY_ALLOCATION_ERROR_CODE);
+		}
+		strcpy(filePath, path);
+		strcat(filePath, PATH_SEPARATOR);
+		strcat(filePath, found->d_name);
+		if (FILE_STATUS_READ == getFileStatus(filePath, &status))
+		{
+			function(context, found->d_name, &status);
+		}
+		free(filePath);
+	}
+	closedir(directory);
+	return DIRECTORY_READY;
+#endif
+}
+
+/*
+	Function that sets the modification time of a file to now, used to remember when a cached file was last used.
+	Input: path - the path of the file.
+	Output: None.
+*/
+void touchFile(const char* path)
+{
+#ifdef _WIN32
+	FILETIME now;
+	HANDLE file = CreateFileA(path, FILE_WRITE_ATTRIBUTES, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, NULL,
+		OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+
+	if (INVALID_HANDLE_VALUE == file)
+	{
+		return;
+	}
+	GetSystemTimeAsFileTime(&now);
+	SetFileTime(file, NULL, NULL, &now);
+	CloseHandle(file);
+#else
+	utime(path, NULL);
+#endif
+}
@@ -0,0 +1,136 @@
+/*********************************
+*		GIF EDITOR PROJECT       *
+*   Platform Layer Declaration   *
+**********************************/
+
+#ifndef PLATFORMH
+#define PLATFORMH
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+#include <stddef.h>
+
+#define MICROSECONDS_IN_SECOND 1000000ULL
+#define MICROSECONDS_IN_MILLISECOND 1000ULL
+#define NANOSECONDS_IN_MICROSECOND 1000ULL
+
+#define THREAD_CREATED 1
+#define THREAD_NOT_CREATED 0
+
+#define FILE_MAPPED 1
+#define FILE_NOT_MAPPED 0
+
+#define SAME_FILE 1
+#define DIFFERENT_FILES 0
+
+#define FILE_STATUS_READ 1
+#define FILE_STATUS_NOT_READ 0
+
+#define DIRECTORY_READY 1
+#define DIRECTORY_NOT_READY 0
+
+#define FILE_REPLACED 1
+#define FILE_NOT_REPLACED 0
+
+#define CPU_FEATURE_SSE2 1
+#define CPU_FEATURE_AVX2 2
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define PLATFORM_X86
+#endif
+
+// Lets a function use newer vector instructions while the rest of the program is built for older processors
+#if defined(__GNUC__)
+#define TARGET_SSE2 __attribute__((target("sse2")))
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define TARGET_SSE2
+#define TARGET_AVX2
+#endif
+
+#ifdef _WIN32
+#define THREAD_LOCAL __declspec(thread)
+typedef HANDLE Thread;
+typedef CRITICAL_SECTION Mutex;
+typedef CONDITION_VARIABLE Condition;
+#else
+#define THREAD_LOCAL __thread
+typedef pthread_t Thread;
+typedef pthread_mutex_t Mutex;
+typedef pthread_cond_t Condition;
+#endif
+
+typedef void (*ThreadFunction)(void* argument);
+
+// Size and last modification time of a file, the time is only compared, its unit depends on the platform
+typedef struct FileStatus
+{
+	unsigned long long	size;
+	unsigned long long	modifiedTime;
+} FileStatus;
+
+typedef void (*DirectoryEntryFunction)(void* context, const char* name, const FileStatus* status);
+
+// Read-only view of a whole file mapped into memory
+typedef struct MappedFile
+{
+	const unsigned char*	data;
+	size_t			size;
+#ifdef _WIN32
+	HANDLE			file;
+	HANDLE			mapping;
+#endif
+} MappedFile;
+
+int createThread(Thread* thread, ThreadFunction function, void* argument);
+
+void joinThread(Thread* thread);
+
+void initMutex(Mutex* mutex);
+
+void destroyMutex(Mutex* mutex);
+
+void lockMutex(Mutex* mutex);
+
+void unlockMutex(Mutex* mutex);
+
+void initCondition(Condition* condition);
+
+void destroyCondition(Condition* condition);
+
+void waitCondition(Condition* condition, Mutex* mutex);
+
+void signalCondition(Condition* condition);
+
+void broadcastCondition(Condition* condition);
+
+unsigned long long getMonotonicTimeMicroseconds(void);
+
+int getProcessorCount(void);
+
+unsigned long getProcessId(void);
+
+int getCpuFeatures(void);
+
+int mapFile(const char* path, MappedFile* mappedFile);
+
+void unmapFile(MappedFile* mappedFile);
+
+int isSameFile(const char* firstPath, const char* secondPath);
+
+int getFileStatus(const char* path, FileStatus* status);
+
+int createDirectory(const char* path);
+
+int replaceFile(const char* sourcePath, const char* destinationPath);
+
+int listDirectory(const char* path, DirectoryEntryFunction function, void* context);
+
+void touchFile(const char* path);
+
+#endif
@@ -0,0 +1,265 @@
+/*********************************
+*		GIF EDITOR PROJECT       *
+*       Playback Pipeline        *
+**********************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "playbackPipeline.h"
+#include "canvas.h"
+
+static void decodeFrames(void* argument);
+static int pushSlot(PlaybackPipeline* pipeline, PlaybackSlot* slot, unsigned int generation);
+static void advancePosition(PlaybackPipeline* pipeline);
+static void releaseQueuedSlots(PlaybackPipeline* pipeline);
+
+/*
+	Function that starts decoding frames ahead of the display loop on a background thread.
+	Every frame is read and the timeline is indexed first, so during playback both threads only read the list
+	and any frame or time can be reached directly.
+	Input: list - the frames to play.
+		   cache - the decoded image cache the decoder goes through.
+		   proxies - the previews folder to play downscaled previews from, or NULL to play the images at full resolution.
+					 With a canvas set, the images or previews are fitted to it.
+		   repeatCount - how many times the whole list is played, or PLAYBACK_LOOP_FOREVER.
+		   decodeAhead - the number of decoded frames the ring buffer holds.
+		   startTime - milliseconds into the timeline to start at, the first play starts there and the next ones from the beginning.
+		   A time past the end wraps around, like it would while looping.
+	Output: pointer to the running pipeline.
+*/
+PlaybackPipeline* startPlaybackPipeline(FrameList* list, ImageCache* cache, ProxyCache* proxies, int repeatCount, int decodeAhead, uint64_t startTime)
+{
+	PlaybackPipeline* pipeline = (PlaybackPipeline*)malloc(sizeof(PlaybackPipeline));
+	uint64_t totalTime = getTimelineDuration(list);
+	if (!pipeline)
+	{
+		printf("Memory allocation failed!\n");
+		exit(MEMORY_ALLOCATION_ERROR_CODE);
+	}
+	pipeline->slots = (PlaybackSlot*)malloc(sizeof(PlaybackSlot) * decodeAhead);
+	if (!pipeline->slots)
+	{
+		printf("Memory allocation failed!\n");
+		exit(MEMORY_ALLOCATION_ERROR_CODE);
+	}
+
+	pipeline->list = list;
+	pipeline->cache = cache;
+	pipeline->proxies = proxies;
+	pipeline->repeatCount = repeatCount;
+	pipeline->nextIndex = 0;
+	pipeline->nextPass = 0;
+	pipeline->nextSkipped = 0;
+	pipeline->generation = 0;
+	pipeline->reachedEnd = !frameNodeListLength(list);
+	if (totalTime)
+	{
+		startTime %= totalTime;
+		pipeline->nextIndex = findFrameAtTime(list, startTime);
+		pipeline->nextSkipped = (unsigned int)(startTime - getFrameStartTime(list, pipeline->nextIndex));
+	}
+	pipeline->capacity = decodeAhead;
+	pipeline->readIndex = 0;
+	pipeline->writeIndex = 0;
+	pipeline->count = 0;
+	pipeline->decoderFinished = FALSE;
+	pipeline->stopRequested = FALSE;
+	initMutex(&pipeline->lock);
+	initCondition(&pipeline->slotFilled);
+	initCondition(&pipeline->slotFreed);
+
+	pipeline->decoderStarted = createThread(&pipeline->decoder, decodeFrames, pipeline);
+	if (THREAD_NOT_CREATED == pipeline->decoderStarted)
+	{
+		pipeline->decoderFinished = TRUE;
+		printf("Could not start the decoder thread!\n");
+	}
+	return pipeline;
+}
+
+/*
+	Function that waits for the next decoded frame in playback order.
+	Input: pipeline - the running pipeline.
+		   slot - where the next frame will be stored. slot->entry is NULL if the image could not be decoded.
+	Output: TRUE if a frame was taken, FALSE when playback reached its end.
+*/
+int takeNextPlaybackSlot(PlaybackPipeline* pipeline, PlaybackSlot* slot)
+{
+	lockMutex(&pipeline->lock);
+	while (!pipeline->count && !pipeline->reachedEnd && !pipeline->decoderFinished)
+	{
+		waitCondition(&pipeline->slotFilled, &pipeline->lock);
+	}
+	if (!pipeline->count)
+	{
+		unlockMutex(&pipeline->lock);
+		return FALSE;
+	}
+	*slot = pipeline->slots[pipeline->readIndex];
+	pipeline->readIndex = (pipeline->readIndex + INC) % pipeline->capacity;
+	pipeline->count--;
+	signalCondition(&pipeline->slotFreed);
+	unlockMutex(&pipeline->lock);
+	return TRUE;
+}
+
+/*
+	Function that hands a displayed frame's image back to the cache.
+	Input: pipeline - the running pipeline.
+		   slot - the slot taken with takeNextPlaybackSlot.
+	Output: None.
+*/
+void finishPlaybackSlot(PlaybackPipeline* pipeline, PlaybackSlot* slot)
+{
+	releaseCachedImage(pipeline->cache, &slot->entry);
+}
+
+/*
+	Function that makes playback continue from another frame. The decoded frames still waiting are released
+	and the decoder starts over from the new position, a frame it was decoding meanwhile is dropped.
+	Recently shown frames are usually still in the image cache, so seeking back does not decode them again.
+	Input: pipeline - the running pipeline.
+		   index - index of the frame to continue from, from 0 to length - 1.
+		   pass - which play of the list that frame belongs to, from 0.
+		   skipped - milliseconds of the frame that are already over, taken out of its duration.
+	Output: None.
+*/
+void seekPlaybackPipeline(PlaybackPipeline* pipeline, int index, int pass, unsigned int skipped)
+{
+	lockMutex(&pipeline->lock);
+	releaseQueuedSlots(pipeline);
+	pipeline->nextIndex = index;
+	pipeline->nextPass = pass;
+	pipeline->nextSkipped = skipped;
+	pipeline->generation++;
+	pipeline->reachedEnd = FALSE;
+	broadcastCondition(&pipeline->slotFreed);
+	unlockMutex(&pipeline->lock);
+}
+
+/*
+	Function that stops the decoder thread, releases every frame still waiting and frees the pipeline.
+	Input: pipeline - pointer to the pipeline to stop.
+	Output: None.
+*/
+void stopPlaybackPipeline(PlaybackPipeline** pipeline)
+{
+	PlaybackSlot slot;
+
+	if (!*pipeline)
+	{
+		return;
+	}
+	lockMutex(&(*pipeline)->lock);
+	(*pipeline)->stopRequested = TRUE;
+	broadcastCondition(&(*pipeline)->slotFreed);
+	unlockMutex(&(*pipeline)->lock);
+
+	while (takeNextPlaybackSlot(*pipeline, &slot))
+	{
+		finishPlaybackSlot(*pipeline, &slot);
+	}
+	if (THREAD_CREATED == (*pipeline)->decoderStarted)
+	{
+		joinThread(&(*pipeline)->decoder);
+	}
+
+	destroyCondition(&(*pipeline)->slotFilled);
+	destroyCondition(&(*pipeline)->slotFreed);
+	destroyMutex(&(*pipeline)->lock);
+	free((*pipeline)->slots);
+	free(*pipeline);
+	*pipeline = NULL;
+}
+
+/*
+	Decoder thread: decodes frames from its position on and pushes them into the ring,
+	until it is stopped. At the end of the last play it waits, a seek can still move it back.
+*/
+static void decodeFrames(void* argument)
+{
+	PlaybackPipeline* pipeline = (PlaybackPipeline*)argument;
+	PlaybackSlot slot;
+	unsigned int generation = 0, skipped = 0;
+	int lastFrame = FALSE;
+
+	lockMutex(&pipeline->lock);
+	while (!pipeline->stopRequested)
+	{
+		if (pipeline->reachedEnd)
+		{
+			waitCondition(&pipeline->slotFreed, &pipeline->lock);
+			continue;
+		}
+		slot.index = pipeline->nextIndex;
+		slot.pass = pipeline->nextPass;
+		skipped = pipeline->nextSkipped;
+		generation = pipeline->generation;
+		advancePosition(pipeline);
+		lastFrame = pipeline->repeatCount != PLAYBACK_LOOP_FOREVER && pipeline->nextPass >= pipeline->repeatCount;
+		unlockMutex(&pipeline->lock);
+
+		slot.frame = getFrameAtIndex(pipeline->list, slot.index);
+		slot.duration = slot.frame->duration - skipped;
+		slot.entry = acquireCanvasImage(pipeline->cache, pipeline->proxies, slot.frame, &pipeline->list->canvas);
+
+		lockMutex(&pipeline->lock);
+		if (pushSlot(pipeline, &slot, generation) && lastFrame)
+		{
+			pipeline->reachedEnd = TRUE;
+			broadcastCondition(&pipeline->slotFilled);
+		}
+	}
+	pipeline->decoderFinished = TRUE;
+	broadcastCondition(&pipeline->slotFilled);
+	unlockMutex(&pipeline->lock);
+}
+
+/*
+	Waits for a free slot and stores the decoded frame in it, called with the lock held.
+	Returns FALSE (and releases the image) if playback was stopped or moved by a seek meanwhile.
+*/
+static int pushSlot(PlaybackPipeline* pipeline, PlaybackSlot* slot, unsigned int generation)
+{
+	while (pipeline->count == pipeline->capacity && !pipeline->stopRequested && generation == pipeline->generation)
+	{
+		waitCondition(&pipeline->slotFreed, &pipeline->lock);
+	}
+	if (pipeline->stopRequested || generation != pipeline->generation)
+	{
+		releaseCachedImage(pipeline->cache, &slot->entry);
+		return FALSE;
+	}
+	pipeline->slots[pipeline->writeIndex] = *slot;
+	pipeline->writeIndex = (pipeline->writeIndex + INC) % pipeline->capacity;
+	pipeline->count++;
+	signalCondition(&pipeline->slotFilled);
+	return TRUE;
+}
+
+/*
+	Moves the decoder's position to the frame after it, wrapping to the next play at the end of the list.
+*/
+static void advancePosition(PlaybackPipeline* pipeline)
+{
+	pipeline->nextSkipped = 0;
+	pipeline->nextIndex++;
+	if (pipeline->nextIndex == frameNodeListLength(pipeline->list))
+	{
+		pipeline->nextIndex = 0;
+		pipeline->nextPass++;
+	}
+}
+
+/*
+	Hands every frame waiting in the ring back to the cache, called with the lock held.
+*/
+static void releaseQueuedSlots(PlaybackPipeline* pipeline)
+{
+	while (pipeline->count)
+	{
+		releaseCachedImage(pipeline->cache, &pipeline->slots[pipeline->readIndex].entry);
+		pipeline->readIndex = (pipeline->readIndex + INC) % pipeline->capacity;
+		pipeline->count--;
+	}
+}
@@ -0,0 +1,64 @@
+/*********************************
+*		GIF EDITOR PROJECT       *
+* Playback Pipeline Declaration  *
+**********************************/
+
+#ifndef PLAYBACKPIPELINEH
+#define PLAYBACKPIPELINEH
+
+#include "linkedList.h"
+#include "imageCache.h"
+#include "proxyCache.h"
+#include "platform.h"
+
+#define PLAYBACK_DECODE_AHEAD 8
+#define PLAYBACK_LOOP_FOREVER 0
+
+// A decoded frame waiting in the ring buffer to be displayed
+typedef struct PlaybackSlot
+{
+	const Frame*		frame;
+	ImageCacheEntry*	entry;
+	int			index;
+	int			pass;
+	unsigned int		duration;
+} PlaybackSlot;
+
+// Ring buffer filled by a background decoder thread walking the frames in order.
+// A seek empties the ring and moves the decoder's position, the generation tells frames decoded before it apart.
+typedef struct PlaybackPipeline
+{
+	FrameList*	list;
+	ImageCache*	cache;
+	ProxyCache*	proxies;
+	int		repeatCount;
+	int		nextIndex;
+	int		nextPass;
+	unsigned int	nextSkipped;
+	unsigned int	generation;
+	int		reachedEnd;
+	PlaybackSlot*	slots;
+	int		capacity;
+	int		readIndex;
+	int		writeIndex;
+	int		count;
+	int		decoderStarted;
+	int		decoderFinished;
+	int		stopRequested;
+	Mutex		lock;
+	Condition	slotFilled;
+	Condition	slotFreed;
+	Thread		decoder;
+} PlaybackPipeline;
+
+PlaybackPipeline* startPlaybackPipeline(FrameList* list, ImageCache* cache, ProxyCache* proxies, int repeatCount, int decodeAhead, uint64_t startTime);
+
+int takeNextPlaybackSlot(PlaybackPipeline* pipeline, PlaybackSlot* slot);
+
+void finishPlaybackSlot(PlaybackPipeline* pipeline, PlaybackSlot* slot);
+
+void seekPlaybackPipeline(PlaybackPipeline* pipeline, int index, int pass, unsigned int skipped);
+
+void stopPlaybackPipeline(PlaybackPipeline** pipeline);
+
+#endif
@@ -0,0 +1,484 @@
+/*********************************
+*		GIF EDITOR PROJECT       *
+*         Project Files          *
+**********************************/
+
+#define _CRT_SECURE_NO_WARNINGS
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "project.h"
+#include "bundle.h"
+#include "effects.h"
+#include "canvas.h"
+#include "hash.h"
+
+#define ONE_ELEMENT 1
+#define WRITE_BINARY_MODE "wb"
+#define READ_BINARY_MODE "rb"
+#define NOT_A_PROJECT_FILE -1
+#define DAMAGED_PROJECT_FILE -2
+#define NEWER_PROJECT_FILE -3
+
+static int openProjectFile(ProjectFile* project);
+static void readProjectFrame(void* context, int index, Frame* frame);
+static void closeProjectFile(void* context);
+static const char* getProjectString(const ProjectFile* project, uint64_t offset);
+static void readProjectEffects(const ProjectFile* project, uint32_t offset, Frame* frame);
+static FrameList* loadVersion1Project(char* projectFilePath);
+static char* readStringRecord(FILE* file, char* buffer, size_t* capacity, size_t length);
+
+/**
+*	Function that creates full path to a file using given folder directory, project file name and extenstion.
+*   Input: folderDirectory - the folder directory of the file.
+*			projectFileName - the file name of the project.
+*			extension - the file extesntion of the project.
+*	Output: full path that has been created according to given parameters.
+*/
+char* createFullPath(char* folderDirectory, char* projectFileName, char* extension)
+{
+	char* fullPath = NULL;
+	size_t totalLength = strlen(folderDirectory) + strlen(projectFileName) + strlen(extension) + INC;
+
+	fullPath = (char*)malloc(sizeof(char) * totalLength);
+	if (!fullPath)
+	{
+		printf("Memory allocation error!\n");
+		exit(MEMORY_ALLOCATION_ERROR_CODE);
+	}
+
+	strcpy(fullPath, folderDirectory);
+	strcat(fullPath, projectFileName);
+	strcat(fullPath, extension);
+
+	return fullPath;
+}
+
+/*
+	Function that saves the project in the given directory as a version 4 project file.
+	Input: list - FrameList of the frames data.
+		   directory - a folder directory in which it is possible to save the project.
+		   projectFileName - the file name of the project in which the data shall be saved.
+	Output: PROJECT_SAVED, or PROJECT_NOT_SAVED if the file could not be written.
+*/
+int saveProject(FrameList* list, char* directory, char* projectFileName)
+{
+	ProjectHeader header;
+	ProjectRecord record;
+	FILE* file = NULL;
+	Frame* frame = NULL;
+	char* fullPath = createFullPath(directory, projectFileName, PROJECT_EXTENSION);
+	uint64_t stringOffset = 0, effectsSize = sizeof(ProjectEffects);
+	int saved = PROJECT_SAVED;
+	int i = 0;
+
+	releaseSourceIfSameFile(list, fullPath);
+	file = fopen(fullPath, WRITE_BINARY_MODE);
+	free(fullPath);
+	if (!file)
+	{
+		printf("Could not open file!\n");
+		return PROJECT_NOT_SAVED;
+	}
+
+	header.magic = PROJECT_MAGIC;
+	header.version = PROJECT_VERSION;
+	header.headerSize = sizeof(ProjectHeader);
+	header.recordSize = sizeof(ProjectRecord);
+	header.frameCount = frameNodeListLength(list);
+	header.recordsOffset = sizeof(ProjectHeader);
+	header.stringsOffset = header.recordsOffset + header.frameCount * sizeof(ProjectRecord);
+	header.stringsSize = 0;
+	for (i = 0; i < frameNodeListLength(list); i++)
+	{
+		frame = getFrameAtIndex(list, i);
+		header.stringsSize += strlen(frame->name) + INC + strlen(frame->path) + INC;
+	}
+	header.effectsOffset = ALIGN_PROJECT_EFFECTS(header.stringsOffset + header.stringsSize);
+	header.canvas = list->canvas;
+	header.reserved = 0;
+	fwrite(&header, sizeof(ProjectHeader), ONE_ELEMENT, file);
+
+	for (i = 0; i < frameNodeListLength(list); i++)
+	{
+		frame = getFrameAtIndex(list, i);
+		record.nameOffset = stringOffset;
+		stringOffset += strlen(frame->name) + INC;
+		record.pathOffset = stringOffset;
+		stringOffset += strlen(frame->path) + INC;
+		record.duration = frame->duration;
+		record.effectsOffset = placeProjectEffects(frame, &effectsSize);
+		fwrite(&record, sizeof(ProjectRecord), ONE_ELEMENT, file);
+	}
+	for (i = 0; i < frameNodeListLength(list); i++)
+	{
+		frame = getFrameAtIndex(list, i);
+		fwrite(frame->name, sizeof(char), strlen(frame->name) + INC, file);
+		fwrite(frame->path, sizeof(char), strlen(frame->path) + INC, file);
+	}
+	writeProjectEffects(file, list, header.stringsOffset + header.stringsSize);
+
+	// The size of the effects section is known only once every record has been placed
+	header.effectsSize = effectsSize;
+	fseek(file, 0, SEEK_SET);
+	fwrite(&header, sizeof(ProjectHeader), ONE_ELEMENT, file);
+
+	if (ferror(file))
+	{
+		saved = PROJECT_NOT_SAVED;
+	}
+	if (fclose(file))
+	{
+		saved = PROJECT_NOT_SAVED;
+	}
+	return saved;
+}
+
+/*
+	Function that loads a project and returns FrameList that consists of the loaded frames data.
+	A version 2, 3 or 4 file or a bundle is mapped into memory and only its header is checked here, so opening takes
+	the same time for any number of frames. Frames are read from the mapping when they are first used,
+	and the images embedded in a bundle are decoded straight from it.
+	Older files without a header are read whole.
+	Input: projectFilePath - the file path of the project to load.
+	Output: FrameList of the frames of the project, or NULL if the file could not be read.
+*/
+FrameList* loadProject(char* projectFilePath)
+{
+	ProjectFile* project = (ProjectFile*)malloc(sizeof(ProjectFile));
+	FrameList* list = NULL;
+	FrameSource source;
+	int frameCount = NOT_A_PROJECT_FILE;
+
+	if (!project)
+	{
+		printf("Memory allocation failed!\n");
+		exit(MEMORY_ALLOCATION_ERROR_CODE);
+	}
+
+	if (FILE_MAPPED == mapFile(projectFilePath, &project->mapping))
+	{
+		frameCount = openProjectFile(project);
+		if (frameCount >= 0)
+		{
+			project->path = (char*)malloc(strlen(projectFilePath) + INC);
+			if (!project->path)
+			{
+				printf("Memory allocation failed!\n");
+				exit(MEMORY_ALLOCATION_ERROR_CODE);
+			}
+			strcpy(project->path, projectFilePath);
+			initArena(&project->keys);
+			source.context = project;
+			source.path = project->path;
+			source.readFrame = readProjectFrame;
+			source.close = closeProjectFile;
+			list = createFrameList();
+			list->canvas = project->canvas;
+			attachFrameSource(list, &source, frameCount);
+			return list;
+		}
+		unmapFile(&project->mapping);
+	}
+	free(project);
+
+	if (DAMAGED_PROJECT_FILE == frameCount)
+	{
+		printf("The project file is damaged!\n");
+		return NULL;
+	}
+	if (NEWER_PROJECT_FILE == frameCount)
+	{
+		printf("The project file was saved by a newer version of the editor!\n");
+		return NULL;
+	}
+	return loadVersion1Project(projectFilePath);
+}
+
+/*
+	Function that reads a list's frames out of the file they are mapped from, if that file is about to be written.
+	Input: list - the FrameList being saved.
+		   path - the path of the file that will be written.
+	Output: None.
+*/
+void releaseSourceIfSameFile(FrameList* list, const char* path)
+{
+	if (list->source.path && SAME_FILE == isSameFile(list->source.path, path))
+	{
+		releaseFrameSource(list);
+	}
+}
+
+/*
+	Function that gives a frame's effects their place in the effects section of the file being saved.
+	Input: frame - the frame being saved.
+		   effectsSize - pointer to the size of the effects section so far, which starts as sizeof(ProjectEffects)
+						 for the empty list, grown by the frame's effects.
+	Output: the offset of the frame's effects in the section, NO_PROJECT_EFFECTS if it has none.
+*/
+uint32_t placeProjectEffects(const Frame* frame, uint64_t* effectsSize)
+{
+	uint32_t offset = NO_PROJECT_EFFECTS;
+
+	if (frame->effectCount)
+	{
+		offset = (uint32_t)*effectsSize;
+		*effectsSize += sizeof(ProjectEffects) + sizeof(Effect) * frame->effectCount;
+	}
+	return offset;
+}
+
+/*
+	Function that writes the effects section: the empty list followed by the effects of each frame that has any,
+	in the order placeProjectEffects placed them.
+	Input: file - the file being saved.
+		   list - FrameList of the frames being saved.
+		   position - where the previous section ended, the effects section starts at the next aligned offset.
+	Output: None.
+*/
+void writeProjectEffects(FILE* file, FrameList* list, uint64_t position)
+{
+	static const unsigned char padding[PROJECT_EFFECTS_ALIGNMENT] = { 0 };
+	ProjectEffects effects;
+	Frame* frame = NULL;
+	int i = 0;
+
+	fwrite(padding, sizeof(unsigned char), (size_t)(ALIGN_PROJECT_EFFECTS(position) - position), file);
+	effects.count = 0;
+	effects.reserved = 0;
+	fwrite(&effects, sizeof(ProjectEffects), ONE_ELEMENT, file);
+	for (i = 0; i < frameNodeListLength(list); i++)
+	{
+		frame = getFrameAtIndex(list, i);
+		if (frame->effectCount)
+		{
+			effects.count = (uint32_t)frame->effectCount;
+			fwrite(&effects, sizeof(ProjectEffects), ONE_ELEMENT, file);
+			fwrite(frame->effects, sizeof(Effect), frame->effectCount, file);
+		}
+	}
+}
+
+/*
+	Checks the header of a mapped project file and finds its record table, string section and effects section.
+	Returns the number of frames, or why the file can not be opened lazily.
+	The records themselves are checked only when read, an offset outside the string section reads as an empty string.
+*/
+static int openProjectFile(ProjectFile* project)
+{
+	ProjectHeader header;
+	size_t fileSize = project->mapping.size;
+
+	if (fileSize < PROJECT_VERSION_2_HEADER_SIZE)
+	{
+		return NOT_A_PROJECT_FILE;
+	}
+	// Version 2 and 3 headers are shorter, the fields they do not have read as zero, which is also NO_CANVAS
+	memset(&header, 0, sizeof(ProjectHeader));
+	memcpy(&header, project->mapping.data, PROJECT_VERSION_2_HEADER_SIZE);
+	if (header.headerSize > PROJECT_VERSION_2_HEADER_SIZE && header.headerSize <= fileSize)
+	{
+		memcpy(&header, project->mapping.data, header.headerSize < sizeof(ProjectHeader) ? header.headerSize : sizeof(ProjectHeader));
+	}
+	if (PROJECT_MAGIC != header.magic && BUNDLE_MAGIC != header.magic)
+	{
+		return NOT_A_PROJECT_FILE;
+	}
+	project->hasImages = BUNDLE_MAGIC == header.magic;
+	if (header.version > (project->hasImages ? BUNDLE_VERSION : PROJECT_VERSION))
+	{
+		return NEWER_PROJECT_FILE;
+	}
+	if (header.headerSize < PROJECT_VERSION_2_HEADER_SIZE || header.headerSize > fileSize
+		|| header.recordSize < (project->hasImages ? sizeof(BundleRecord) : sizeof(ProjectRecord))
+		|| header.frameCount > INT32_MAX
+		|| header.recordsOffset > fileSize
+		|| header.frameCount > (fileSize - header.recordsOffset) / header.recordSize
+		|| header.stringsOffset > fileSize || header.stringsSize > fileSize - header.stringsOffset
+		|| (header.frameCount && (!header.stringsSize
+			|| project->mapping.data[header.stringsOffset + header.stringsSize - INC] != NULL_CHAR))
+		|| header.effectsOffset > fileSize || header.effectsSize > fileSize - header.effectsOffset
+		|| header.effectsOffset % PROJECT_EFFECTS_ALIGNMENT
+		|| (isCanvasSet(&header.canvas) && !isCanvasValid(&header.canvas)))
+	{
+		return DAMAGED_PROJECT_FILE;
+	}
+
+	project->records = project->mapping.data + header.recordsOffset;
+	project->recordSize = header.recordSize;
+	project->strings = (const char*)project->mapping.data + header.stringsOffset;
+	project->stringsSize = (size_t)header.stringsSize;
+	project->effects = project->mapping.data + header.effectsOffset;
+	project->effectsSize = (size_t)header.effectsSize;
+	project->canvas = header.canvas;
+	return (int)header.frameCount;
+}
+
+/*
+	FrameSource function: fills in a frame from its record, the strings, effects and a bundle's image are used in place in the mapping.
+	An image outside the file is ignored and the frame falls back to its path.
+	An embedded image is cached under the bundle's path, its offset and a hash of its bytes, not under the frame's path,
+	so images of other bundles or of the file at that path are never mixed up with it.
+*/
+static void readProjectFrame(void* context, int index, Frame* frame)
+{
+	ProjectFile* project = (ProjectFile*)context;
+	BundleRecord record;
+
+	memcpy(&record, project->records + (size_t)index * project->recordSize,
+		project->hasImages ? sizeof(BundleRecord) : sizeof(ProjectRecord));
+	frame->name = (char*)getProjectString(project, record.frame.nameOffset);
+	frame->duration = record.frame.duration;
+	frame->path = (char*)getProjectString(project, record.frame.pathOffset);
+	frame->imageData = NULL;
+	frame->imageSize = 0;
+	frame->imageKey = frame->path;
+	if (project->hasImages && record.imageSize && record.imageSize <= BUNDLE_MAX_IMAGE_SIZE
+		&& record.imageOffset <= project->mapping.size && record.imageSize <= project->mapping.size - record.imageOffset)
+	{
+		frame->imageData = project->mapping.data + record.imageOffset;
+		frame->imageSize = (size_t)record.imageSize;
+		frame->imageKey = (char*)arenaAllocate(&project->keys, sizeof(char) * (strlen(project->path) + strlen(BUNDLE_IMAGE_KEY_FORMAT)
+			+ BUNDLE_IMAGE_KEY_DIGITS + INC));
+		sprintf(frame->imageKey, BUNDLE_IMAGE_KEY_FORMAT, project->path, (unsigned long long)record.imageOffset,
+			(unsigned long long)hashBytes(frame->imageData, frame->imageSize, FNV_OFFSET_BASIS_64));
+	}
+	readProjectEffects(project, record.frame.effectsOffset, frame);
+}
+
+/*
+	FrameSource function: unmaps the project file.
+*/
+static void closeProjectFile(void* context)
+{
+	ProjectFile* project = (ProjectFile*)context;
+
+	unmapFile(&project->mapping);
+	freeArena(&project->keys);
+	free(project->path);
+	free(project);
+}
+
+/*
+	Returns the string at an offset of the string section, the section always ends with a null char.
+*/
+static const char* getProjectString(const ProjectFile* project, uint64_t offset)
+{
+	if (offset >= project->stringsSize)
+	{
+		offset = project->stringsSize - INC;
+	}
+	return project->strings + offset;
+}
+
+/*
+	Points a frame at its effects in the effects section. Effects that do not fit in the section
+	or have values out of range are ignored, so a damaged file never gives applyEffects a bad effect.
+*/
+static void readProjectEffects(const ProjectFile* project, uint32_t offset, Frame* frame)
+{
+	ProjectEffects effects;
+	const Effect* first = NULL;
+	uint32_t i = 0;
+
+	frame->effects = NULL;
+	frame->effectCount = 0;
+	if (!offset || offset % sizeof(uint32_t) || project->effectsSize < sizeof(ProjectEffects)
+		|| offset > project->effectsSize - sizeof(ProjectEffects))
+	{
+		return;
+	}
+	memcpy(&effects, project->effects + offset, sizeof(ProjectEffects));
+	if (!effects.count || effects.count > MAX_EFFECTS_PER_FRAME
+		|| effects.count * sizeof(Effect) > project->effectsSize - offset - sizeof(ProjectEffects))
+	{
+		return;
+	}
+	first = (const Effect*)(project->effects + offset + sizeof(ProjectEffects));
+	for (i = 0; i < effects.count; i++)
+	{
+		if (!isEffectValid(&first[i]))
+		{
+			return;
+		}
+	}
+	frame->effects = first;
+	frame->effectCount = (int)effects.count;
+}
+
+/*
+	Reads a version 1 project: records of a size_t length and a name, the duration, a size_t length and a path.
+	A record cut short by the end of the file is dropped.
+*/
+static FrameList* loadVersion1Project(char* projectFilePath)
+{
+	FrameList* list = NULL;
+	FILE* file = NULL;
+	char* name = NULL;
+	char* path = NULL;
+	size_t nameLength = 0, pathLength = 0, nameCapacity = 0, pathCapacity = 0;
+	long fileSize = 0;
+	unsigned int duration = 0;
+
+	file = fopen(projectFilePath, READ_BINARY_MODE);
+	if (!file)
+	{
+		printf("Could not open file!\n");
+		return NULL;
+	}
+	fseek(file, 0, SEEK_END);
+	fileSize = ftell(file);
+	fseek(file, 0, SEEK_SET);
+	list = createFrameList();
+
+	// Read the frames from the file, a record is complete only if all of its fields could be read.
+	// The strings are read into reused buffers and copied into the list's arena.
+	while (ONE_ELEMENT == fread(&nameLength, sizeof(size_t), ONE_ELEMENT, file) && nameLength <= (size_t)fileSize)
+	{
+		name = readStringRecord(file, name, &nameCapacity, nameLength);
+
+		if (ONE_ELEMENT != fread(&duration, sizeof(unsigned int), ONE_ELEMENT, file)
+			|| ONE_ELEMENT != fread(&pathLength, sizeof(size_t), ONE_ELEMENT, file)
+			|| pathLength > (size_t)fileSize)
+		{
+			break;
+		}
+		path = readStringRecord(file, path, &pathCapacity, pathLength);
+		if (feof(file))
+		{
+			break;
+		}
+
+		insertFrameToList(list, createFrame(list, name, duration, path));
+	}
+
+	free(name);
+	free(path);
+	fclose(file);
+	return list;
+}
+
+/*
+	Reads a string of a known length from a project file into a reusable buffer.
+	Input: file - the project file.
+		   buffer - the buffer to reuse, may be NULL.
+		   capacity - pointer to the buffer's capacity, updated if the buffer grows.
+		   length - the length of the string in the file, including the null char.
+	Output: the buffer holding the null terminated string.
+*/
+static char* readStringRecord(FILE* file, char* buffer, size_t* capacity, size_t length)
+{
+	if (length + INC > *capacity)
+	{
+		free(buffer);
+		*capacity = length + INC;
+		buffer = (char*)malloc(sizeof(char) * *capacity);
+		if (!buffer)
+		{
+			printf("Memory allocation error!\n");
+			exit(MEMORY_ALLOCATION_ERROR_CODE);
+		}
+	}
+	buffer[fread(buffer, sizeof(char), length, file)] = NULL_CHAR;
+	return buffer;
+}
@@ -0,0 +1,92 @@
+/*********************************
+*		GIF EDITOR PROJECT       *
+*  Project Files Declaration     *
+**********************************/
+
+#ifndef PROJECTH
+#define PROJECTH
+
+#include <stdio.h>
+#include <stdint.h>
+#include "linkedList.h"
+#include "platform.h"
+
+#define PROJECT_EXTENSION ".bin"
+#define PROJECT_MAGIC 0x4A504547u // "GEPJ" as stored in the file
+#define PROJECT_VERSION 4
+#define PROJECT_VERSION_2_HEADER_SIZE 48
+#define PROJECT_EFFECTS_ALIGNMENT 8
+#define NO_PROJECT_EFFECTS 0
+#define ALIGN_PROJECT_EFFECTS(offset) (((offset) + PROJECT_EFFECTS_ALIGNMENT - 1) / PROJECT_EFFECTS_ALIGNMENT * PROJECT_EFFECTS_ALIGNMENT)
+
+#define PROJECT_SAVED 1
+#define PROJECT_NOT_SAVED 0
+
+// Start of a version 4 project file. All fields are little endian.
+// The file is laid out as: header, frameCount fixed size records, string section, effects section.
+// Version 2 files end the header before effectsOffset and have no effects section,
+// version 3 files end it before canvas and have no canvas.
+typedef struct ProjectHeader
+{
+	uint32_t	magic;
+	uint32_t	version;
+	uint32_t	headerSize;
+	uint32_t	recordSize;
+	uint64_t	frameCount;
+	uint64_t	recordsOffset;
+	uint64_t	stringsOffset;
+	uint64_t	stringsSize;
+	uint64_t	effectsOffset;
+	uint64_t	effectsSize;
+	Canvas		canvas;
+	uint32_t	reserved;
+} ProjectHeader;
+
+// One frame of a project file, the offsets point at null terminated strings in the string section
+// and at the frame's effects in the effects section
+typedef struct ProjectRecord
+{
+	uint64_t	nameOffset;
+	uint64_t	pathOffset;
+	uint32_t	duration;
+	uint32_t	effectsOffset;
+} ProjectRecord;
+
+// The effects of one frame in the effects section, followed by count Effect structs.
+// The section starts with an empty list, which frames without effects point at.
+typedef struct ProjectEffects
+{
+	uint32_t	count;
+	uint32_t	reserved;
+} ProjectEffects;
+
+// An open project file or bundle, the source of a lazily read FrameList
+// keys holds the cache keys of the embedded images read so far
+typedef struct ProjectFile
+{
+	MappedFile		mapping;
+	char*			path;
+	Arena			keys;
+	int			hasImages;
+	const unsigned char*	records;
+	size_t			recordSize;
+	const char*		strings;
+	size_t			stringsSize;
+	const unsigned char*	effects;
+	size_t			effectsSize;
+	Canvas			canvas;
+} ProjectFile;
+
+char* createFullPath(char* folderDirectory, char* projectFileName, char* extension);
+
+int saveProject(FrameList* list, char* directory, char* projectFileName);
+
+FrameList* loadProject(char* projectFilePath);
+
+void releaseSourceIfSameFile(FrameList* list, const char* path);
+
+uint32_t placeProjectEffects(const Frame* frame, uint64_t* effectsSize);
+
+void writeProjectEffects(FILE* file, FrameList* list, uint64_t position);
+
+#endif
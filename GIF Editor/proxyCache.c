@@ -0,0 +1,529 @@
+/*********************************
+*		GIF EDITOR PROJECT       *
+*          Proxy Cache           *
+**********************************/
+
+#define _CRT_SECURE_NO_WARNINGS
+#define CV_IGNORE_DEBUG_BUILD_GUARD
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <opencv2/imgproc/imgproc_c.h>
+#include "proxyCache.h"
+#include "hash.h"
+
+#define BGR_CHANNELS 3
+#define ONE_ELEMENT 1
+#define WRITE_BINARY_MODE "wb"
+#define READ_BINARY_MODE "rb"
+#define PATH_SEPARATOR "/"
+#define PROXY_NAME_FORMAT "%016llx"
+#define PROXY_NAME_DIGITS 16
+#define TEMPORARY_NUMBER_FORMAT ".%lu.%lu"
+#define MAX_NUMBER_DIGITS 21
+#define MIN_IMAGE_SLOTS 16
+
+// Identity of the image a preview is made from and the file the preview is stored in
+typedef struct ProxySource
+{
+	const Frame*	frame;
+	uint64_t	size;
+	uint64_t	time;
+	uint64_t	hash;
+	char*		proxyPath;
+	int		width;
+	int		height;
+} ProxySource;
+
+// A range of images whose previews are prepared on a pool worker
+typedef struct ProxyJob
+{
+	ProxyCache*	proxies;
+	const Frame**	frames;
+	int		frameCount;
+	int		found;
+	int		created;
+	int		unreadable;
+} ProxyJob;
+
+// What loading a preview into the image cache needs
+typedef struct ProxyRequest
+{
+	ProxyCache*	proxies;
+	const Frame*	frame;
+} ProxyRequest;
+
+static void prepareFrames(void* argument);
+static IplImage* loadProxy(void* argument, MappedFile* mapping);
+static int describeSource(const ProxyCache* proxies, const Frame* frame, ProxySource* source);
+static FILE* openProxy(const ProxySource* source, ProxyHeader* header);
+static IplImage* readProxy(ProxySource* source);
+static IplImage* createProxy(ProxyCache* proxies, ProxySource* source);
+static void writeProxy(ProxyCache* proxies, const ProxySource* source, const IplImage* image);
+static const Frame** collectUniqueImages(FrameList* list, int* imageCount);
+static void* allocateOrExit(size_t size);
+
+/*
+	Function that opens the folder of previews, creating it if needed.
+	Input: directory - the folder the previews are kept in.
+	Output: pointer to the new ProxyCache, or NULL if the folder could not be created.
+*/
+ProxyCache* openProxyCache(const char* directory)
+{
+	ProxyCache* proxies = NULL;
+
+	if (DIRECTORY_NOT_READY == createDirectory(directory))
+	{
+		printf("Could not create the previews folder %s\n", directory);
+		return NULL;
+	}
+	proxies = (ProxyCache*)allocateOrExit(sizeof(ProxyCache));
+	proxies->directory = (char*)allocateOrExit(sizeof(char) * (strlen(directory) + INC));
+	strcpy(proxies->directory, directory);
+	proxies->maxWidth = PROXY_MAX_WIDTH;
+	proxies->maxHeight = PROXY_MAX_HEIGHT;
+	proxies->temporaryCount = 0;
+	initMutex(&proxies->lock);
+	return proxies;
+}
+
+/*
+	Function that frees a ProxyCache, the previews stay on the disk.
+	Input: proxies - pointer to the ProxyCache, set to NULL.
+	Output: None.
+*/
+void closeProxyCache(ProxyCache** proxies)
+{
+	if (!*proxies)
+	{
+		return;
+	}
+	destroyMutex(&(*proxies)->lock);
+	free((*proxies)->directory);
+	free(*proxies);
+	*proxies = NULL;
+}
+
+/*
+	Function that makes sure every image of the timeline has a preview on the disk.
+	Missing and outdated previews are made in parallel, each image is decoded once at full resolution,
+	shrunk to fit PROXY_MAX_WIDTH x PROXY_MAX_HEIGHT and stored uncompressed so it loads without decoding.
+	A preview is outdated once the size or modification time of its source file changes.
+	Input: proxies - the previews folder.
+		   list - the frames whose images need previews.
+		   report - where what was done is stored.
+	Output: PROXY_READY if every image has a preview, PROXY_NOT_READY if some images could not be read.
+*/
+int prepareProxies(ProxyCache* proxies, FrameList* list, ProxyReport* report)
+{
+	ThreadPool* pool = NULL;
+	ProxyJob* jobs = NULL;
+	const Frame** frames = NULL;
+	unsigned long long startTime = getMonotonicTimeMicroseconds();
+	int imageCount = 0, jobCount = 0, firstFrame = 0, i = 0;
+
+	frames = collectUniqueImages(list, &imageCount);
+	report->imageCount = imageCount;
+	report->proxiesFound = 0;
+	report->proxiesCreated = 0;
+	report->unreadableImages = 0;
+
+	if (imageCount)
+	{
+		pool = createThreadPool(THREAD_POOL_ONE_PER_PROCESSOR);
+		jobCount = pool->workerCount * PROXY_JOBS_PER_WORKER;
+		jobCount = jobCount > imageCount ? imageCount : jobCount < INC ? INC : jobCount;
+		jobs = (ProxyJob*)allocateOrExit(sizeof(ProxyJob) * jobCount);
+		for (i = 0; i < jobCount; i++)
+		{
+			jobs[i].proxies = proxies;
+			jobs[i].frames = frames + firstFrame;
+			jobs[i].frameCount = (int)((long long)imageCount * (i + INC) / jobCount) - firstFrame;
+			jobs[i].found = 0;
+			jobs[i].created = 0;
+			jobs[i].unreadable = 0;
+			firstFrame += jobs[i].frameCount;
+			submitTask(pool, prepareFrames, &jobs[i]);
+		}
+		waitForAllTasks(pool);
+		freeThreadPool(&pool);
+		for (i = 0; i < jobCount; i++)
+		{
+			report->proxiesFound += jobs[i].found;
+			report->proxiesCreated += jobs[i].created;
+			report->unreadableImages += jobs[i].unreadable;
+		}
+		free(jobs);
+	}
+
+	free(frames);
+	report->microseconds = getMonotonicTimeMicroseconds() - startTime;
+	return report->unreadableImages ? PROXY_NOT_READY : PROXY_READY;
+}
+
+/*
+	Function that prints what preparing the previews did.
+	Input: report - the report of prepareProxies.
+	Output: None.
+*/
+void printProxyReport(const ProxyReport* report)
+{
+	printf("Previews: %d images, %d already made, %d made now in %.1f ms\n", report->imageCount,
+		report->proxiesFound, report->proxiesCreated, (double)report->microseconds / MICROSECONDS_IN_MILLISECOND);
+	if (report->unreadableImages)
+	{
+		printf("%d images could not be read.\n", report->unreadableImages);
+	}
+}
+
+/*
+	Function that returns the preview of a frame's image through the image cache, with the frame's effects applied.
+	The preview is read from the disk when it is not cached, or made and stored if it is missing or outdated.
+	Previews are stored without effects, so changing the effects does not make them again.
+	Input: proxies - the previews folder.
+		   cache - the decoded image cache, previews are kept apart from the full resolution images.
+		   frame - the frame whose preview is needed.
+	Output: pinned cache entry holding the preview, or NULL if the frame's image could not be read.
+*/
+ImageCacheEntry* acquireProxyImage(ProxyCache* proxies, ImageCache* cache, const Frame* frame)
+{
+	ProxyRequest request;
+	ImageCacheEntry* entry = NULL;
+	char* proxyKey = (char*)allocateOrExit(sizeof(char) * (strlen(PROXY_KEY_PREFIX) + strlen(frame->imageKey) + INC));
+	char* key = NULL;
+
+	strcpy(proxyKey, PROXY_KEY_PREFIX);
+	strcat(proxyKey, frame->imageKey);
+	key = createEffectsKey(proxyKey, frame);
+	request.proxies = proxies;
+	request.frame = frame;
+	entry = acquireCachedImage(cache, key, loadProxy, &request);
+	free(key);
+	free(proxyKey);
+	return entry;
+}
+
+/*
+	Pool task: checks the previews of a range of images and makes the missing ones.
+*/
+static void prepareFrames(void* argument)
+{
+	ProxyJob* job = (ProxyJob*)argument;
+	ProxySource source;
+	ProxyHeader header;
+	IplImage* proxy = NULL;
+	FILE* file = NULL;
+	int i = 0;
+
+	for (i = 0; i < job->frameCount; i++)
+	{
+		if (PROXY_NOT_READY == describeSource(job->proxies, job->frames[i], &source))
+		{
+			job->unreadable++;
+			continue;
+		}
+		file = openProxy(&source, &header);
+		if (file)
+		{
+			fclose(file);
+			job->found++;
+		}
+		else if ((proxy = createProxy(job->proxies, &source)) != NULL)
+		{
+			cvReleaseImage(&proxy);
+			job->created++;
+		}
+		else
+		{
+			job->unreadable++;
+		}
+		free(source.proxyPath);
+	}
+}
+
+/*
+	Image cache callback: reads a preview from the disk, or makes it when it is missing or outdated, and applies the effects.
+*/
+static IplImage* loadProxy(void* argument, MappedFile* mapping)
+{
+	ProxyRequest* request = (ProxyRequest*)argument;
+	ProxySource source;
+	IplImage* proxy = NULL;
+	IplImage* result = NULL;
+
+	mapping->data = NULL;
+	if (PROXY_NOT_READY == describeSource(request->proxies, request->frame, &source))
+	{
+		return NULL;
+	}
+	proxy = readProxy(&source);
+	if (!proxy)
+	{
+		proxy = createProxy(request->proxies, &source);
+	}
+	free(source.proxyPath);
+	if (proxy && request->frame->effectCount)
+	{
+		result = applyEffects(request->frame->effects, request->frame->effectCount, proxy, source.width, source.height);
+		cvReleaseImage(&proxy);
+		proxy = result;
+	}
+	return proxy;
+}
+
+/*
+	Finds what identifies the version of a frame's image and names its preview file after a hash of it.
+	Embedded images are identified by their bytes, files by their size and modification time.
+*/
+static int describeSource(const ProxyCache* proxies, const Frame* frame, ProxySource* source)
+{
+	FileStatus status;
+	uint64_t name = FNV_OFFSET_BASIS_64;
+
+	source->frame = frame;
+	if (frame->imageData)
+	{
+		source->size = frame->imageSize;
+		source->time = 0;
+		source->hash = hashBytes(frame->imageData, frame->imageSize, FNV_OFFSET_BASIS_64);
+	}
+	else if (FILE_STATUS_READ == getFileStatus(frame->path, &status))
+	{
+		source->size = status.size;
+		source->time = status.modifiedTime;
+		source->hash = 0;
+	}
+	else
+	{
+		return PROXY_NOT_READY;
+	}
+
+	name = hashBytes(frame->path, strlen(frame->path), name);
+	name = hashBytes(&source->size, sizeof(source->size), name);
+	name = hashBytes(&source->time, sizeof(source->time), name);
+	name = hashBytes(&source->hash, sizeof(source->hash), name);
+	name = hashBytes(&proxies->maxWidth, sizeof(proxies->maxWidth), name);
+	name = hashBytes(&proxies->maxHeight, sizeof(proxies->maxHeight), name);
+	source->proxyPath = (char*)allocateOrExit(sizeof(char) * (strlen(proxies->directory) + strlen(PATH_SEPARATOR)
+		+ PROXY_NAME_DIGITS + strlen(PROXY_EXTENSION) + INC));
+	sprintf(source->proxyPath, "%s" PATH_SEPARATOR PROXY_NAME_FORMAT PROXY_EXTENSION, proxies->directory, (unsigned long long)name);
+	return PROXY_READY;
+}
+
+/*
+	Opens a preview file and checks that it was made from the source, the file is left at the start of the pixels.
+	Returns NULL if the preview is missing, outdated or belongs to another image with the same file name hash.
+*/
+static FILE* openProxy(const ProxySource* source, ProxyHeader* header)
+{
+	FILE* file = fopen(source->proxyPath, READ_BINARY_MODE);
+	size_t pathSize = strlen(source->frame->path) + INC;
+	size_t i = 0;
+	int matches = FALSE;
+
+	if (!file)
+	{
+		return NULL;
+	}
+	if (ONE_ELEMENT == fread(header, sizeof(ProxyHeader), ONE_ELEMENT, file)
+		&& PROXY_MAGIC == header->magic && PROXY_VERSION == header->version
+		&& header->width && header->width <= PROXY_MAX_WIDTH && header->height && header->height <= PROXY_MAX_HEIGHT
+		&& source->size == header->sourceSize && source->time == header->sourceTime && source->hash == header->sourceHash
+		&& pathSize == header->pathSize && header->sourceWidth && header->sourceHeight)
+	{
+		matches = TRUE;
+		for (i = 0; matches && i < pathSize; i++)
+		{
+			matches = fgetc(file) == (unsigned char)source->frame->path[i];
+		}
+	}
+	if (!matches)
+	{
+		fclose(file);
+		return NULL;
+	}
+	return file;
+}
+
+/*
+	Reads a stored preview, or returns NULL if there is no usable one.
+*/
+static IplImage* readProxy(ProxySource* source)
+{
+	ProxyHeader header;
+	IplImage* proxy = NULL;
+	FILE* file = openProxy(source, &header);
+	size_t rowSize = 0;
+	int y = 0;
+
+	if (!file)
+	{
+		return NULL;
+	}
+	source->width = (int)header.sourceWidth;
+	source->height = (int)header.sourceHeight;
+	proxy = cvCreateImage(cvSize((int)header.width, (int)header.height), IPL_DEPTH_8U, BGR_CHANNELS);
+	rowSize = (size_t)header.width * BGR_CHANNELS;
+	for (y = 0; proxy && y < proxy->height; y++)
+	{
+		if (rowSize != fread(proxy->imageData + (size_t)y * proxy->widthStep, sizeof(unsigned char), rowSize, file))
+		{
+			cvReleaseImage(&proxy);
+		}
+	}
+	fclose(file);
+	return proxy;
+}
+
+/*
+	Decodes the source at full resolution, shrinks it to fit the preview size and stores it.
+	Images that already fit are stored as they are, so they still load without decoding next time.
+*/
+static IplImage* createProxy(ProxyCache* proxies, ProxySource* source)
+{
+	IplImage* image = decodeFrameImage(source->frame);
+	IplImage* proxy = NULL;
+	int width = 0, height = 0;
+
+	if (!image)
+	{
+		return NULL;
+	}
+	width = source->width = image->width;
+	height = source->height = image->height;
+	if (width > proxies->maxWidth || height > proxies->maxHeight)
+	{
+		if ((long long)width * proxies->maxHeight >= (long long)height * proxies->maxWidth)
+		{
+			height = (int)((long long)height * proxies->maxWidth / width);
+			width = proxies->maxWidth;
+		}
+		else
+		{
+			width = (int)((long long)width * proxies->maxHeight / height);
+			height = proxies->maxHeight;
+		}
+		proxy = cvCreateImage(cvSize(width ? width : INC, height ? height : INC), IPL_DEPTH_8U, BGR_CHANNELS);
+		cvResize(image, proxy, CV_INTER_AREA);
+		cvReleaseImage(&image);
+	}
+	else
+	{
+		proxy = image;
+	}
+	writeProxy(proxies, source, proxy);
+	return proxy;
+}
+
+/*
+	Stores a preview through a temporary file of its own next to it, so a preview that is being written is never read.
+	The temporary name holds the process id and a count, so two threads or runs writing the same preview never mix their files.
+	A preview that can not be stored is only made again next time.
+*/
+static void writeProxy(ProxyCache* proxies, const ProxySource* source, const IplImage* image)
+{
+	ProxyHeader header;
+	FILE* file = NULL;
+	char* temporaryPath = (char*)allocateOrExit(sizeof(char)
+		* (strlen(source->proxyPath) + MAX_NUMBER_DIGITS * 2 + strlen(PROXY_TEMPORARY_EXTENSION) + INC));
+	size_t rowSize = (size_t)image->width * BGR_CHANNELS;
+	unsigned long temporaryNumber = 0;
+	int written = TRUE;
+	int y = 0;
+
+	lockMutex(&proxies->lock);
+	temporaryNumber = proxies->temporaryCount++;
+	unlockMutex(&proxies->lock);
+
+	sprintf(temporaryPath, "%s" TEMPORARY_NUMBER_FORMAT PROXY_TEMPORARY_EXTENSION, source->proxyPath, getProcessId(), temporaryNumber);
+	file = fopen(temporaryPath, WRITE_BINARY_MODE);
+	if (!file)
+	{
+		free(temporaryPath);
+		return;
+	}
+
+	header.magic = PROXY_MAGIC;
+	header.version = PROXY_VERSION;
+	header.width = (uint32_t)image->width;
+	header.height = (uint32_t)image->height;
+	header.sourceSize = source->size;
+	header.sourceTime = source->time;
+	header.sourceHash = source->hash;
+	header.pathSize = (uint32_t)(strlen(source->frame->path) + INC);
+	header.sourceWidth = (uint32_t)source->width;
+	header.sourceHeight = (uint32_t)source->height;
+	header.reserved = 0;
+	fwrite(&header, sizeof(ProxyHeader), ONE_ELEMENT, file);
+	fwrite(source->frame->path, sizeof(char), header.pathSize, file);
+	for (y = 0; y < image->height; y++)
+	{
+		fwrite(image->imageData + (size_t)y * image->widthStep, sizeof(unsigned char), rowSize, file);
+	}
+	if (ferror(file))
+	{
+		written = FALSE;
+	}
+	if (fclose(file))
+	{
+		written = FALSE;
+	}
+	if (!written || FILE_NOT_REPLACED == replaceFile(temporaryPath, source->proxyPath))
+	{
+		remove(temporaryPath);
+	}
+	free(temporaryPath);
+}
+
+/*
+	Reads every frame and keeps the first frame of each image, so each preview is made once.
+*/
+static const Frame** collectUniqueImages(FrameList* list, int* imageCount)
+{
+	int frameCount = frameNodeListLength(list);
+	const Frame** frames = (const Frame**)allocateOrExit(sizeof(Frame*) * (frameCount ? frameCount : INC));
+	const char** keys = NULL;
+	const Frame* frame = NULL;
+	size_t capacity = MIN_IMAGE_SLOTS, slot = 0;
+	int i = 0;
+
+	while (capacity < (size_t)frameCount * 2)
+	{
+		capacity *= 2;
+	}
+	keys = (const char**)calloc(capacity, sizeof(char*));
+	if (!keys)
+	{
+		printf("Memory allocation failed!\n");
+		exit(MEMORY_ALLOCATION_ERROR_CODE);
+	}
+
+	*imageCount = 0;
+	for (i = 0; i < frameCount; i++)
+	{
+		frame = getFrameAtIndex(list, i);
+		slot = hashString(frame->imageKey) & (capacity - 1);
+		while (keys[slot] && strcmp(keys[slot], frame->imageKey))
+		{
+			slot = (slot + INC) & (capacity - 1);
+		}
+		if (!keys[slot])
+		{
+			keys[slot] = frame->imageKey;
+			frames[(*imageCount)++] = frame;
+		}
+	}
+	free(keys);
+	return frames;
+}
+
+static void* allocateOrExit(size_t size)
+{
+	void* memory = malloc(size);
+	if (!memory)
+	{
+		printf("Memory allocation failed!\n");
+		exit(MEMORY_ALLOCATION_ERROR_CODE);
+	}
+	return memory;
+}
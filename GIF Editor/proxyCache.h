@@ -0,0 +1,77 @@
+/*********************************
+*		GIF EDITOR PROJECT       *
+*    Proxy Cache Declaration     *
+**********************************/
+
+#ifndef PROXYCACHEH
+#define PROXYCACHEH
+
+#include <stdint.h>
+#include "linkedList.h"
+#include "imageCache.h"
+#include "threadPool.h"
+
+#define PROXY_CACHE_DIRECTORY "GIF Editor Previews"
+#define PROXY_EXTENSION ".proxy"
+#define PROXY_TEMPORARY_EXTENSION ".tmp"
+#define PROXY_KEY_PREFIX "proxy|"
+#define PROXY_MAGIC 0x59585250u // "PRXY" as stored in the file
+#define PROXY_VERSION 2
+#define PROXY_MAX_WIDTH 960
+#define PROXY_MAX_HEIGHT 540
+#define PROXY_JOBS_PER_WORKER 4
+
+#define PROXY_READY 1
+#define PROXY_NOT_READY 0
+
+// Start of a preview file, followed by the source path with its null terminator and the packed BGR rows.
+// The source's own size is kept so effects given in the source's pixels can be applied to the preview.
+// A preview belongs to the source file of that path, size and modification time,
+// or to the embedded image of that path, size and content hash.
+typedef struct ProxyHeader
+{
+	uint32_t	magic;
+	uint32_t	version;
+	uint32_t	width;
+	uint32_t	height;
+	uint64_t	sourceSize;
+	uint64_t	sourceTime;
+	uint64_t	sourceHash;
+	uint32_t	pathSize;
+	uint32_t	sourceWidth;
+	uint32_t	sourceHeight;
+	uint32_t	reserved;
+} ProxyHeader;
+
+// Folder of downscaled previews of frame images, kept between runs.
+// temporaryCount numbers the temporary files previews are written through, under lock.
+typedef struct ProxyCache
+{
+	char*		directory;
+	int		maxWidth;
+	int		maxHeight;
+	unsigned long	temporaryCount;
+	Mutex		lock;
+} ProxyCache;
+
+// What preparing the previews of a timeline did
+typedef struct ProxyReport
+{
+	int			imageCount;
+	int			proxiesFound;
+	int			proxiesCreated;
+	int			unreadableImages;
+	unsigned long long	microseconds;
+} ProxyReport;
+
+ProxyCache* openProxyCache(const char* directory);
+
+void closeProxyCache(ProxyCache** proxies);
+
+int prepareProxies(ProxyCache* proxies, FrameList* list, ProxyReport* report);
+
+void printProxyReport(const ProxyReport* report);
+
+ImageCacheEntry* acquireProxyImage(ProxyCache* proxies, ImageCache* cache, const Frame* frame);
+
+#endif
@@ -0,0 +1,489 @@
+/*********************************
+*		GIF EDITOR PROJECT       *
+*        Color Quantizer         *
+**********************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include "quantize.h"
+#include "platform.h"
+#include "linkedList.h"
+#include "tileExecutor.h"
+#include "pixelKernels.h"
+#ifdef PLATFORM_X86
+#include <emmintrin.h>
+#include <immintrin.h>
+#endif
+
+#define RED_CHANNEL 0
+#define GREEN_CHANNEL 1
+#define BLUE_CHANNEL 2
+#define COLOR_CHANNELS 3
+#define CHANNEL_MASK (QUANTIZE_CHANNEL_LEVELS - 1)
+#define PADDING_COLOR_VALUE 1000 // far from every real color, so padding entries are never the nearest
+#define MAPPING_BYTES_PER_PIXEL (BGRA_PIXEL_CHANNELS + 1)
+
+// A color of the histogram and how many pixels have it
+typedef struct HistogramColor
+{
+	unsigned short	key;
+	uint64_t	count;
+} HistogramColor;
+
+// A range of histogram colors that becomes one palette color, split until there are enough boxes
+typedef struct ColorBox
+{
+	int		first;
+	int		colorCount;
+	uint64_t	population;
+	int		minimum[COLOR_CHANNELS];
+	int		maximum[COLOR_CHANNELS];
+} ColorBox;
+
+// Palette laid out for the vector search: red and green pairs, and blue with zero pairs, as 16 bit lanes
+typedef struct PackedPalette
+{
+	short	redGreen[GIF_MAX_COLORS * 2];
+	short	blueZero[GIF_MAX_COLORS * 2];
+	int	size;
+	int	paddedSize;
+} PackedPalette;
+
+// One image being mapped to palette indices, shared by its tiles
+typedef struct PaletteMapping
+{
+	const ColorMap*	map;
+	const IplImage*	image;
+	unsigned char*	indices;
+	PixelKernels	kernels;
+} PaletteMapping;
+
+typedef int (*NearestColorFunction)(const PackedPalette* packed, int red, int green, int blue);
+
+static void mapTileToPalette(void* context, const ImageTile* tile);
+static int channelOfKey(int key, int channel);
+static int expandChannel(int level);
+static void shrinkBox(ColorBox* box, const HistogramColor* colors);
+static void splitBox(ColorBox* box, ColorBox* newBox, HistogramColor* colors, HistogramColor* sorted);
+static void packPalette(const GifPalette* palette, PackedPalette* packed);
+static int findNearestScalar(const PackedPalette* packed, int red, int green, int blue);
+#ifdef PLATFORM_X86
+static int findNearestSse2(const PackedPalette* packed, int red, int green, int blue);
+static int findNearestAvx2(const PackedPalette* packed, int red, int green, int blue);
+static int pickNearestLane(const int* distances, const int* indices, int laneCount);
+#endif
+
+/*
+	Function that empties a color histogram.
+	Input: histogram - the histogram to clear.
+	Output: None.
+*/
+void clearColorHistogram(ColorHistogram* histogram)
+{
+	memset(histogram->counts, 0, sizeof(histogram->counts));
+}
+
+/*
+	Function that counts the colors of a BGR image into a histogram.
+	Input: histogram - the histogram to add to.
+		   image - 8 bit BGR or BGRA image, as decoded by OpenCV.
+	Output: None.
+*/
+void addImageToHistogram(ColorHistogram* histogram, const IplImage* image)
+{
+	PixelKernels kernels;
+	int y = 0;
+
+	choosePixelKernels(getPixelFormat(image), &kernels);
+	for (y = 0; y < image->height; y++)
+	{
+		kernels.countRow(histogram->counts, (const unsigned char*)image->imageData + (size_t)y * image->widthStep, image->width);
+	}
+}
+
+/*
+	Function that adds the counts of one histogram to another, used to join histograms counted on different threads.
+	Input: destination - the histogram to add to.
+		   source - the histogram to add.
+	Output: None.
+*/
+void mergeColorHistograms(ColorHistogram* destination, const ColorHistogram* source)
+{
+	int i = 0;
+
+	for (i = 0; i < QUANTIZE_TABLE_SIZE; i++)
+	{
+		destination->counts[i] += source->counts[i];
+	}
+}
+
+/*
+	Function that chooses a palette for the colors of a histogram by median cut.
+	The colors start in one box, and the box with the most pixels times its longest side is split
+	at the pixel median of that side until there are maxColors boxes. Each box gives its average color.
+	Input: histogram - the colors to choose for.
+		   maxColors - the largest palette to build, up to GIF_MAX_COLORS.
+		   palette - where the palette is stored, it has at least one color.
+	Output: None.
+*/
+void buildMedianCutPalette(const ColorHistogram* histogram, int maxColors, GifPalette* palette)
+{
+	HistogramColor* colors = (HistogramColor*)malloc(sizeof(HistogramColor) * QUANTIZE_TABLE_SIZE);
+	HistogramColor* sorted = (HistogramColor*)malloc(sizeof(HistogramColor) * QUANTIZE_TABLE_SIZE);
+	ColorBox boxes[GIF_MAX_COLORS];
+	ColorBox* box = NULL;
+	uint64_t score = 0, bestScore = 0, sums[COLOR_CHANNELS] = { 0 };
+	int colorCount = 0, boxCount = 0, bestBox = 0;
+	int i = 0, j = 0, channel = 0;
+
+	if (!colors || !sorted)
+	{
+		printf("Memory allocation failed!\n");
+		exit(MEMORY_ALLOCATION_ERROR_CODE);
+	}
+	if (maxColors > GIF_MAX_COLORS)
+	{
+		maxColors = GIF_MAX_COLORS;
+	}
+	for (i = 0; i < QUANTIZE_TABLE_SIZE; i++)
+	{
+		if (histogram->counts[i])
+		{
+			colors[colorCount].key = (unsigned short)i;
+			colors[colorCount].count = histogram->counts[i];
+			colorCount++;
+		}
+	}
+	if (!colorCount)
+	{
+		palette->colors[0][0] = palette->colors[0][1] = palette->colors[0][2] = 0;
+		palette->size = INC;
+		free(sorted);
+		free(colors);
+		return;
+	}
+
+	boxes[0].first = 0;
+	boxes[0].colorCount = colorCount;
+	shrinkBox(&boxes[0], colors);
+	boxCount = INC;
+	while (boxCount < maxColors)
+	{
+		bestScore = 0;
+		for (i = 0; i < boxCount; i++)
+		{
+			for (channel = 0; boxes[i].colorCount > INC && channel < COLOR_CHANNELS; channel++)
+			{
+				score = boxes[i].population * (uint64_t)(boxes[i].maximum[channel] - boxes[i].minimum[channel]);
+				if (score > bestScore)
+				{
+					bestScore = score;
+					bestBox = i;
+				}
+			}
+		}
+		if (!bestScore)
+		{
+			break;
+		}
+		splitBox(&boxes[bestBox], &boxes[boxCount], colors, sorted);
+		boxCount++;
+	}
+
+	for (i = 0; i < boxCount; i++)
+	{
+		box = &boxes[i];
+		sums[RED_CHANNEL] = sums[GREEN_CHANNEL] = sums[BLUE_CHANNEL] = 0;
+		for (j = box->first; j < box->first + box->colorCount; j++)
+		{
+			for (channel = 0; channel < COLOR_CHANNELS; channel++)
+			{
+				sums[channel] += colors[j].count * (uint64_t)expandChannel(channelOfKey(colors[j].key, channel));
+			}
+		}
+		for (channel = 0; channel < COLOR_CHANNELS; channel++)
+		{
+			palette->colors[i][channel] = (unsigned char)((sums[channel] + box->population / 2) / box->population);
+		}
+	}
+	palette->size = boxCount;
+	free(sorted);
+	free(colors);
+}
+
+/*
+	Function that fills a color map's table with the nearest palette color of every 15 bit color,
+	using the widest vector instructions the processor supports.
+	Input: map - the color map, its palette already chosen.
+	Output: None.
+*/
+void buildColorMap(ColorMap* map)
+{
+	PackedPalette packed;
+	NearestColorFunction findNearest = findNearestScalar;
+	int key = 0;
+#ifdef PLATFORM_X86
+	int features = getCpuFeatures();
+
+	if (features & CPU_FEATURE_AVX2)
+	{
+		findNearest = findNearestAvx2;
+	}
+	else if (features & CPU_FEATURE_SSE2)
+	{
+		findNearest = findNearestSse2;
+	}
+#endif
+
+	packPalette(&map->palette, &packed);
+	for (key = 0; key < QUANTIZE_TABLE_SIZE; key++)
+	{
+		map->nearest[key] = (unsigned char)findNearest(&packed, expandChannel(channelOfKey(key, RED_CHANNEL)),
+			expandChannel(channelOfKey(key, GREEN_CHANNEL)), expandChannel(channelOfKey(key, BLUE_CHANNEL)));
+	}
+}
+
+/*
+	Function that replaces every pixel of a BGR image with the index of its nearest palette color.
+	Large images are mapped in tiles in parallel when called from a pool task.
+	Input: map - a built color map.
+		   image - 8 bit BGR or BGRA image.
+		   indices - where the width * height indices are stored, row after row.
+	Output: None.
+*/
+void mapImageToPalette(const ColorMap* map, const IplImage* image, unsigned char* indices)
+{
+	PaletteMapping mapping;
+
+	mapping.map = map;
+	mapping.image = image;
+	mapping.indices = indices;
+	choosePixelKernels(getPixelFormat(image), &mapping.kernels);
+	runTiled(image->width, image->height, MAPPING_BYTES_PER_PIXEL, mapTileToPalette, &mapping);
+}
+
+/*
+	Tile kernel: looks up the palette index of each pixel of one tile.
+*/
+static void mapTileToPalette(void* context, const ImageTile* tile)
+{
+	const PaletteMapping* mapping = (const PaletteMapping*)context;
+	const IplImage* image = mapping->image;
+	int y = 0;
+
+	for (y = tile->top; y < tile->top + tile->height; y++)
+	{
+		mapping->kernels.lookupRow(mapping->map->nearest,
+			(const unsigned char*)image->imageData + (size_t)y * image->widthStep + (size_t)tile->left * mapping->kernels.channels,
+			mapping->indices + (size_t)y * image->width + tile->left, tile->width);
+	}
+}
+
+static int channelOfKey(int key, int channel)
+{
+	return (key >> ((BLUE_CHANNEL - channel) * QUANTIZE_CHANNEL_BITS)) & CHANNEL_MASK;
+}
+
+/*
+	Turns a 5 bit channel level back into 8 bits, so level 31 is 255.
+*/
+static int expandChannel(int level)
+{
+	return (level << 3) | (level >> 2);
+}
+
+/*
+	Recomputes a box's pixel count and the smallest range of levels holding its colors.
+*/
+static void shrinkBox(ColorBox* box, const HistogramColor* colors)
+{
+	int i = 0, channel = 0, level = 0;
+
+	box->population = 0;
+	for (channel = 0; channel < COLOR_CHANNELS; channel++)
+	{
+		box->minimum[channel] = CHANNEL_MASK;
+		box->maximum[channel] = 0;
+	}
+	for (i = box->first; i < box->first + box->colorCount; i++)
+	{
+		box->population += colors[i].count;
+		for (channel = 0; channel < COLOR_CHANNELS; channel++)
+		{
+			level = channelOfKey(colors[i].key, channel);
+			box->minimum[channel] = level < box->minimum[channel] ? level : box->minimum[channel];
+			box->maximum[channel] = level > box->maximum[channel] ? level : box->maximum[channel];
+		}
+	}
+}
+
+/*
+	Sorts a box's colors along its longest side with a counting sort and moves the half past the pixel median to a new box.
+*/
+static void splitBox(ColorBox* box, ColorBox* newBox, HistogramColor* colors, HistogramColor* sorted)
+{
+	int starts[QUANTIZE_CHANNEL_LEVELS + 1] = { 0 };
+	int channel = RED_CHANNEL, i = 0, level = 0, splitAt = 0;
+	uint64_t half = box->population / 2, count = 0;
+
+	for (i = GREEN_CHANNEL; i < COLOR_CHANNELS; i++)
+	{
+		if (box->maximum[i] - box->minimum[i] > box->maximum[channel] - box->minimum[channel])
+		{
+			channel = i;
+		}
+	}
+
+	for (i = box->first; i < box->first + box->colorCount; i++)
+	{
+		starts[channelOfKey(colors[i].key, channel) + INC]++;
+	}
+	for (level = 0; level < QUANTIZE_CHANNEL_LEVELS; level++)
+	{
+		starts[level + INC] += starts[level];
+	}
+	for (i = box->first; i < box->first + box->colorCount; i++)
+	{
+		sorted[starts[channelOfKey(colors[i].key, channel)]++] = colors[i];
+	}
+	memcpy(colors + box->first, sorted, sizeof(HistogramColor) * box->colorCount);
+
+	// The split keeps at least one color on each side
+	for (splitAt = INC; splitAt < box->colorCount - INC; splitAt++)
+	{
+		count += colors[box->first + splitAt - INC].count;
+		if (count >= half)
+		{
+			break;
+		}
+	}
+	newBox->first = box->first + splitAt;
+	newBox->colorCount = box->colorCount - splitAt;
+	box->colorCount = splitAt;
+	shrinkBox(box, colors);
+	shrinkBox(newBox, colors);
+}
+
+/*
+	Lays the palette out for the search and pads it to whole vectors with colors that are never the nearest.
+*/
+static void packPalette(const GifPalette* palette, PackedPalette* packed)
+{
+	int i = 0;
+
+	packed->size = palette->size;
+	packed->paddedSize = (palette->size + QUANTIZE_VECTOR_WIDTH - INC) / QUANTIZE_VECTOR_WIDTH * QUANTIZE_VECTOR_WIDTH;
+	for (i = 0; i < packed->paddedSize; i++)
+	{
+		packed->redGreen[2 * i] = (short)(i < palette->size ? palette->colors[i][RED_CHANNEL] : PADDING_COLOR_VALUE);
+		packed->redGreen[2 * i + INC] = (short)(i < palette->size ? palette->colors[i][GREEN_CHANNEL] : PADDING_COLOR_VALUE);
+		packed->blueZero[2 * i] = (short)(i < palette->size ? palette->colors[i][BLUE_CHANNEL] : PADDING_COLOR_VALUE);
+		packed->blueZero[2 * i + INC] = 0;
+	}
+}
+
+/*
+	Finds the palette color nearest to a color by squared distance, the first one on ties.
+*/
+static int findNearestScalar(const PackedPalette* packed, int red, int green, int blue)
+{
+	int bestIndex = 0, bestDistance = INT_MAX, distance = 0;
+	int redDifference = 0, greenDifference = 0, blueDifference = 0;
+	int i = 0;
+
+	for (i = 0; i < packed->size; i++)
+	{
+		redDifference = packed->redGreen[2 * i] - red;
+		greenDifference = packed->redGreen[2 * i + INC] - green;
+		blueDifference = packed->blueZero[2 * i] - blue;
+		distance = redDifference * redDifference + greenDifference * greenDifference + blueDifference * blueDifference;
+		if (distance < bestDistance)
+		{
+			bestDistance = distance;
+			bestIndex = i;
+		}
+	}
+	return bestIndex;
+}
+
+#ifdef PLATFORM_X86
+/*
+	findNearestScalar for 4 palette colors at a time: one multiply-add gives red and green, another blue.
+	Each lane keeps its first nearest color, so the result is the same as the scalar search.
+*/
+TARGET_SSE2 static int findNearestSse2(const PackedPalette* packed, int red, int green, int blue)
+{
+	__m128i query = _mm_set1_epi32((green << 16) | red);
+	__m128i blueQuery = _mm_set1_epi32(blue);
+	__m128i bestDistance = _mm_set1_epi32(INT_MAX);
+	__m128i bestIndex = _mm_setzero_si128();
+	__m128i index = _mm_setr_epi32(0, 1, 2, 3);
+	__m128i step = _mm_set1_epi32(4);
+	__m128i difference, blueDifference, distance, closer;
+	int distances[4], indices[4];
+	int i = 0;
+
+	for (i = 0; i < packed->paddedSize; i += 4)
+	{
+		difference = _mm_sub_epi16(_mm_loadu_si128((const __m128i*)&packed->redGreen[2 * i]), query);
+		blueDifference = _mm_sub_epi16(_mm_loadu_si128((const __m128i*)&packed->blueZero[2 * i]), blueQuery);
+		distance = _mm_add_epi32(_mm_madd_epi16(difference, difference), _mm_madd_epi16(blueDifference, blueDifference));
+		closer = _mm_cmplt_epi32(distance, bestDistance);
+		bestDistance = _mm_or_si128(_mm_and_si128(closer, distance), _mm_andnot_si128(closer, bestDistance));
+		bestIndex = _mm_or_si128(_mm_and_si128(closer, index), _mm_andnot_si128(closer, bestIndex));
+		index = _mm_add_epi32(index, step);
+	}
+	_mm_storeu_si128((__m128i*)distances, bestDistance);
+	_mm_storeu_si128((__m128i*)indices, bestIndex);
+	return pickNearestLane(distances, indices, 4);
+}
+
+/*
+	findNearestSse2 for 8 palette colors at a time.
+*/
+TARGET_AVX2 static int findNearestAvx2(const PackedPalette* packed, int red, int green, int blue)
+{
+	__m256i query = _mm256_set1_epi32((green << 16) | red);
+	__m256i blueQuery = _mm256_set1_epi32(blue);
+	__m256i bestDistance = _mm256_set1_epi32(INT_MAX);
+	__m256i bestIndex = _mm256_setzero_si256();
+	__m256i index = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+	__m256i step = _mm256_set1_epi32(QUANTIZE_VECTOR_WIDTH);
+	__m256i difference, blueDifference, distance, closer;
+	int distances[QUANTIZE_VECTOR_WIDTH], indices[QUANTIZE_VECTOR_WIDTH];
+	int i = 0;
+
+	for (i = 0; i < packed->paddedSize; i += QUANTIZE_VECTOR_WIDTH)
+	{
+		difference = _mm256_sub_epi16(_mm256_loadu_si256((const __m256i*)&packed->redGreen[2 * i]), query);
+		blueDifference = _mm256_sub_epi16(_mm256_loadu_si256((const __m256i*)&packed->blueZero[2 * i]), blueQuery);
+		distance = _mm256_add_epi32(_mm256_madd_epi16(difference, difference), _mm256_madd_epi16(blueDifference, blueDifference));
+		closer = _mm256_cmpgt_epi32(bestDistance, distance);
+		bestDistance = _mm256_min_epi32(bestDistance, distance);
+		bestIndex = _mm256_blendv_epi8(bestIndex, index, closer);
+		index = _mm256_add_epi32(index, step);
+	}
+	_mm256_storeu_si256((__m256i*)distances, bestDistance);
+	_mm256_storeu_si256((__m256i*)indices, bestIndex);
+	return pickNearestLane(distances, indices, QUANTIZE_VECTOR_WIDTH);
+}
+
+/*
+	Picks the nearest of the lanes' best colors, the lowest index on ties.
+*/
+static int pickNearestLane(const int* distances, const int* indices, int laneCount)
+{
+	int best = 0, i = 0;
+
+	for (i = INC; i < laneCount; i++)
+	{
+		if (distances[i] < distances[best] || (distances[i] == distances[best] && indices[i] < indices[best]))
+		{
+			best = i;
+		}
+	}
+	return indices[best];
+}
+#endif
@@ -0,0 +1,47 @@
+/*********************************
+*		GIF EDITOR PROJECT       *
+*  Color Quantizer Declaration   *
+**********************************/
+
+#ifndef QUANTIZEH
+#define QUANTIZEH
+#define CV_IGNORE_DEBUG_BUILD_GUARD
+
+#include <stdint.h>
+#include <opencv2/core/core_c.h>
+#include "gifWriter.h"
+
+#define QUANTIZE_CHANNEL_BITS 5
+#define QUANTIZE_CHANNEL_LEVELS (1 << QUANTIZE_CHANNEL_BITS)
+#define QUANTIZE_TABLE_SIZE (1 << (3 * QUANTIZE_CHANNEL_BITS))
+#define QUANTIZE_VECTOR_WIDTH 8
+
+// Key of a BGR pixel in the histogram and the color map: 5 bits of red, green and blue
+#define QUANTIZE_KEY(blue, green, red) ((((red) >> 3) << 10) | (((green) >> 3) << 5) | ((blue) >> 3))
+
+// Number of pixels of every 15 bit color, over one image or many
+typedef struct ColorHistogram
+{
+	uint64_t	counts[QUANTIZE_TABLE_SIZE];
+} ColorHistogram;
+
+// A palette and the index of its nearest color for every 15 bit color, read only once built
+typedef struct ColorMap
+{
+	GifPalette	palette;
+	unsigned char	nearest[QUANTIZE_TABLE_SIZE];
+} ColorMap;
+
+void clearColorHistogram(ColorHistogram* histogram);
+
+void addImageToHistogram(ColorHistogram* histogram, const IplImage* image);
+
+void mergeColorHistograms(ColorHistogram* destination, const ColorHistogram* source);
+
+void buildMedianCutPalette(const ColorHistogram* histogram, int maxColors, GifPalette* palette);
+
+void buildColorMap(ColorMap* map);
+
+void mapImageToPalette(const ColorMap* map, const IplImage* image, unsigned char* indices);
+
+#endif
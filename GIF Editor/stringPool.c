@@ -0,0 +1,111 @@
+/*********************************
+*		GIF EDITOR PROJECT       *
+*          String Pool           *
+**********************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "stringPool.h"
+#include "linkedList.h"
+#include "hash.h"
+
+static StringPoolSlot* allocatePoolSlots(int capacity);
+static void growStringPool(StringPool* pool);
+
+/*
+	Function that initializes an empty string pool whose strings live in the given arena.
+	Input: pool - the pool to initialize.
+		   arena - the arena that will own the interned strings.
+	Output: None.
+*/
+void initStringPool(StringPool* pool, Arena* arena)
+{
+	pool->arena = arena;
+	pool->capacity = STRING_POOL_INITIAL_CAPACITY;
+	pool->slots = allocatePoolSlots(pool->capacity);
+	pool->count = 0;
+	pool->savedBytes = 0;
+}
+
+/*
+	Function that frees the pool's table. The strings themselves are freed with the arena.
+	Input: pool - the pool to free.
+	Output: None.
+*/
+void freeStringPool(StringPool* pool)
+{
+	free(pool->slots);
+	pool->slots = NULL;
+	pool->capacity = 0;
+	pool->count = 0;
+}
+
+/*
+	Function that returns the single shared copy of a string, storing it on first use.
+	Interned strings are shared and must not be modified.
+	Input: pool - the string pool.
+		   string - the string to intern.
+	Output: the interned copy.
+*/
+char* internString(StringPool* pool, const char* string)
+{
+	unsigned int hash = hashString(string);
+	int mask = 0, slot = 0;
+
+	if ((pool->count + INC) * STRING_POOL_LOAD_DENOMINATOR > pool->capacity * STRING_POOL_LOAD_NUMERATOR)
+	{
+		growStringPool(pool);
+	}
+	mask = pool->capacity - 1;
+	slot = hash & mask;
+	while (pool->slots[slot].string)
+	{
+		if (pool->slots[slot].hash == hash && EQUAL_STRINGS_VALUE == strcmp(pool->slots[slot].string, string))
+		{
+			pool->savedBytes += strlen(string) + INC;
+			return pool->slots[slot].string;
+		}
+		slot = (slot + INC) & mask;
+	}
+
+	pool->slots[slot].hash = hash;
+	pool->slots[slot].string = arenaCopyString(pool->arena, string);
+	pool->count++;
+	return pool->slots[slot].string;
+}
+
+static StringPoolSlot* allocatePoolSlots(int capacity)
+{
+	StringPoolSlot* slots = (StringPoolSlot*)calloc(capacity, sizeof(StringPoolSlot));
+	if (!slots)
+	{
+		printf("Memory allocation failed!\n");
+		exit(MEMORY_ALLOCATION_ERROR_CODE);
+	}
+	return slots;
+}
+
+static void growStringPool(StringPool* pool)
+{
+	StringPoolSlot* oldSlots = pool->slots;
+	int oldCapacity = pool->capacity;
+	int mask = 0, slot = 0, i = 0;
+
+	pool->capacity *= 2;
+	pool->slots = allocatePoolSlots(pool->capacity);
+	mask = pool->capacity - 1;
+	for (i = 0; i < oldCapacity; i++)
+	{
+		if (oldSlots[i].string)
+		{
+			slot = oldSlots[i].hash & mask;
+			while (pool->slots[slot].string)
+			{
+				slot = (slot + INC) & mask;
+			}
+			pool->slots[slot] = oldSlots[i];
+		}
+	}
+	free(oldSlots);
+}
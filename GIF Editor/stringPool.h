@@ -0,0 +1,38 @@
+/*********************************
+*		GIF EDITOR PROJECT       *
+*    String Pool Declaration     *
+**********************************/
+
+#ifndef STRINGPOOLH
+#define STRINGPOOLH
+
+#include "arena.h"
+
+#define STRING_POOL_INITIAL_CAPACITY 64
+#define STRING_POOL_LOAD_NUMERATOR 3
+#define STRING_POOL_LOAD_DENOMINATOR 4
+
+// Open addressing slot of an interned string, an empty slot has a NULL string
+typedef struct StringPoolSlot
+{
+	unsigned int	hash;
+	char*		string;
+} StringPoolSlot;
+
+// Set of interned strings, every distinct string is stored once inside the arena
+typedef struct StringPool
+{
+	Arena*		arena;
+	StringPoolSlot*	slots;
+	int		capacity;
+	int		count;
+	size_t		savedBytes;
+} StringPool;
+
+void initStringPool(StringPool* pool, Arena* arena);
+
+void freeStringPool(StringPool* pool);
+
+char* internString(StringPool* pool, const char* string);
+
+#endif
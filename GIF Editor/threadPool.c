@@ -0,0 +1,356 @@
+/*********************************
+*		GIF EDITOR PROJECT       *
+*          Thread Pool           *
+**********************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "threadPool.h"
+#include "linkedList.h"
+
+static THREAD_LOCAL TaskQueue* currentWorkerQueue = NULL;
+
+static void runWorker(void* argument);
+static int takeTask(ThreadPool* pool, TaskQueue* ownQueue, PoolTask* task);
+static void finishTask(ThreadPool* pool);
+static void initTaskQueue(TaskQueue* queue, ThreadPool* pool);
+static void destroyTaskQueue(TaskQueue* queue);
+static void pushTask(TaskQueue* queue, const PoolTask* task);
+static int popNewestTask(TaskQueue* queue, PoolTask* task);
+static int popOldestTask(TaskQueue* queue, PoolTask* task);
+static void growTaskQueue(TaskQueue* queue);
+
+/*
+	Function that starts a pool of worker threads.
+	Input: workerCount - the number of workers, 0 or less for one per processor.
+	Output: pointer to the running pool.
+*/
+ThreadPool* createThreadPool(int workerCount)
+{
+	ThreadPool* pool = (ThreadPool*)malloc(sizeof(ThreadPool));
+	int i = 0;
+
+	if (workerCount <= 0)
+	{
+		workerCount = getProcessorCount();
+	}
+	if (pool)
+	{
+		pool->workers = (Thread*)malloc(sizeof(Thread) * workerCount);
+		pool->queues = (TaskQueue*)malloc(sizeof(TaskQueue) * workerCount);
+	}
+	if (!pool || !pool->workers || !pool->queues)
+	{
+		printf("Memory allocation failed!\n");
+		exit(MEMORY_ALLOCATION_ERROR_CODE);
+	}
+
+	pool->workerCount = 0;
+	pool->queueCount = workerCount;
+	pool->queuedTasks = 0;
+	pool->unfinishedTasks = 0;
+	pool->stopRequested = FALSE;
+	initMutex(&pool->lock);
+	initCondition(&pool->taskQueued);
+	initCondition(&pool->tasksFinished);
+	initTaskQueue(&pool->sharedQueue, pool);
+	for (i = 0; i < pool->queueCount; i++)
+	{
+		initTaskQueue(&pool->queues[i], pool);
+	}
+
+	// Queues of workers that failed to start are still emptied by the others
+	for (i = 0; i < workerCount; i++)
+	{
+		if (THREAD_NOT_CREATED == createThread(&pool->workers[pool->workerCount], runWorker, &pool->queues[i]))
+		{
+			printf("Could not start a worker thread!\n");
+			break;
+		}
+		pool->workerCount++;
+	}
+	return pool;
+}
+
+/*
+	Function that queues a task to run on the pool.
+	A task submitted from one of the pool's workers goes to that worker's own queue, so related tasks stay together.
+	If the pool has no workers the task runs right away on the calling thread.
+	Input: pool - the pool to run the task on.
+		   function - the function to run.
+		   argument - the argument passed to the function.
+	Output: None.
+*/
+void submitTask(ThreadPool* pool, TaskFunction function, void* argument)
+{
+	PoolTask task;
+
+	if (!pool->workerCount)
+	{
+		function(argument);
+		return;
+	}
+
+	task.function = function;
+	task.argument = argument;
+	lockMutex(&pool->lock);
+	pool->unfinishedTasks++;
+	unlockMutex(&pool->lock);
+
+	pushTask(currentWorkerQueue && currentWorkerQueue->pool == pool ? currentWorkerQueue : &pool->sharedQueue, &task);
+
+	lockMutex(&pool->lock);
+	pool->queuedTasks++;
+	signalCondition(&pool->taskQueued);
+	unlockMutex(&pool->lock);
+}
+
+/*
+	Function that lets a worker waiting inside a task help instead of blocking:
+	it runs the newest task the worker queued itself, if there is one.
+	Only the worker's own queue is used, but that may hold any task the worker queued, not only the ones being
+	waited for. A caller must not hold anything such a task could wait on, like an image cache entry it is filling.
+	Input: pool - the pool the calling task runs on.
+	Output: TRUE if a task was run, FALSE if the calling thread has nothing queued and should block.
+*/
+int runPendingTask(ThreadPool* pool)
+{
+	PoolTask task;
+
+	if (!currentWorkerQueue || currentWorkerQueue->pool != pool || !popNewestTask(currentWorkerQueue, &task))
+	{
+		return FALSE;
+	}
+	lockMutex(&pool->lock);
+	pool->queuedTasks--;
+	unlockMutex(&pool->lock);
+
+	task.function(task.argument);
+	finishTask(pool);
+	return TRUE;
+}
+
+/*
+	Function that gives the pool the calling thread works for, so a task can share its own work with that pool.
+	Input: None.
+	Output: the pool of the calling worker, or NULL if the calling thread is not one of a pool's workers.
+*/
+ThreadPool* getCurrentThreadPool(void)
+{
+	return currentWorkerQueue ? currentWorkerQueue->pool : NULL;
+}
+
+/*
+	Function that waits until every task submitted so far has finished running.
+	Must be called from outside the pool, a task waiting for all tasks would wait for itself.
+	Input: pool - the pool to wait for.
+	Output: None.
+*/
+void waitForAllTasks(ThreadPool* pool)
+{
+	lockMutex(&pool->lock);
+	while (pool->unfinishedTasks)
+	{
+		waitCondition(&pool->tasksFinished, &pool->lock);
+	}
+	unlockMutex(&pool->lock);
+}
+
+/*
+	Function that runs the queued tasks to completion, stops the workers and frees the pool.
+	Input: pool - the pool to free.
+	Output: None.
+*/
+void freeThreadPool(ThreadPool** pool)
+{
+	int i = 0;
+
+	if (!*pool)
+	{
+		return;
+	}
+
+	lockMutex(&(*pool)->lock);
+	(*pool)->stopRequested = TRUE;
+	broadcastCondition(&(*pool)->taskQueued);
+	unlockMutex(&(*pool)->lock);
+	for (i = 0; i < (*pool)->workerCount; i++)
+	{
+		joinThread(&(*pool)->workers[i]);
+	}
+
+	for (i = 0; i < (*pool)->queueCount; i++)
+	{
+		destroyTaskQueue(&(*pool)->queues[i]);
+	}
+	destroyTaskQueue(&(*pool)->sharedQueue);
+	destroyCondition(&(*pool)->tasksFinished);
+	destroyCondition(&(*pool)->taskQueued);
+	destroyMutex(&(*pool)->lock);
+	free((*pool)->queues);
+	free((*pool)->workers);
+	free(*pool);
+	*pool = NULL;
+}
+
+/*
+	Worker thread: runs tasks until the pool is stopped and every task, including ones queued by running tasks, is done.
+*/
+static void runWorker(void* argument)
+{
+	TaskQueue* ownQueue = (TaskQueue*)argument;
+	ThreadPool* pool = ownQueue->pool;
+	PoolTask task;
+
+	currentWorkerQueue = ownQueue;
+	lockMutex(&pool->lock);
+	while (TRUE)
+	{
+		while (pool->queuedTasks <= 0 && !(pool->stopRequested && !pool->unfinishedTasks))
+		{
+			waitCondition(&pool->taskQueued, &pool->lock);
+		}
+		if (pool->queuedTasks <= 0)
+		{
+			break;
+		}
+		unlockMutex(&pool->lock);
+
+		// The counter is raised only after the push, so a task counted as queued may still be in the middle of being taken
+		if (takeTask(pool, ownQueue, &task))
+		{
+			task.function(task.argument);
+			finishTask(pool);
+		}
+
+		lockMutex(&pool->lock);
+	}
+	unlockMutex(&pool->lock);
+	currentWorkerQueue = NULL;
+}
+
+/*
+	Takes the next task for a worker: the newest of its own queue, else the oldest of another worker's queue,
+	else the oldest task submitted from outside the pool. Work already started is finished before new work is begun.
+*/
+static int takeTask(ThreadPool* pool, TaskQueue* ownQueue, PoolTask* task)
+{
+	int taken = popNewestTask(ownQueue, task);
+	int start = (int)(ownQueue - pool->queues);
+	int i = 0;
+
+	for (i = INC; !taken && i < pool->queueCount; i++)
+	{
+		taken = popOldestTask(&pool->queues[(start + i) % pool->queueCount], task);
+	}
+	if (!taken)
+	{
+		taken = popOldestTask(&pool->sharedQueue, task);
+	}
+	if (taken)
+	{
+		lockMutex(&pool->lock);
+		pool->queuedTasks--;
+		unlockMutex(&pool->lock);
+	}
+	return taken;
+}
+
+static void finishTask(ThreadPool* pool)
+{
+	lockMutex(&pool->lock);
+	pool->unfinishedTasks--;
+	if (!pool->unfinishedTasks)
+	{
+		broadcastCondition(&pool->tasksFinished);
+		broadcastCondition(&pool->taskQueued);
+	}
+	unlockMutex(&pool->lock);
+}
+
+static void initTaskQueue(TaskQueue* queue, ThreadPool* pool)
+{
+	queue->pool = pool;
+	queue->tasks = (PoolTask*)malloc(sizeof(PoolTask) * THREAD_POOL_MIN_TASKS);
+	if (!queue->tasks)
+	{
+		printf("Memory allocation failed!\n");
+		exit(MEMORY_ALLOCATION_ERROR_CODE);
+	}
+	queue->capacity = THREAD_POOL_MIN_TASKS;
+	queue->first = 0;
+	queue->count = 0;
+	initMutex(&queue->lock);
+}
+
+static void destroyTaskQueue(TaskQueue* queue)
+{
+	destroyMutex(&queue->lock);
+	free(queue->tasks);
+}
+
+static void pushTask(TaskQueue* queue, const PoolTask* task)
+{
+	lockMutex(&queue->lock);
+	if (queue->count == queue->capacity)
+	{
+		growTaskQueue(queue);
+	}
+	queue->tasks[(queue->first + queue->count) % queue->capacity] = *task;
+	queue->count++;
+	unlockMutex(&queue->lock);
+}
+
+static int popNewestTask(TaskQueue* queue, PoolTask* task)
+{
+	int taken = FALSE;
+
+	lockMutex(&queue->lock);
+	if (queue->count)
+	{
+		queue->count--;
+		*task = queue->tasks[(queue->first + queue->count) % queue->capacity];
+		taken = TRUE;
+	}
+	unlockMutex(&queue->lock);
+	return taken;
+}
+
+static int popOldestTask(TaskQueue* queue, PoolTask* task)
+{
+	int taken = FALSE;
+
+	lockMutex(&queue->lock);
+	if (queue->count)
+	{
+		*task = queue->tasks[queue->first];
+		queue->first = (queue->first + INC) % queue->capacity;
+		queue->count--;
+		taken = TRUE;
+	}
+	unlockMutex(&queue->lock);
+	return taken;
+}
+
+/*
+	Doubles a task queue, unrolling the ring so the oldest task comes first. Called with the queue's lock held.
+*/
+static void growTaskQueue(TaskQueue* queue)
+{
+	PoolTask* tasks = (PoolTask*)malloc(sizeof(PoolTask) * queue->capacity * 2);
+	int i = 0;
+
+	if (!tasks)
+	{
+		printf("Memory allocation failed!\n");
+		exit(MEMORY_ALLOCATION_ERROR_CODE);
+	}
+	for (i = 0; i < queue->count; i++)
+	{
+		tasks[i] = queue->tasks[(queue->first + i) % queue->capacity];
+	}
+	free(queue->tasks);
+	queue->tasks = tasks;
+	queue->capacity *= 2;
+	queue->first = 0;
+}
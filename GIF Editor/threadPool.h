@@ -0,0 +1,66 @@
+/*********************************
+*		GIF EDITOR PROJECT       *
+*    Thread Pool Declaration     *
+**********************************/
+
+#ifndef THREADPOOLH
+#define THREADPOOLH
+
+#include "platform.h"
+
+#define THREAD_POOL_MIN_TASKS 16
+#define THREAD_POOL_ONE_PER_PROCESSOR 0
+
+typedef void (*TaskFunction)(void* argument);
+
+// A function queued to run on one of the pool's workers
+typedef struct PoolTask
+{
+	TaskFunction	function;
+	void*		argument;
+} PoolTask;
+
+struct ThreadPool;
+
+// Double ended ring of tasks. A worker takes the newest task of its own queue, others steal the oldest.
+typedef struct TaskQueue
+{
+	struct ThreadPool*	pool;
+	PoolTask*		tasks;
+	int			capacity;
+	int			first;
+	int			count;
+	Mutex			lock;
+} TaskQueue;
+
+// Fixed set of worker threads, each with its own task queue.
+// Tasks submitted by a worker go to its own queue, tasks submitted from outside go to a shared queue,
+// and a worker that runs out of tasks steals from the others.
+typedef struct ThreadPool
+{
+	Thread*		workers;
+	int		workerCount;
+	TaskQueue*	queues;
+	int		queueCount;
+	TaskQueue	sharedQueue;
+	int		queuedTasks;
+	int		unfinishedTasks;
+	int		stopRequested;
+	Mutex		lock;
+	Condition	taskQueued;
+	Condition	tasksFinished;
+} ThreadPool;
+
+ThreadPool* createThreadPool(int workerCount);
+
+void submitTask(ThreadPool* pool, TaskFunction function, void* argument);
+
+int runPendingTask(ThreadPool* pool);
+
+ThreadPool* getCurrentThreadPool(void);
+
+void waitForAllTasks(ThreadPool* pool);
+
+void freeThreadPool(ThreadPool** pool);
+
+#endif
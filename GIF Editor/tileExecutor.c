@@ -0,0 +1,162 @@
+/*********************************
+*		GIF EDITOR PROJECT       *
+*         Tile Executor          *
+**********************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "tileExecutor.h"
+#include "linkedList.h"
+
+static void runHelper(void* argument);
+static void runTiles(TiledRun* run);
+static int claimTile(TiledRun* run, ImageTile* tile);
+static void releaseTiledRun(TiledRun* run);
+
+/*
+	Function that runs a pixel kernel over an image split into tiles small enough to stay in a core's cache.
+	Called from a task of a thread pool, the tiles are shared with the pool: helper tasks are queued on the calling
+	worker's own queue, where idle workers steal them, and the calling thread works on tiles too. Images of
+	several frames decoded at once all feed the same pool this way. Called from any other thread, or for an image
+	under TILED_MIN_PIXELS, the kernel runs once over the whole image on the calling thread.
+	The kernel must only write the pixels of the tile it gets, tiles run in any order and at the same time.
+	Input: width, height - the size of the image.
+		   bytesPerPixel - how many bytes the kernel reads and writes for each pixel, which sets the size of the tiles.
+		   kernel - the function run on each tile.
+		   context - passed to the kernel.
+	Output: None.
+*/
+void runTiled(int width, int height, int bytesPerPixel, TileKernel kernel, void* context)
+{
+	ThreadPool* pool = getCurrentThreadPool();
+	TiledRun* run = NULL;
+	ImageTile tile;
+	int helperCount = 0, i = 0;
+
+	if (!pool || !pool->workerCount || (long long)width * height < TILED_MIN_PIXELS)
+	{
+		tile.left = 0;
+		tile.top = 0;
+		tile.width = width;
+		tile.height = height;
+		if (width > 0 && height > 0)
+		{
+			kernel(context, &tile);
+		}
+		return;
+	}
+
+	run = (TiledRun*)malloc(sizeof(TiledRun));
+	if (!run)
+	{
+		printf("Memory allocation failed!\n");
+		exit(MEMORY_ALLOCATION_ERROR_CODE);
+	}
+	run->kernel = kernel;
+	run->context = context;
+	run->width = width;
+	run->height = height;
+	run->tileWidth = width < TILE_MAX_WIDTH ? width : TILE_MAX_WIDTH;
+	run->tileHeight = TILE_CACHE_BYTES / (run->tileWidth * (bytesPerPixel > 0 ? bytesPerPixel : INC));
+	run->tileHeight = run->tileHeight > 0 ? run->tileHeight : INC;
+	run->columnCount = (width + run->tileWidth - INC) / run->tileWidth;
+	run->tileCount = run->columnCount * ((height + run->tileHeight - INC) / run->tileHeight);
+	run->nextTile = 0;
+	run->finishedTiles = 0;
+	helperCount = pool->workerCount < run->tileCount - INC ? pool->workerCount : run->tileCount - INC;
+	run->references = helperCount + INC;
+	initMutex(&run->lock);
+	initCondition(&run->tilesFinished);
+
+	for (i = 0; i < helperCount; i++)
+	{
+		submitTask(pool, runHelper, run);
+	}
+	runTiles(run);
+
+	// Every tile is claimed by now, only the ones other workers are still on are waited for.
+	// No queued task is run meanwhile: the caller may be filling an image cache entry that a sibling task
+	// would wait for. Helpers still queued find no tiles left and only let go of the run.
+	lockMutex(&run->lock);
+	while (run->finishedTiles < run->tileCount)
+	{
+		waitCondition(&run->tilesFinished, &run->lock);
+	}
+	unlockMutex(&run->lock);
+	releaseTiledRun(run);
+}
+
+/*
+	Pool task: works on the run's tiles, then lets go of it.
+*/
+static void runHelper(void* argument)
+{
+	TiledRun* run = (TiledRun*)argument;
+
+	runTiles(run);
+	releaseTiledRun(run);
+}
+
+/*
+	Runs the kernel on tiles until none are left.
+*/
+static void runTiles(TiledRun* run)
+{
+	ImageTile tile;
+
+	while (claimTile(run, &tile))
+	{
+		run->kernel(run->context, &tile);
+		lockMutex(&run->lock);
+		run->finishedTiles++;
+		if (run->finishedTiles == run->tileCount)
+		{
+			broadcastCondition(&run->tilesFinished);
+		}
+		unlockMutex(&run->lock);
+	}
+}
+
+/*
+	Takes the next tile in row order, the last tiles of a row and column are cut at the image's edge.
+*/
+static int claimTile(TiledRun* run, ImageTile* tile)
+{
+	int index = 0;
+
+	lockMutex(&run->lock);
+	index = run->nextTile;
+	if (index < run->tileCount)
+	{
+		run->nextTile++;
+	}
+	unlockMutex(&run->lock);
+	if (index >= run->tileCount)
+	{
+		return FALSE;
+	}
+
+	tile->left = index % run->columnCount * run->tileWidth;
+	tile->top = index / run->columnCount * run->tileHeight;
+	tile->width = run->width - tile->left < run->tileWidth ? run->width - tile->left : run->tileWidth;
+	tile->height = run->height - tile->top < run->tileHeight ? run->height - tile->top : run->tileHeight;
+	return TRUE;
+}
+
+/*
+	Lets go of a run, the last one to do so frees it.
+*/
+static void releaseTiledRun(TiledRun* run)
+{
+	int references = 0;
+
+	lockMutex(&run->lock);
+	references = --run->references;
+	unlockMutex(&run->lock);
+	if (!references)
+	{
+		destroyCondition(&run->tilesFinished);
+		destroyMutex(&run->lock);
+		free(run);
+	}
+}
@@ -0,0 +1,48 @@
+/*********************************
+*		GIF EDITOR PROJECT       *
+*   Tile Executor Declaration    *
+**********************************/
+
+#ifndef TILEEXECUTORH
+#define TILEEXECUTORH
+
+#include "threadPool.h"
+
+#define TILE_CACHE_BYTES (128 * 1024) // what one tile may touch, so it stays in a core's own cache
+#define TILE_MAX_WIDTH 512
+#define TILED_MIN_PIXELS (1280 * 720) // smaller images, like previews, run as one tile on the calling thread
+
+// A rectangle of an image, in pixels
+typedef struct ImageTile
+{
+	int	left;
+	int	top;
+	int	width;
+	int	height;
+} ImageTile;
+
+typedef void (*TileKernel)(void* context, const ImageTile* tile);
+
+// One image split into tiles, claimed one at a time by the calling thread and the pool's helper tasks.
+// It is freed by whoever lets go of it last, so helper tasks that start after all the tiles are done
+// never keep the caller waiting.
+typedef struct TiledRun
+{
+	TileKernel	kernel;
+	void*		context;
+	int		width;
+	int		height;
+	int		tileWidth;
+	int		tileHeight;
+	int		columnCount;
+	int		tileCount;
+	int		nextTile;
+	int		finishedTiles;
+	int		references;
+	Mutex		lock;
+	Condition	tilesFinished;
+} TiledRun;
+
+void runTiled(int width, int height, int bytesPerPixel, TileKernel kernel, void* context);
+
+#endif
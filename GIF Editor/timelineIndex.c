@@ -0,0 +1,252 @@
+/*********************************
+*		GIF EDITOR PROJECT       *
+*         Timeline Index         *
+**********************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "timelineIndex.h"
+#include "linkedList.h"
+
+#define LOWEST_BIT(position) ((position) & -(position))
+
+static void reserveSums(TimelineIndex* index, int required);
+static void leaveUniformMode(TimelineIndex* index);
+static uint64_t sumBefore(const TimelineIndex* index, int position);
+
+/*
+	Function that initializes the index of an empty timeline.
+	Input: index - the index to initialize.
+	Output: None.
+*/
+void initTimelineIndex(TimelineIndex* index)
+{
+	index->sums = NULL;
+	index->capacity = 0;
+	index->length = 0;
+	index->valid = TRUE;
+	index->uniform = FALSE;
+	index->uniformDuration = 0;
+	reserveSums(index, TIMELINE_INDEX_INITIAL_CAPACITY);
+}
+
+/*
+	Function that frees the memory of a timeline index.
+	Input: index - the index to free.
+	Output: None.
+*/
+void freeTimelineIndex(TimelineIndex* index)
+{
+	free(index->sums);
+	index->sums = NULL;
+	index->capacity = 0;
+	index->length = 0;
+	index->valid = FALSE;
+}
+
+/*
+	Function that builds the index from the durations of all the frames, in O(n).
+	Each position adds itself into the next position that covers it, instead of every position doing log n updates.
+	Input: index - the index to build.
+		   frames - the frames in timeline order, all of them read.
+		   length - the number of frames.
+	Output: None.
+*/
+void buildTimelineIndex(TimelineIndex* index, struct Frame** frames, int length)
+{
+	int position = 0, parent = 0;
+
+	reserveSums(index, length);
+	for (position = INC; position <= length; position++)
+	{
+		index->sums[position - INC] = frames[position - INC]->duration;
+	}
+	for (position = INC; position <= length; position++)
+	{
+		parent = position + LOWEST_BIT(position);
+		if (parent <= length)
+		{
+			index->sums[parent - INC] += index->sums[position - INC];
+		}
+	}
+	index->length = length;
+	index->uniform = FALSE;
+	index->valid = TRUE;
+}
+
+/*
+	Function that records that every frame now has the same duration, in O(1) for any number of frames.
+	Input: index - the index.
+		   length - the number of frames.
+		   duration - the duration of every frame.
+	Output: None.
+*/
+void setUniformTimelineDuration(TimelineIndex* index, int length, unsigned int duration)
+{
+	index->length = length;
+	index->uniform = TRUE;
+	index->uniformDuration = duration;
+	index->valid = TRUE;
+}
+
+/*
+	Function that adds a frame at the end of the timeline, in O(log n).
+	Input: index - a valid index.
+		   duration - the duration of the new frame.
+	Output: None.
+*/
+void appendTimelineDuration(TimelineIndex* index, unsigned int duration)
+{
+	int position = index->length + INC;
+
+	if (index->uniform && duration == index->uniformDuration)
+	{
+		index->length = position;
+		return;
+	}
+	leaveUniformMode(index);
+	reserveSums(index, position);
+	index->sums[position - INC] = duration + sumBefore(index, position - INC) - sumBefore(index, position - LOWEST_BIT(position));
+	index->length = position;
+}
+
+/*
+	Function that removes the last frame of the timeline. The positions before it do not cover it, so nothing else changes.
+	Input: index - a valid index.
+	Output: None.
+*/
+void removeLastTimelineDuration(TimelineIndex* index)
+{
+	index->length--;
+}
+
+/*
+	Function that changes the duration of one frame, in O(log n).
+	Input: index - a valid index.
+		   position - index of the frame, from 0 to length - 1.
+		   oldDuration - the duration the frame had.
+		   newDuration - the duration the frame has now.
+	Output: None.
+*/
+void changeTimelineDuration(TimelineIndex* index, int position, unsigned int oldDuration, unsigned int newDuration)
+{
+	if (index->uniform && newDuration == index->uniformDuration)
+	{
+		return;
+	}
+	leaveUniformMode(index);
+	for (position += INC; position <= index->length; position += LOWEST_BIT(position))
+	{
+		index->sums[position - INC] += (uint64_t)newDuration - oldDuration;
+	}
+}
+
+/*
+	Function that gives the time a frame starts at, the sum of the durations before it, in O(log n).
+	Input: index - a valid index.
+		   position - index of the frame, from 0 to length. The length gives the duration of the whole timeline.
+	Output: the start time in milliseconds.
+*/
+uint64_t getTimelineStart(const TimelineIndex* index, int position)
+{
+	if (index->uniform)
+	{
+		return (uint64_t)position * index->uniformDuration;
+	}
+	return sumBefore(index, position);
+}
+
+/*
+	Function that finds the frame on screen at a time, in O(log n).
+	It walks down the tree from the largest power of two, keeping the last position that starts at or before the time,
+	so frames with no duration are never the answer.
+	Input: index - a valid index.
+		   time - milliseconds from the start of the timeline.
+	Output: index of the frame, from 0 to length - 1, or TIMELINE_END if the time is past the end.
+*/
+int findTimelinePosition(const TimelineIndex* index, uint64_t time)
+{
+	int position = 0, step = INC;
+
+	if (index->uniform)
+	{
+		if (!index->uniformDuration || time / index->uniformDuration >= (uint64_t)index->length)
+		{
+			return TIMELINE_END;
+		}
+		return (int)(time / index->uniformDuration);
+	}
+	while (step <= index->length / 2)
+	{
+		step *= 2;
+	}
+	for (; step; step /= 2)
+	{
+		if (position + step <= index->length && index->sums[position + step - INC] <= time)
+		{
+			position += step;
+			time -= index->sums[position - INC];
+		}
+	}
+	return position < index->length ? position : TIMELINE_END;
+}
+
+/*
+	Makes room for at least the given number of positions, growing the array geometrically.
+*/
+static void reserveSums(TimelineIndex* index, int required)
+{
+	uint64_t* sums = NULL;
+	int capacity = index->capacity ? index->capacity : TIMELINE_INDEX_INITIAL_CAPACITY;
+
+	if (required <= index->capacity)
+	{
+		return;
+	}
+	while (capacity < required)
+	{
+		capacity *= 2;
+	}
+	sums = (uint64_t*)realloc(index->sums, sizeof(uint64_t) * capacity);
+	if (!sums)
+	{
+		printf("Memory allocation failed!\n");
+		exit(MEMORY_ALLOCATION_ERROR_CODE);
+	}
+	index->sums = sums;
+	index->capacity = capacity;
+}
+
+/*
+	Fills in the tree of a timeline where every frame has the same duration, before one of them changes.
+	Position i covers its lowest bit of frames, so it holds that many durations.
+*/
+static void leaveUniformMode(TimelineIndex* index)
+{
+	int position = 0;
+
+	if (!index->uniform)
+	{
+		return;
+	}
+	reserveSums(index, index->length);
+	for (position = INC; position <= index->length; position++)
+	{
+		index->sums[position - INC] = (uint64_t)LOWEST_BIT(position) * index->uniformDuration;
+	}
+	index->uniform = FALSE;
+}
+
+/*
+	Sums the durations of the first given number of frames.
+*/
+static uint64_t sumBefore(const TimelineIndex* index, int position)
+{
+	uint64_t sum = 0;
+
+	for (; position > 0; position -= LOWEST_BIT(position))
+	{
+		sum += index->sums[position - INC];
+	}
+	return sum;
+}
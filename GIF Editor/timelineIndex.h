@@ -0,0 +1,47 @@
+/*********************************
+*		GIF EDITOR PROJECT       *
+*  Timeline Index Declaration    *
+**********************************/
+
+#ifndef TIMELINEINDEXH
+#define TIMELINEINDEXH
+
+#include <stdint.h>
+
+#define TIMELINE_INDEX_INITIAL_CAPACITY 16
+#define TIMELINE_END -1
+
+struct Frame;
+
+// Durations of the frames in timeline order, for finding the frame shown at a time.
+// sums is a Fenwick tree: position i (from 1) holds the durations of frames i - lowest bit of i + 1 to i.
+// While uniform is set every frame lasts uniformDuration and sums is not used.
+typedef struct TimelineIndex
+{
+	uint64_t*	sums;
+	int		length;
+	int		capacity;
+	int		valid;
+	int		uniform;
+	unsigned int	uniformDuration;
+} TimelineIndex;
+
+void initTimelineIndex(TimelineIndex* index);
+
+void freeTimelineIndex(TimelineIndex* index);
+
+void buildTimelineIndex(TimelineIndex* index, struct Frame** frames, int length);
+
+void setUniformTimelineDuration(TimelineIndex* index, int length, unsigned int duration);
+
+void appendTimelineDuration(TimelineIndex* index, unsigned int duration);
+
+void removeLastTimelineDuration(TimelineIndex* index);
+
+void changeTimelineDuration(TimelineIndex* index, int position, unsigned int oldDuration, unsigned int newDuration);
+
+uint64_t getTimelineStart(const TimelineIndex* index, int position);
+
+int findTimelinePosition(const TimelineIndex* index, uint64_t time);
+
+#endif
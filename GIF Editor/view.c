@@ -1,45 +1,435 @@
-/*********************************
-*		GIF EDITOR PROJECT       *
-*          Play Function         *
-**********************************/
-
-#include "view.h"
-
-/**
-play the movie!!
-display the images each for the duration of the frame one by one and close the window.
-Input: a linked list of frames to display.
-Output: None.
-**/
-void play(FrameNode* list)
-{
-	cvNamedWindow("Display window", CV_WINDOW_AUTOSIZE); //create a window
-	FrameNode* head = list;
-	int imgNum = 1, playCount = 0;
-	IplImage* image;
-	while (playCount < GIF_REPEAT)
-	{
-		while (list != 0)
-		{
-			image = cvLoadImage(list->frame->path, 1);
-			IplImage* pGrayImg = 0;
-			pGrayImg = cvCreateImage(cvSize(image->width, image->height), image->depth, 1);
-			if (!image) //The image is empty - shouldn't happen since we checked already.
-			{
-				printf("Could not open or find image number %d", imgNum);
-			}
-			else
-			{
-				cvShowImage("Display window", image); //display the image
-				cvWaitKey(list->frame->duration); //wait
-				list = list->next;
-				cvReleaseImage(&image);
-			}
-			imgNum++;
-		}
-		list = head; // rewind
-		playCount++;
-	}
-	cvDestroyWindow("Display window");
-	return;
-}
\ No newline at end of file
+/*********************************
+*		GIF EDITOR PROJECT       *
+*          Play Function         *
+**********************************/
+
+#include <stdio.h>
+#include <ctype.h>
+#include "view.h"
+#include "canvas.h"
+
+#define DIGIT_BASE 10
+
+static void printPlayerControls(void);
+static void initPlayerControls(PlayerControls* controls);
+static unsigned long long scaledDuration(const PlayerControls* controls, unsigned int duration);
+static void showFrameUntilDeadline(FrameList* list, PlaybackPipeline* pipeline, PlaybackSchedule* schedule,
+	PlayerControls* controls, const PlaybackSlot* slot);
+static int handleKey(FrameList* list, PlaybackPipeline* pipeline, PlaybackSchedule* schedule,
+	PlayerControls* controls, const PlaybackSlot* slot, int key);
+static void togglePause(FrameList* list, PlaybackSchedule* schedule, PlayerControls* controls, const PlaybackSlot* slot);
+static void changeSpeed(PlaybackSchedule* schedule, PlayerControls* controls, int speedPercent);
+static void stepBack(FrameList* list, PlaybackPipeline* pipeline, const PlaybackSlot* slot);
+static int goToFrame(FrameList* list, PlaybackPipeline* pipeline, const PlaybackSlot* slot, long long frameNumber);
+static int goToTime(FrameList* list, PlaybackPipeline* pipeline, const PlaybackSlot* slot, long long time);
+static void resumeClock(PlaybackSchedule* schedule, PlayerControls* controls);
+static void endFrameNow(PlaybackSchedule* schedule, PlayerControls* controls);
+static void startSchedule(PlaybackSchedule* schedule);
+static int isFrameTooLate(const PlaybackSchedule* schedule, unsigned long long requested);
+static void dropFrame(PlaybackSchedule* schedule, unsigned long long requested);
+static void frameShown(PlaybackSchedule* schedule, unsigned long long requested);
+static void recordFrameError(PlaybackSchedule* schedule, unsigned long long now);
+static void setRemainingTime(PlaybackSchedule* schedule, unsigned long long remaining);
+static void shiftSchedule(PlaybackSchedule* schedule, unsigned long long pause);
+static void finishSchedule(PlaybackSchedule* schedule);
+static void printTimingReport(const PlaybackSchedule* schedule);
+
+/**
+play the movie!!
+display the images each for the duration of the frame one by one and close the window.
+The images are decoded ahead on a background thread, so the display loop only presents ready frames.
+Every frame ends at an absolute deadline on a monotonic clock, so time spent decoding and
+displaying is taken out of the wait instead of being added to it.
+Keys are read while a frame waits for its deadline, so the controls answer within a frame even on long frames.
+Stepping and jumping seek the decoder straight to a frame index or a time through the timeline index.
+In preview mode the downscaled previews are prepared in parallel first and played instead of the full resolution images,
+so a timeline whose previews were made before opens without decoding any full resolution image.
+With a canvas set every frame is fitted to it, so the window keeps one size. Outside of preview mode the frames
+are fitted in parallel before the window opens, previews are small enough to be fitted by the decoder as they play.
+Input: list - the list of frames to display.
+	   cache - the decoded image cache shared by the whole session.
+	   proxies - the previews folder for preview mode, or NULL to play the images at full resolution.
+	   options - the playback options, dropLateFrames skips frames whose time already passed,
+				 startTime is where in the movie the first play starts, in milliseconds,
+				 and loopCount is how many times the movie plays, or PLAYBACK_LOOP_FOREVER.
+Output: None.
+**/
+void play(FrameList* list, ImageCache* cache, ProxyCache* proxies, const PlaybackOptions* options)
+{
+	PlaybackPipeline* pipeline = NULL;
+	PlaybackSlot slot;
+	PlaybackSchedule schedule;
+	PlayerControls controls;
+	ProxyReport proxyReport;
+	CanvasReport canvasReport;
+	unsigned long long requested = 0;
+
+	if (proxies)
+	{
+		prepareProxies(proxies, list, &proxyReport);
+		printProxyReport(&proxyReport);
+	}
+	else if (isCanvasSet(&list->canvas))
+	{
+		prepareCanvasImages(list, cache, 0, &canvasReport);
+		printCanvasReport(&list->canvas, &canvasReport);
+	}
+	printPlayerControls();
+	cvNamedWindow("Display window", CV_WINDOW_AUTOSIZE); //create a window
+	pipeline = startPlaybackPipeline(list, cache, proxies, options->loopCount, PLAYBACK_DECODE_AHEAD, options->startTime);
+	startSchedule(&schedule);
+	initPlayerControls(&controls);
+	while (!controls.stopRequested && takeNextPlaybackSlot(pipeline, &slot))
+	{
+		requested = scaledDuration(&controls, slot.duration);
+		if (!slot.entry) //The image is empty - shouldn't happen since we checked already.
+		{
+			printf("Could not open or find image number %d\n", slot.index + FIRST_NODE_INDEX);
+			dropFrame(&schedule, requested);
+		}
+		else if (options->dropLateFrames && !controls.paused && isFrameTooLate(&schedule, requested))
+		{
+			dropFrame(&schedule, requested);
+		}
+		else
+		{
+			cvShowImage("Display window", slot.entry->image); //display the image
+			frameShown(&schedule, requested);
+			showFrameUntilDeadline(list, pipeline, &schedule, &controls, &slot);
+		}
+		finishPlaybackSlot(pipeline, &slot);
+	}
+	finishSchedule(&schedule);
+	stopPlaybackPipeline(&pipeline);
+	cvDestroyWindow("Display window");
+	printTimingReport(&schedule);
+	printImageCacheStats(cache);
+	return;
+}
+
+static void printPlayerControls(void)
+{
+	printf("Controls: [space] pause, [%c] next frame, [%c] previous frame, [number then %c] go to frame,\n",
+		KEY_NEXT_FRAME, KEY_PREVIOUS_FRAME, KEY_GO_TO_FRAME);
+	printf("          [number then %c] go to time in milliseconds, [%c/%c] faster/slower, [%c] stop\n",
+		KEY_GO_TO_TIME, KEY_FASTER, KEY_SLOWER, KEY_STOP);
+}
+
+static void initPlayerControls(PlayerControls* controls)
+{
+	controls->paused = FALSE;
+	controls->pauseStart = 0;
+	controls->speedPercent = NORMAL_SPEED_PERCENT;
+	controls->typedNumber = NO_TYPED_NUMBER;
+	controls->stopRequested = FALSE;
+}
+
+/*
+	Gives how long a frame stays on screen at the current speed, in microseconds.
+*/
+static unsigned long long scaledDuration(const PlayerControls* controls, unsigned int duration)
+{
+	return (unsigned long long)duration * MICROSECONDS_IN_MILLISECOND * NORMAL_SPEED_PERCENT / controls->speedPercent;
+}
+
+/*
+	Keeps the window responsive until the current frame's deadline, or for as long as playback is paused,
+	and handles the keys pressed meanwhile. Returns early when a key ends the frame.
+*/
+static void showFrameUntilDeadline(FrameList* list, PlaybackPipeline* pipeline, PlaybackSchedule* schedule,
+	PlayerControls* controls, const PlaybackSlot* slot)
+{
+	unsigned long long now = getMonotonicTimeMicroseconds();
+	int remaining = 0, key = NO_KEY, frameEnded = FALSE;
+
+	if (controls->paused)
+	{
+		controls->pauseStart = now;
+	}
+	while (!frameEnded && (controls->paused || now < schedule->nextDeadline))
+	{
+		remaining = now < schedule->nextDeadline ? (int)((schedule->nextDeadline - now) / MICROSECONDS_IN_MILLISECOND) : 0;
+		key = cvWaitKey(controls->paused ? WAIT_FOR_ANY_KEY
+			: remaining > MIN_WAIT_KEY_MILLISECONDS ? remaining : MIN_WAIT_KEY_MILLISECONDS); //wait
+		if (NO_KEY != key)
+		{
+			frameEnded = handleKey(list, pipeline, schedule, controls, slot, key & KEY_CODE_MASK);
+		}
+		now = getMonotonicTimeMicroseconds();
+	}
+}
+
+/*
+	Applies a pressed key. Digits are collected into a number for the go to keys.
+	Returns TRUE when the frame on screen ends now, because of a step, a jump or stopping.
+*/
+static int handleKey(FrameList* list, PlaybackPipeline* pipeline, PlaybackSchedule* schedule,
+	PlayerControls* controls, const PlaybackSlot* slot, int key)
+{
+	long long typedNumber = controls->typedNumber;
+	int frameEnded = FALSE;
+
+	controls->typedNumber = NO_TYPED_NUMBER;
+	if (isdigit(key))
+	{
+		typedNumber = NO_TYPED_NUMBER == typedNumber ? 0 : typedNumber;
+		controls->typedNumber = typedNumber < MAX_TYPED_NUMBER ? typedNumber * DIGIT_BASE + (key - '0') : typedNumber;
+	}
+	else if (KEY_PAUSE == key)
+	{
+		togglePause(list, schedule, controls, slot);
+	}
+	else if (KEY_FASTER == key || KEY_SLOWER == key)
+	{
+		changeSpeed(schedule, controls, KEY_FASTER == key ? controls->speedPercent * SPEED_STEP : controls->speedPercent / SPEED_STEP);
+	}
+	else if (KEY_NEXT_FRAME == key)
+	{
+		frameEnded = TRUE;
+	}
+	else if (KEY_PREVIOUS_FRAME == key)
+	{
+		stepBack(list, pipeline, slot);
+		frameEnded = TRUE;
+	}
+	else if (KEY_GO_TO_FRAME == key)
+	{
+		frameEnded = goToFrame(list, pipeline, slot, typedNumber);
+	}
+	else if (KEY_GO_TO_TIME == key)
+	{
+		frameEnded = goToTime(list, pipeline, slot, typedNumber);
+	}
+	else if (KEY_STOP == key || KEY_ESCAPE == key)
+	{
+		controls->stopRequested = TRUE;
+		frameEnded = TRUE;
+	}
+
+	if (frameEnded)
+	{
+		endFrameNow(schedule, controls);
+	}
+	return frameEnded;
+}
+
+static void togglePause(FrameList* list, PlaybackSchedule* schedule, PlayerControls* controls, const PlaybackSlot* slot)
+{
+	if (controls->paused)
+	{
+		resumeClock(schedule, controls);
+		controls->paused = FALSE;
+		printf("Playing\n");
+	}
+	else
+	{
+		controls->paused = TRUE;
+		controls->pauseStart = getMonotonicTimeMicroseconds();
+		printf("Paused at frame %d (%s), %llu ms into the movie\n", slot->index + FIRST_NODE_INDEX, slot->frame->name,
+			(unsigned long long)getFrameStartTime(list, slot->index));
+	}
+}
+
+/*
+	Changes the playback speed, the part of the frame on screen that is left is rescaled to the new speed.
+*/
+static void changeSpeed(PlaybackSchedule* schedule, PlayerControls* controls, int speedPercent)
+{
+	unsigned long long now = 0;
+
+	if (speedPercent < MIN_SPEED_PERCENT || speedPercent > MAX_SPEED_PERCENT)
+	{
+		return;
+	}
+	resumeClock(schedule, controls);
+	now = getMonotonicTimeMicroseconds();
+	if (schedule->nextDeadline > now)
+	{
+		setRemainingTime(schedule, (schedule->nextDeadline - now) * controls->speedPercent / speedPercent);
+	}
+	controls->speedPercent = speedPercent;
+	printf("Speed %d%%\n", speedPercent);
+}
+
+/*
+	Seeks to the frame before the one on screen, into the previous play when it is the first frame.
+*/
+static void stepBack(FrameList* list, PlaybackPipeline* pipeline, const PlaybackSlot* slot)
+{
+	int index = slot->index - INC, pass = slot->pass;
+
+	if (index < 0)
+	{
+		index = pass ? frameNodeListLength(list) - INC : 0;
+		pass = pass ? pass - INC : pass;
+	}
+	seekPlaybackPipeline(pipeline, index, pass, 0);
+}
+
+static int goToFrame(FrameList* list, PlaybackPipeline* pipeline, const PlaybackSlot* slot, long long frameNumber)
+{
+	if (frameNumber < FIRST_NODE_INDEX || frameNumber > frameNodeListLength(list))
+	{
+		printf("Type a frame number from %d to %d before pressing %c\n", FIRST_NODE_INDEX, frameNodeListLength(list), KEY_GO_TO_FRAME);
+		return FALSE;
+	}
+	seekPlaybackPipeline(pipeline, (int)frameNumber - FIRST_NODE_INDEX, slot->pass, 0);
+	return TRUE;
+}
+
+static int goToTime(FrameList* list, PlaybackPipeline* pipeline, const PlaybackSlot* slot, long long time)
+{
+	int index = NO_TYPED_NUMBER == time ? TIMELINE_END : findFrameAtTime(list, (uint64_t)time);
+
+	if (TIMELINE_END == index)
+	{
+		printf("Type a time below %llu ms before pressing %c\n", (unsigned long long)getTimelineDuration(list), KEY_GO_TO_TIME);
+		return FALSE;
+	}
+	seekPlaybackPipeline(pipeline, index, slot->pass, (unsigned int)(time - getFrameStartTime(list, index)));
+	return TRUE;
+}
+
+/*
+	Moves the schedule past the time spent paused so far, so pauses are not counted as playback time.
+*/
+static void resumeClock(PlaybackSchedule* schedule, PlayerControls* controls)
+{
+	unsigned long long now = getMonotonicTimeMicroseconds();
+
+	if (controls->paused)
+	{
+		shiftSchedule(schedule, now - controls->pauseStart);
+		controls->pauseStart = now;
+	}
+}
+
+/*
+	Cuts the frame on screen short, the next frame gets its full time from now.
+*/
+static void endFrameNow(PlaybackSchedule* schedule, PlayerControls* controls)
+{
+	resumeClock(schedule, controls);
+	setRemainingTime(schedule, 0);
+}
+
+static void startSchedule(PlaybackSchedule* schedule)
+{
+	schedule->startTime = getMonotonicTimeMicroseconds();
+	schedule->nextDeadline = schedule->startTime;
+	schedule->lastShownTime = 0;
+	schedule->lastShownRequested = 0;
+	schedule->requestedTotal = 0;
+	schedule->absoluteErrorTotal = 0;
+	schedule->worstError = 0;
+	schedule->shownFrames = 0;
+	schedule->droppedFrames = 0;
+}
+
+/*
+	A frame is too late when the deadline it should have left the screen at already passed.
+*/
+static int isFrameTooLate(const PlaybackSchedule* schedule, unsigned long long requested)
+{
+	return getMonotonicTimeMicroseconds() >= schedule->nextDeadline + requested;
+}
+
+/*
+	Skips a frame, its time stays on screen as part of the previous frame.
+*/
+static void dropFrame(PlaybackSchedule* schedule, unsigned long long requested)
+{
+	schedule->nextDeadline += requested;
+	schedule->requestedTotal += requested;
+	schedule->lastShownRequested += requested;
+	schedule->droppedFrames++;
+}
+
+/*
+	Closes the measurement of the frame that was on screen until now and moves the deadline.
+*/
+static void frameShown(PlaybackSchedule* schedule, unsigned long long requested)
+{
+	unsigned long long now = getMonotonicTimeMicroseconds();
+
+	if (schedule->shownFrames)
+	{
+		recordFrameError(schedule, now);
+	}
+	else
+	{
+		// the clock starts with the first frame on screen, window creation is not playback time
+		schedule->startTime = now;
+		schedule->nextDeadline = now;
+	}
+	schedule->lastShownTime = now;
+	schedule->lastShownRequested = requested;
+	schedule->nextDeadline += requested;
+	schedule->requestedTotal += requested;
+	schedule->shownFrames++;
+}
+
+/*
+	Compares how long the last shown frame actually stayed on screen with the time it was given.
+*/
+static void recordFrameError(PlaybackSchedule* schedule, unsigned long long now)
+{
+	long long error = (long long)(now - schedule->lastShownTime) - (long long)schedule->lastShownRequested;
+	long long magnitude = error < 0 ? -error : error;
+
+	schedule->absoluteErrorTotal += magnitude;
+	if (magnitude > (schedule->worstError < 0 ? -schedule->worstError : schedule->worstError))
+	{
+		schedule->worstError = error;
+	}
+}
+
+/*
+	Gives the frame on screen a new amount of time left, counting only the time it really gets as requested.
+*/
+static void setRemainingTime(PlaybackSchedule* schedule, unsigned long long remaining)
+{
+	unsigned long long now = getMonotonicTimeMicroseconds();
+	unsigned long long current = schedule->nextDeadline > now ? schedule->nextDeadline - now : 0;
+
+	schedule->nextDeadline = (current ? schedule->nextDeadline : now) - current + remaining;
+	schedule->requestedTotal = schedule->requestedTotal - current + remaining;
+	schedule->lastShownRequested = schedule->lastShownRequested - current + remaining;
+}
+
+/*
+	Moves the whole schedule later by the time playback was paused.
+*/
+static void shiftSchedule(PlaybackSchedule* schedule, unsigned long long pause)
+{
+	schedule->startTime += pause;
+	schedule->lastShownTime += pause;
+	schedule->nextDeadline += pause;
+}
+
+static void finishSchedule(PlaybackSchedule* schedule)
+{
+	unsigned long long now = getMonotonicTimeMicroseconds();
+
+	if (schedule->shownFrames)
+	{
+		recordFrameError(schedule, now);
+		schedule->lastShownTime = now;
+	}
+}
+
+/*
+	Prints how the actual on screen time compared to the requested frame durations.
+*/
+static void printTimingReport(const PlaybackSchedule* schedule)
+{
+	unsigned long long actual = schedule->shownFrames ? schedule->lastShownTime - schedule->startTime : 0;
+
+	printf("Playback timing: %d frames shown, %d dropped\n", schedule->shownFrames, schedule->droppedFrames);
+	printf("                 requested %.3f s, actual %.3f s, drift %+.1f ms\n",
+		(double)schedule->requestedTotal / MICROSECONDS_IN_SECOND, (double)actual / MICROSECONDS_IN_SECOND,
+		((double)actual - (double)schedule->requestedTotal) / MICROSECONDS_IN_MILLISECOND);
+	printf("                 per frame error: mean %.2f ms, worst %+.2f ms\n",
+		schedule->shownFrames ? (double)schedule->absoluteErrorTotal / schedule->shownFrames / MICROSECONDS_IN_MILLISECOND : 0.0,
+		(double)schedule->worstError / MICROSECONDS_IN_MILLISECOND);
+}
@@ -1,20 +1,75 @@
-/*********************************
-*		GIF EDITOR PROJECT       *
-*    Play Function Declaration   *
-**********************************/
-
-#ifndef VIEWH
-#define VIEWH
-#define CV_IGNORE_DEBUG_BUILD_GUARD
-
-#include <opencv2/imgcodecs/imgcodecs_c.h>
-
-#include <opencv2\core\core_c.h>
-#include <opencv2\highgui\highgui_c.h>
-#include "LinkedList.h"
-
-#define GIF_REPEAT 5
-
-void play(FrameNode* list);
-
+/*********************************
+*		GIF EDITOR PROJECT       *
+*    Play Function Declaration   *
+**********************************/
+
+#ifndef VIEWH
+#define VIEWH
+#define CV_IGNORE_DEBUG_BUILD_GUARD
+
+#include <opencv2/imgcodecs/imgcodecs_c.h>
+
+#include <opencv2/core/core_c.h>
+#include <opencv2/highgui/highgui_c.h>
+#include "linkedList.h"
+#include "imageCache.h"
+#include "playbackPipeline.h"
+#include "proxyCache.h"
+#include "platform.h"
+
+#define MIN_WAIT_KEY_MILLISECONDS 1
+#define WAIT_FOR_ANY_KEY 0
+#define NO_KEY -1
+#define KEY_CODE_MASK 0xFF
+#define NO_TYPED_NUMBER -1
+#define MAX_TYPED_NUMBER 1000000000000LL
+#define NORMAL_SPEED_PERCENT 100
+#define MIN_SPEED_PERCENT 25
+#define MAX_SPEED_PERCENT 800
+#define SPEED_STEP 2
+
+#define KEY_PAUSE ' '
+#define KEY_NEXT_FRAME 'd'
+#define KEY_PREVIOUS_FRAME 'a'
+#define KEY_GO_TO_FRAME 'g'
+#define KEY_GO_TO_TIME 't'
+#define KEY_FASTER '+'
+#define KEY_SLOWER '-'
+#define KEY_STOP 'q'
+#define KEY_ESCAPE 27
+
+// Options chosen by the user before playing
+typedef struct PlaybackOptions
+{
+	int		dropLateFrames;
+	uint64_t	startTime;
+	int		loopCount;
+} PlaybackOptions;
+
+// State of the keyboard controls while playing
+typedef struct PlayerControls
+{
+	int			paused;
+	unsigned long long	pauseStart;
+	int			speedPercent;
+	long long		typedNumber;
+	int			stopRequested;
+} PlayerControls;
+
+// Playback clock: absolute frame deadlines and the measured timing
+typedef struct PlaybackSchedule
+{
+	unsigned long long	nextDeadline;
+	unsigned long long	startTime;
+	unsigned long long	lastShownTime;
+	unsigned long long	lastShownRequested;
+	unsigned long long	requestedTotal;
+	unsigned long long	absoluteErrorTotal;
+	long long		worstError;
+	int			shownFrames;
+	int			droppedFrames;
+} PlaybackSchedule;
+
+void play(FrameList* list, ImageCache* cache, ProxyCache* proxies, const PlaybackOptions* options);
+
 #endif
\ No newline at end of file